@@ -34,7 +34,7 @@ static void AP_Print(void (*Output)(char))            // print lists of AP's
     Format_String(Output, Line); }
 }
 
-FIFO<OGN_RxPacket<OGN_Packet>, 16> APRSrx_FIFO;                     // packets received on the air, to be passed to the APRS
+SPSC_FIFO<OGN_RxPacket<OGN_Packet>, 16> APRSrx_FIFO;                    // packets received on the air, to be passed to the APRS
 FIFO<OGN_TxPacket<OGN_Packet>,  4> APRStx_FIFO;                     // own position/status/info packets to besent to APRS
 
 static Socket APRS_Socket;                                          // socket to talk to APRS server
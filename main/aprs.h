@@ -5,7 +5,7 @@
 #include "ogn.h"
 #include "fifo.h"
 
-extern FIFO<OGN_RxPacket<OGN_Packet>, 16> APRSrx_FIFO;
+extern SPSC_FIFO<OGN_RxPacket<OGN_Packet>, 16> APRSrx_FIFO;
 extern FIFO<OGN_TxPacket<OGN_Packet>,  4> APRStx_FIFO;
 
 bool WIFI_isConnected(void);
@@ -1,5 +1,47 @@
 #include "atmosphere.h"
 
-//                                                      200,   300,   400,   500,   600,   700,   800,  900, 1000,   1100     // [  hPa]
-       const int32_t Atmosphere::StdAltTable[10] = { 117764, 91652, 71864, 55752, 42070, 30126, 19493, 9886, 1109,  -6984 } ; // [0.1 m]
+// generated by utils/atmosphere_bench -t
+
+const uint32_t Atmosphere::TablePress[121] = {
+   2044371, 1998413, 1953294, 1909004, 1865530, 1822862, 1780987, 1739895, 1699573, 1660012,
+   1621200, 1583126, 1545779, 1509149, 1473225, 1437996, 1403453, 1369584, 1336381, 1303832,
+   1271929, 1240660, 1210017, 1179989, 1150568, 1121744, 1093507, 1065848, 1038759, 1012230,
+    986252,  960817,  935915,  911539,  887679,  864328,  841476,  819116,  797240,  775839,
+    754906,  734433,  714411,  694834,  675693,  656982,  638692,  620817,  603349,  586282,
+    569607,  553318,  537409,  521872,  506701,  491889,  477430,  463316,  449543,  436103,
+    422990,  410198,  397721,  385554,  373689,  362122,  350880,  339987,  329432,  319205,
+    309295,  299693,  290389,  281374,  272639,  264175,  255973,  248027,  240327,  232866,
+    225636,  218631,  211844,  205267,  198895,  192720,  186737,  180940,  175322,  169880,
+    164606,  159495,  154544,  149746,  145097,  140593,  136228,  131999,  127901,  123930,
+    120083,  116355,  112743,  109242,  105851,  102565,   99381,   96295,   93306,   90409,
+     87603,   84884,   82252,   79705,   77238,   74850,   72538,   70299,   68131,   66033,
+     64000 } ;
+
+const int16_t  Atmosphere::TableAltBow[120] = {
+      -460,    -462,    -464,    -466,    -468,    -470,    -473,    -475,    -477,    -479,
+      -481,    -483,    -485,    -488,    -490,    -492,    -494,    -497,    -499,    -501,
+      -504,    -506,    -509,    -511,    -514,    -516,    -519,    -521,    -524,    -526,
+      -529,    -532,    -534,    -537,    -540,    -542,    -545,    -548,    -551,    -554,
+      -557,    -560,    -562,    -565,    -568,    -572,    -575,    -578,    -581,    -584,
+      -587,    -591,    -594,    -597,    -601,    -604,    -607,    -611,    -614,    -618,
+      -622,    -625,    -629,    -633,    -636,    -788,    -788,    -788,    -788,    -788,
+      -788,    -788,    -788,    -788,    -788,    -788,    -788,    -788,    -788,    -788,
+      -788,    -788,    -788,    -788,    -788,    -788,    -788,    -788,    -788,    -788,
+      -788,    -788,    -788,    -788,    -788,    -788,    -788,    -788,    -788,    -788,
+      -788,    -788,    -788,    -788,    -788,    -788,    -788,    -788,    -788,    -788,
+      -811,    -810,    -810,    -809,    -808,    -807,    -807,    -806,    -805,    -804 } ;
+
+const int16_t  Atmosphere::TablePressBow[120] = {
+      -106,    -104,    -103,    -101,    -100,     -98,     -97,     -96,     -94,     -93,
+       -92,     -90,     -89,     -88,     -86,     -85,     -84,     -82,     -81,     -80,
+       -79,     -78,     -76,     -75,     -74,     -73,     -72,     -71,     -69,     -68,
+       -67,     -66,     -65,     -64,     -63,     -62,     -61,     -60,     -59,     -58,
+       -57,     -56,     -55,     -54,     -53,     -52,     -51,     -50,     -50,     -49,
+       -48,     -47,     -46,     -45,     -44,     -44,     -43,     -42,     -41,     -41,
+       -40,     -39,     -38,     -38,     -37,     -44,     -43,     -42,     -40,     -39,
+       -38,     -37,     -36,     -34,     -33,     -32,     -31,     -30,     -29,     -28,
+       -28,     -27,     -26,     -25,     -24,     -24,     -23,     -22,     -21,     -21,
+       -20,     -20,     -19,     -18,     -18,     -17,     -17,     -16,     -16,     -15,
+       -15,     -14,     -14,     -13,     -13,     -13,     -12,     -12,     -11,     -11,
+       -11,     -11,     -10,     -10,     -10,      -9,      -9,      -9,      -8,      -8 } ;
 
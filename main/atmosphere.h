@@ -10,8 +10,15 @@ class Atmosphere
    // int32_t Altitude;    // [0.1 m   ]
    // int32_t Temperature; // [0.1 degC]
 
-   // altitude vs. pressure              //       20000, 30000, 40000, 50000, 60000, 70000, 80000, 90000, 100000, 110000     // [   Pa]
-   static const int32_t StdAltTable[10]; //  = { 117764, 91652, 71864, 55752, 42070, 30126, 19493,  9886,   1109,  -6984 } ; // [0.1 m]
+   // Standard atmosphere tables: knots every 200m from -2km to 22km, thus also at the layer boundaries at 11km and 20km.
+   // Between the knots the altitude vs. pressure and the pressure vs. altitude are each the chord plus a parabolic bow,
+   // which is the value at the segment middle minus the chord there.
+   static const int32_t  TableMinAlt = -20000;                           // [0.1 m]
+   static const int32_t  TableStep   =   2000;                           // [0.1 m]
+   static const uint8_t  TableSegs   =    120;
+   static const uint32_t TablePress   [TableSegs+1];                     // [1/16 Pa] pressure at the knots
+   static const int16_t  TableAltBow  [TableSegs];                       // [mm] altitude at the middle pressure minus the chord
+   static const int16_t  TablePressBow[TableSegs];                       // [1/16 Pa] pressure at the middle altitude minus the chord
 
   public:
    // dH/dP = -R/g*T => R = 287.04m^2/K/sec^2, g = 9.80655m/s^2
@@ -37,20 +44,36 @@ class Atmosphere
    static int32_t AltitudeDelta(int32_t PressureDelta, int32_t Pressure, int32_t Temperature) // [Pa], [Pa], [0.1degC]
    { int32_t PLR=PressureLapseRate(Pressure, Temperature); return AltitudeDelta(PressureDelta, PLR); } // [0.01m]
 
-   static int32_t StdAltitude(int32_t Pressure, int32_t PressStep=100)            // [Pa]
-   { int32_t Idx=(Pressure+5000)/10000; Idx-=2;
-     if(Idx<0) Idx=0; else if(Idx>9) Idx=9;
-     int32_t Press    = 10000*(Idx+2);
-     int32_t Altitude = 10*StdAltTable[Idx];
-     for( ; ; )
-     { int32_t Temp=StdTemperature(Altitude/10);
-       int32_t Delta=Pressure-Press; if(Delta==0) break;
-       if(Delta>PressStep) Delta=PressStep;
-       else if(Delta<(-PressStep)) Delta=(-PressStep);
-       Altitude+=AltitudeDelta(Delta, Press, Temp);
-       Press+=Delta;
-     }
-     return Altitude/10; }                                                          // [0.1m]
+   static int32_t TableBow(int32_t Bow, uint32_t Frac)                             // parabolic part at Frac [1/65536] within the segment
+   { int32_t Para = (Frac*(0x10000-Frac))>>14;                                      // 4*Frac*(1-Frac) [1/65536]
+     return (Bow*Para+0x8000)>>16; }
+
+   static int32_t StdAltitude_mm(int32_t Pressure)                                  // [1/16 Pa] => [mm] constant time, valid -2..22km
+   { if(Pressure>(int32_t)TablePress[0]) Pressure=TablePress[0];
+     else if(Pressure<(int32_t)TablePress[TableSegs]) Pressure=TablePress[TableSegs];
+     int Seg=0;                                                                     // binary search: TablePress[Seg] >= Pressure
+     for(int Step=64; Step; Step>>=1)
+     { int Idx=Seg+Step; if(Idx<TableSegs && (int32_t)TablePress[Idx]>=Pressure) Seg=Idx; }
+     uint32_t Width = TablePress[Seg]-TablePress[Seg+1];                           // [1/16 Pa] below 65536
+     uint32_t Pos   = TablePress[Seg]-Pressure;                                     // [1/16 Pa] within the segment
+     uint32_t Chord = TableStep*Pos/Width, Rem = TableStep*Pos-Chord*Width;          // [0.1 m] and the remainder
+     Chord = 100*Chord + (100*Rem+Width/2)/Width;                                   // [mm] not from Frac: that is too coarse
+     return 100*(TableMinAlt+Seg*TableStep) + Chord + TableBow(TableAltBow[Seg], (Pos<<16)/Width); }
+
+   static int32_t StdAltitude16(int32_t Pressure)                                   // [1/16 Pa] => [0.1 m]
+   { return (StdAltitude_mm(Pressure)+5000050)/100-50000; }                         // rounded, also below sea level
+
+   static int32_t StdAltitude(int32_t Pressure) { return StdAltitude16(Pressure<<4); } // [Pa] => [0.1 m]
+
+   static int32_t StdPressure16(int32_t Altitude)                                   // [0.1 m] => [1/16 Pa] constant time, valid -2..22km
+   { int32_t Ofs = Altitude-TableMinAlt;
+     if(Ofs<0) Ofs=0; else if(Ofs>TableSegs*TableStep) Ofs=TableSegs*TableStep;
+     int Seg = Ofs/TableStep; if(Seg>=TableSegs) Seg=TableSegs-1;
+     uint32_t Pos = Ofs-Seg*TableStep;                                              // [0.1 m] within the segment
+     uint32_t Chord = TablePress[Seg] - ((TablePress[Seg]-TablePress[Seg+1])*Pos+TableStep/2)/TableStep; // not from Frac: that is too coarse
+     return Chord + TableBow(TablePressBow[Seg], (Pos<<16)/TableStep); }
+
+   static int32_t StdPressure(int32_t Altitude) { return (StdPressure16(Altitude)+8)>>4; } // [0.1 m] => [Pa]
 
 #ifdef NO_RTOS
    static int32_t StdAltitude_float(int32_t Pressure)
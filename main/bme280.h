@@ -71,10 +71,10 @@ class BME280: public BMP280
   H6 = (int8_t)s[6];
   }
 
-  uint8_t Trigger(void)                                    // start  measurement
+  uint8_t Trigger(uint8_t Ctrl=0x55)                      // start  measurement
   { if(hasHumidity())
     { uint8_t Data=0x03; Error=I2C_Write(Bus, ADDR, REG_CTRL_HUM, Data); if(Error) return Error; } // H.osp=3x
-    return BMP280::Trigger(); }
+    return BMP280::Trigger(Ctrl); }
 
   uint8_t ReadRawHum(void)
   { RawHum=0;
@@ -89,7 +89,7 @@ class BME280: public BMP280
 
   uint8_t Acquire(void)
   { if(Trigger()) return Error;
-    if(WaitReady()!=1) return Error;
+    if(WaitReady()) return Error;
     if(ReadRawTemp()) return Error;
     if(ReadRawPress()) return Error;
     if(hasHumidity()) return ReadRawHum();
@@ -91,21 +91,24 @@ class BMP280
   { Error=I2C_Read(Bus, ADDR, REG_CALIB, (uint8_t *)Calib, 2*13);
     return Error; }
 
-  uint8_t ReadReady(void) // check if temperature and pressure conversion is done
+  uint8_t ReadStatus(bool &Ready) // check if temperature and pressure conversion is done
   { uint8_t Status;
     Error=I2C_Read(Bus, ADDR, REG_STATUS, Status); if(Error) return Error;
-    return (Status&0x09)==0; } // 1 = ready, 0 => busy
+    Ready = (Status&0x09)==0; return 0; } // 0 = no error, then Ready tells if the conversion is done
 
   uint8_t WaitReady(uint8_t Timeout=50, uint8_t Wait=30) // wait for the conversion to be ready
   { vTaskDelay(Wait);
     for(; Timeout; Timeout--)
-    { uint8_t Err=ReadReady(); if(Err) return Err; // 1 is ready, >1 is an I2C bus error
+    { bool Ready=0; if(ReadStatus(Ready)) return Error; // I2C bus error
+      if(Ready) return 0;
       vTaskDelay(1); }
-    return 0xFF; }            // return "timeout" error
+    return Error=0xFF; }      // return "timeout" error
 
-  uint8_t Trigger(void)                                    // start a temperature+pressure measurement
+  static const uint8_t CTRL_FAST = 0x31;                  // P.osp=8x, T.osp=1x: 22.5ms at most, for continuous sampling
+
+  uint8_t Trigger(uint8_t Ctrl=0x55)                       // start a temperature+pressure measurement
   { uint8_t Data=0x00; Error=I2C_Write(Bus, ADDR, REG_CONFIG, Data); if(Error) return Error;
-            Data=0x55; Error=I2C_Write(Bus, ADDR, REG_CTRL,   Data); return Error; } // P.osp=16x, T.osp=2x
+            Data=Ctrl; Error=I2C_Write(Bus, ADDR, REG_CTRL,   Data); return Error; } // default P.osp=16x, T.osp=2x: 43ms
 
   uint8_t ReadRawPress(void)                               // read raw pressure ADC conversion result
   { RawPress=0;
@@ -123,7 +126,7 @@ class BMP280
 
   uint8_t Acquire(void)                                    // trigger the readout and read raw results
   { if(Trigger()) return Error;
-    if(WaitReady()!=1) return Error;
+    if(WaitReady()) return Error;
     if(ReadRawTemp()) return Error;
     return ReadRawPress(); }
 
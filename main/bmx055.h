@@ -10,12 +10,19 @@ class BMX055_ACC
    static const uint8_t ADDR1        = 0x19;
 
    static const uint8_t REG_ID       = 0x00;
+   static const uint8_t REG_DATA     = 0x02; // X, Y, Z: 12-bit, left adjusted, LSB first
+   static const uint8_t REG_RANGE    = 0x0F;
+   static const uint8_t REG_BW       = 0x10;
 
   public:
+   static const int16_t OneG         = 512;  // [LSB] at the +/-4g range
+
    uint8_t Bus;                              // which I2C bus
    uint8_t ADDR;                             // detected I2C address
    uint8_t ID;                               // 0x58 for BMP280, 0x60 for BME280
 
+   int16_t X, Y, Z;                          // [1/512 g] last acceleration read
+
   public:
    uint8_t Error;                            // error on the I2C bus (0=no error)
 
@@ -27,6 +34,15 @@ class BMX055_ACC
      if( (!Error) && (ID==0xFA) ) { ADDR=ADDR1; return 0; }
      return 1; } // 0 => no error and correct ID
 
+  uint8_t Configure(void)                    // +/-4g range, 31Hz bandwidth: enough for the vario, not the engine vibration
+   { Error=I2C_Write(Bus, ADDR, REG_RANGE, 0x05); if(Error) return Error;
+     Error=I2C_Write(Bus, ADDR, REG_BW,    0x0A); return Error; }
+
+  uint8_t ReadAcc(void)                      // read X, Y, Z in one go
+   { int16_t Data[3];
+     Error=I2C_Read(Bus, ADDR, REG_DATA, (uint8_t *)Data, 6); if(Error) return Error;
+     X=Data[0]>>4; Y=Data[1]>>4; Z=Data[2]>>4; return 0; }
+
 } ;
 
 class BMX055_GYR
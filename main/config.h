@@ -47,6 +47,7 @@
 
 // #define WITH_GPS_ENABLE                    // use GPS_ENABLE control line to turn the GPS ON/OFF
 #define WITH_GPS_PPS                       // use the PPS signal from GPS for precise time-sync.
+#define WITH_PPS_IRQ                       // PPS edges time-stamped by an interrupt on the microsecond timer: drift-corrected time base
 #define WITH_GPS_CONFIG                    // attempt to configure higher GPS baud rate and airborne mode
 
 #define WITH_GPS_UBX                       // GPS understands UBX
@@ -71,6 +72,9 @@
 // #define WITH_BEEPER                        // with digital buzzer
 // #define WITH_SOUND                         // with analog sound produced by DAC on pin 25
 
+// #define WITH_RX_CHASE                      // when LDPC decode fails try flipping the least reliable bits
+// #define WITH_RF_IRQ                        // RF chip IRQ line wakes the RF task, received packets wake the PROC task: no 1ms polling
+
 // #define WITH_KNOB
 // #define WITH_VARIO
 
@@ -90,6 +94,8 @@
 #define WITH_SPIFFS                        // use SPIFFS file system in Flash
 #define WITH_SPIFFS_FAT                    // use FAT on the SPIFFS
 #define WITH_LOG                           // log own positions and other received to SPIFFS and possibly to uSD
+#define WITH_LOG_ZIP                       // log in the compact format: positions coded per aircraft against the previous one
+#define WITH_LOG_INDEX                     // sidecar index per log file: time range, aircraft and segment offsets for the HTTP log pages
 // #define WITH_SD                            // use the SD card in SPI mode and FAT file system
 // #define WITH_SDLOG                         // log console and IGC to the SD card
 
@@ -245,6 +245,15 @@ static void ProcessCtrlC(void)                                  // print system
   if(GPS_Status.MAV)         Format_String(CONS_UART_Write, ",MAV");
   if(GPS_Status.BaudConfig)  Format_String(CONS_UART_Write, ",BaudOK");
   if(GPS_Status.ModeConfig)  Format_String(CONS_UART_Write, ",ModeOK");
+#ifdef WITH_PPS_IRQ
+  { uint32_t Time, usTime, usUncert;
+    if(TimeSync_usTime(Time, usTime, usUncert))              // oscillator drift and the time uncertainty now
+    { Format_String(CONS_UART_Write, ",Clock:");
+      Format_SignDec(CONS_UART_Write, TimeSync_Drift(), 4, 3);
+      Format_String(CONS_UART_Write, "ppm/");
+      Format_UnsDec(CONS_UART_Write, usUncert);
+      Format_String(CONS_UART_Write, "us"); } }
+#endif
   CONS_UART_Write('\r'); CONS_UART_Write('\n');
   PrintTasks(CONS_UART_Write);                               // print the FreeRTOS tasks
 
@@ -257,6 +266,14 @@ static void ProcessCtrlC(void)                                  // print system
   Format_SignDec(CONS_UART_Write, (600*BatteryVoltageRate+128)>>8, 3, 1);
   Format_String(CONS_UART_Write, "mV/min\n");
 
+  RelaySched.Print(Line, Parameters.TxPower);                // relay counters and the energy spent
+  Format_String(CONS_UART_Write, Line);
+
+#if defined(WITH_ST7789) || defined(WITH_ILI9341)
+  LCD_Stats.Print(Line);                                     // LCD frame time and bytes per frame
+  Format_String(CONS_UART_Write, Line);
+#endif
+
 #ifdef WITH_AXP
   uint16_t Batt=AXP.readBatteryVoltage();       // [mV]
   uint16_t InpCurr=AXP.readBatteryInpCurrent(); // [mA]
@@ -0,0 +1,63 @@
+#ifndef __DECIMATE_H__
+#define __DECIMATE_H__
+
+#include <stdint.h>
+#include <math.h>
+
+// Ring of time-stamped samples taken at a high rate and decimated to a low output rate by a FIR filter:
+// the least-squares line through the samples of the last Window, evaluated at the newest sample.
+// Unlike a plain average the line follows a steady climb without lag, and its residuals measure the noise.
+// The samples need not be evenly spaced: each carries its own time.
+
+template <class Int=int32_t, uint8_t Size=32> // size must be (!) a power of 2 like 4, 8, 16, 32, etc.
+ class LineDecimator
+{ public:
+   static const uint8_t PtrMask = Size-1;
+
+   Int      Data[Size];
+   uint32_t Time[Size];                                   // [ms] when each sample was taken
+   uint8_t  Ptr;                                          // where the next sample goes
+   uint8_t  Count;                                        // samples stored
+
+   float    Out;                                          // line at the newest sample
+   float    Slope;                                        // [1/sec] its slope
+   float    Noise;                                        // RMS residual of one sample
+   float    OutNoise;                                     // RMS noise of Out: the fit averages the samples
+   uint8_t  Used;                                         // samples in the last fit
+
+  public:
+   void Clear(void) { Ptr=0; Count=0; Used=0; }
+
+   void Input(Int Inp, uint32_t msTime)
+   { Data[Ptr]=Inp; Time[Ptr]=msTime; Ptr=(Ptr+1)&PtrMask;
+     if(Count<Size) Count++; }
+
+   uint32_t getTime(void) const { return Time[(Ptr-1)&PtrMask]; } // [ms] of the newest sample
+
+   bool Fit(uint32_t Window)                              // [ms] over the samples up to Window older than the newest one
+   { Used=0; if(Count==0) return 0;
+     uint8_t Last=(Ptr-1)&PtrMask;
+     uint32_t Ref=Time[Last]; Int RefData=Data[Last];     // relative to the newest sample: small numbers for the float
+     float N=0, Sx=0, Sy=0, Sxx=0, Sxy=0;
+     for(uint8_t Idx=0; Idx<Count; Idx++)
+     { uint8_t Pos=(Last-Idx)&PtrMask;
+       uint32_t Age=Ref-Time[Pos]; if(Age>Window) break;
+       float X=-0.001f*Age, Y=Data[Pos]-RefData;
+       N++; Sx+=X; Sy+=Y; Sxx+=X*X; Sxy+=X*Y; }
+     Used=N;
+     float Den=N*Sxx-Sx*Sx;
+     if(N<3 || Den<=0) { Out=RefData; Slope=0; Noise=OutNoise=0; return 0; } // too few: the newest sample as it is
+     Slope = (N*Sxy-Sx*Sy)/Den;
+     float Ofs = (Sy-Slope*Sx)/N;                         // the line at the newest sample
+     float Res2=0;
+     for(uint8_t Idx=0; Idx<Used; Idx++)
+     { uint8_t Pos=(Last-Idx)&PtrMask;
+       float X=-0.001f*(Ref-Time[Pos]), Res=(Data[Pos]-RefData)-(Ofs+Slope*X);
+       Res2+=Res*Res; }
+     Noise = sqrtf(Res2/(N-2));
+     OutNoise = Noise*sqrtf(Sxx/Den);                     // the end of the line is less certain than its middle
+     Out = RefData+Ofs; return 1; }
+
+} ;
+
+#endif // __DECIMATE_H__
@@ -95,6 +95,7 @@ void vTaskDISP(void* pvParameters)
 #else
     if(PageChange) LCD_Backlight=8*16+8;                           // high backlight on page change
 #endif
+    LCD_FrameStart();                                              // count the bytes and the time to draw the page
     switch(DISP_Page)
     { case 0: if(PageChange) LCD_LogoPage_Draw(Time, GPS);         // logo with basic information
               LCD_LogoPage_Update(Time, GPS, TimeChange, GPSchange);
@@ -124,6 +125,7 @@ void vTaskDISP(void* pvParameters)
               LCD_SysPage_Update(Time, GPS, TimeChange, GPSchange);
               break;
     }
+    LCD_FrameEnd();
     if(TimeChange)                                                 // on each new second
     { LCD_SetBacklightLevel(LCD_Backlight/16);                     // 
       if(LCD_Backlight>LCD_BacklightLimit) LCD_Backlight--; }      // reduce backlight a lttle if above minimum
@@ -537,7 +537,8 @@ static void LCD_UpdateLookList(bool Redraw=0)
     // Len+=Format_UnsDec(Line+Len, ((Tgt->MissDist>>1)+50)/100, 2, 1);
     Len+=Format_UnsDec(Line+Len, ((Tgt->HorDist>>1)+50)/100, 2, 1);
     Line[Len++]='k'; Line[Len++]='m'; Line[Len++]=' '; Line[Len]=0;
-    LCD_DrawString(Line, 4, PosY, RGB565_BLACK, Bkg);
+    int Width=LCD_DrawString(Line, 4, PosY, RGB565_BLACK, Bkg);   // unchanged characters are not sent again
+    LCD_DrawBox(4+Width, PosY, LCD_WIDTH-4-Width, LCD_FontHeight(), RGB565_WHITE); // the tail of a longer line before
     PosY+=LCD_FontHeight(); Lines++; }
   for( uint8_t Idx=0; Idx<Look.MaxTargets; Idx++)
   { if(PosY>(LCD_HEIGHT-2*LCD_FontHeight())) break;
@@ -550,7 +551,8 @@ static void LCD_UpdateLookList(bool Redraw=0)
     Line[Len++]=' '; Line[Len++]=' '; Line[Len++]=' '; Line[Len++]=' '; Line[Len++]=' ';
     Len+=Format_UnsDec(Line+Len, ((Tgt->HorDist>>1)+50)/100, 2, 1);
     Line[Len++]='k'; Line[Len++]='m'; Line[Len++]=' '; Line[Len]=0;
-    LCD_DrawString(Line, 4, PosY, RGB565_BLACK, Bkg);
+    int Width=LCD_DrawString(Line, 4, PosY, RGB565_BLACK, Bkg);   // unchanged characters are not sent again
+    LCD_DrawBox(4+Width, PosY, LCD_WIDTH-4-Width, LCD_FontHeight(), RGB565_WHITE); // the tail of a longer line before
     PosY+=LCD_FontHeight(); Lines++; }
   for(uint8_t Line=Lines; Line<PrevLines; Line++)
   { if(PosY>(LCD_HEIGHT-2*LCD_FontHeight())) break;
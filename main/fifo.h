@@ -2,6 +2,9 @@
 #define __FIFO_H__
 
 #include <stdint.h>
+#include <stddef.h>
+
+#include <atomic>
 
 template <class Type, const size_t Size=8> // size must be (!) a power of 2 like 4, 8, 16, 32, etc.
  class FIFO
@@ -102,6 +105,115 @@ template <class Type, const size_t Size=8> // size must be (!) a power of 2 like
 */
 } ;
 
+// FIFO shared between two tasks (possibly on two cores) without a mutex: exactly one task writes, one task reads.
+// The writer owns WritePtr, the reader owns ReadPtr, each is published with release and read by the other side with acquire,
+// thus the elements are complete when the other side sees the pointer move. Pointers run freely and are masked on access.
+// Like FIFO it holds up to Size-1 elements: getWrite() always gives a slot the reader cannot see yet.
+
+template <class Type, const size_t Size=8> // size must be (!) a power of 2 like 4, 8, 16, 32, etc.
+ class SPSC_FIFO
+{ public:
+   static const size_t Len = Size;
+   static const size_t PtrMask = Size-1;
+
+   Type Data[Len];
+   std::atomic<size_t> ReadPtr;
+   std::atomic<size_t> WritePtr;
+   std::atomic<size_t> HighWater;         // highest number of stored elements seen by the writer
+   std::atomic<size_t> Overflows;         // number of elements refused because the FIFO was full
+
+  public:
+   void Clear(void)                       // clear all stored data and statistics: not while the other task is using the FIFO
+   { ReadPtr.store(0); WritePtr.store(0); HighWater.store(0); Overflows.store(0); }
+
+   size_t Free(void) const                // number of free elements: how much can you write into te FIFO
+   { return Size-1-Full(); }
+
+   size_t Full(void) const                // number of stored elements: how much you can read from the FIFO
+   { size_t Ptr=ReadPtr.load(std::memory_order_acquire);                  // read first: it never passes WritePtr
+     return WritePtr.load(std::memory_order_acquire)-Ptr; }
+
+   bool isFull(void) const  { return Free()==0; }
+   bool isEmpty(void) const { return Full()==0; }
+
+   // writer side
+
+   Type *getWrite(void)                   // get pointer to the next element which can be written
+   { return Data+(WritePtr.load(std::memory_order_relaxed)&PtrMask); }
+
+   size_t Write(void)                     // publish the element from getWrite()
+   { return flushWriteBlock(1); }
+
+   size_t Write(Type Byte)                // write a single element
+   { *getWrite()=Byte; return flushWriteBlock(1); }
+
+   size_t getWriteBlock(Type *&Byte)      // get a pointer and the number of consecutive elements which can be written
+   { size_t Ptr=WritePtr.load(std::memory_order_relaxed);
+     size_t Free=Size-1-(Ptr-ReadPtr.load(std::memory_order_acquire)); // acquire: the reader is done with these elements
+     Byte=Data+(Ptr&PtrMask);
+     size_t Cont=Size-(Ptr&PtrMask);
+     return Free<Cont ? Free:Cont; }
+
+   size_t flushWriteBlock(size_t Len)     // publish Len elements written after getWriteBlock() or getWrite()
+   { size_t Ptr=WritePtr.load(std::memory_order_relaxed);
+     size_t Stored=Ptr-ReadPtr.load(std::memory_order_acquire);
+     if(Stored+Len>Size-1) { Overflows.fetch_add(Len, std::memory_order_relaxed); return 0; }
+     Stored+=Len;
+     WritePtr.store(Ptr+Len, std::memory_order_release);                    // release: elements written before the pointer moves
+     if(Stored>HighWater.load(std::memory_order_relaxed)) HighWater.store(Stored, std::memory_order_relaxed);
+     return Len; }
+
+   size_t Write(const Type *Data, size_t Len) // write a block of elements, published at most twice (at the wrap-around)
+   { size_t Done=0;
+     while(Done<Len)
+     { Type *Block; size_t Cont=getWriteBlock(Block); if(Cont==0) break;
+       if(Cont>Len-Done) Cont=Len-Done;
+       for(size_t Idx=0; Idx<Cont; Idx++) Block[Idx]=Data[Done+Idx];
+       flushWriteBlock(Cont); Done+=Cont; }
+     if(Done<Len) Overflows.fetch_add(Len-Done, std::memory_order_relaxed);
+     return Done; }
+
+   // reader side
+
+   Type *getRead(void)                    // the oldest element or NULL when empty
+   { size_t Ptr=ReadPtr.load(std::memory_order_relaxed);
+     if(Ptr==WritePtr.load(std::memory_order_acquire)) return 0;          // acquire: element complete when the pointer moved
+     return Data+(Ptr&PtrMask); }
+
+   Type *getRead(size_t Idx)
+   { size_t Ptr=ReadPtr.load(std::memory_order_relaxed);
+     if(Idx>=WritePtr.load(std::memory_order_acquire)-Ptr) return 0;
+     return Data+((Ptr+Idx)&PtrMask); }
+
+   size_t getReadBlock(Type *&Byte)       // get a pointer to the first element and the number of consecutive elements available for read
+   { size_t Ptr=ReadPtr.load(std::memory_order_relaxed);
+     size_t Stored=WritePtr.load(std::memory_order_acquire)-Ptr;
+     if(Stored==0) { Byte=0; return 0; }
+     Byte=Data+(Ptr&PtrMask);
+     size_t Cont=Size-(Ptr&PtrMask);
+     return Stored<Cont ? Stored:Cont; }
+
+   void flushReadBlock(size_t Len)        // release the elements which were already read: to be used after getReadBlock() or getRead()
+   { ReadPtr.store(ReadPtr.load(std::memory_order_relaxed)+Len, std::memory_order_release); } // release: done with the elements
+
+   void Read(void)                        // drop the oldest element
+   { if(getRead()) flushReadBlock(1); }
+
+   size_t Read(Type &Byte)                // read a single element
+   { Type *Elem=getRead(); if(Elem==0) return 0;
+     Byte=*Elem; flushReadBlock(1); return 1; }
+
+   size_t Read(Type *Data, size_t Len)    // read a block of elements, released at most twice (at the wrap-around)
+   { size_t Done=0;
+     while(Done<Len)
+     { Type *Block; size_t Cont=getReadBlock(Block); if(Cont==0) break;
+       if(Cont>Len-Done) Cont=Len-Done;
+       for(size_t Idx=0; Idx<Cont; Idx++) Data[Done+Idx]=Block[Idx];
+       flushReadBlock(Cont); Done+=Cont; }
+     return Done; }
+
+} ;
+
 template <class Type, const uint8_t Size=8> // size must be (!) a power of 2 like 4, 8, 16, 32, etc.
  class Delay
 { public:
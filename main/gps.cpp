@@ -43,6 +43,7 @@ static MAV_RxMsg   MAV;                  // MAVlink message catcher
 #endif
 
 uint16_t GPS_PosPeriod = 0;                    // [mss] time between succecive GPS readouts
+uint16_t GPS_BurstDelay = 0;                   // [ms] from the start of the GPS data burst till the position is complete
 
 // uint8_t  GPS_PowerMode = 2;                    // 0=shutdown, 1=reduced power, 2=normal
 
@@ -233,13 +234,23 @@ int16_t GPS_AverageSpeed(void)                        // get average speed based
 
 // ----------------------------------------------------------------------------
 
+#ifdef WITH_PPS_IRQ
+static void GPS_PPS_On(int64_t usEdge)                // called with the rising edge of PPS captured by the interrupt
+{ static TickType_t PrevTickCount=0;
+  PPS_Tick = xTaskGetTickCount()-(TickType_t)((HAL_usTime()-usEdge+500)/1000); // [ms] TickCount at the edge
+#else
 static void GPS_PPS_On(void)                          // called on rising edge of PPS
 { static TickType_t PrevTickCount=0;
   PPS_Tick = xTaskGetTickCount();                     // [ms] TickCount now
+#endif
   TickType_t Delta = PPS_Tick-PrevTickCount;          // [ms] time difference to the previous PPS
   PrevTickCount = PPS_Tick;                           // [ms]
   if(abs((int)Delta-1000)>=20) return;                // [ms] filter out difference away from 1.00sec
+#ifdef WITH_PPS_IRQ
+  TimeSync_HardPPS_us(usEdge);                        // [us] synchronize the UTC time and discipline the microsecond clock
+#else
   TimeSync_HardPPS(PPS_Tick);                         // [ms] synchronize the UTC time to the PPS at given Tick
+#endif
 #ifdef DEBUG_PRINT
   xSemaphoreTake(CONS_Mutex, portMAX_DELAY);
   Format_UnsDec(CONS_UART_Write, TimeSync_Time()%60, 2);
@@ -483,6 +494,7 @@ static void GPS_Random_Update(GPS_Position *Pos)
 
 static void GPS_BurstComplete(void)                                        // when GPS has sent the essential data for position fix
 { GPS_Burst.Complete=1;
+  GPS_BurstDelay = (xTaskGetTickCount()-Burst_Tick)*portTICK_PERIOD_MS;    // [ms] from the start of the burst: ticks to ms
 #ifdef WITH_MAVLINK
   GPS_Position *GPS = GPS_Pos+GPS_PosIdx;
   if(GPS->hasTime && GPS->hasGPS && GPS->hasBaro)
@@ -723,11 +735,7 @@ static void GPS_NMEA(void)                                                 // wh
       CONS_UART_Write('\r'); CONS_UART_Write('\n');
       xSemaphoreGive(CONS_Mutex); }
 #ifdef WITH_SDLOG
-    if(Log_Free()>=128)
-    { xSemaphoreTake(Log_Mutex, portMAX_DELAY);
-      Format_String(Log_Write, (const char *)NMEA.Data, 0, NMEA.Len);
-      Log_Write('\r'); Log_Write('\n');
-      xSemaphoreGive(Log_Mutex); }
+    Log_Append((const char *)NMEA.Data, NMEA.Len, 1);
 #endif
   }
 }
@@ -1065,6 +1073,9 @@ void vTaskGPS(void* pvParameters)
     GPS_Pos[Idx].Clear();
   GPS_PosIdx=0;
 
+#if defined(WITH_GPS_PPS) && defined(WITH_PPS_IRQ)
+  GPS_PPS_Capture();                                                     // PPS edges time-stamped in the interrupt from now on
+#endif
   TickType_t RefTick = xTaskGetTickCount();
   for( ; ; )                                                              // main task loop: every milisecond (RTOS time tick)
   { vTaskDelay(1);                                                        // wait for the next time tick (but apparently it can wait more than one OS tick)
@@ -1085,35 +1096,54 @@ void vTaskGPS(void* pvParameters)
 #endif
 */
 #ifdef WITH_GPS_PPS
+#ifdef WITH_PPS_IRQ
+    { int64_t usEdge; if(GPS_PPS_usTime(usEdge)) GPS_PPS_On(usEdge); }   // PPS edge time-stamped by the interrupt
+    if(!GPS_PPS_isOn()) { if( PPS) { PPS=0; GPS_PPS_Off(); } } else PPS=1;
+#else
     if(GPS_PPS_isOn()) { if(!PPS) { PPS=1; GPS_PPS_On();  } }             // monitor GPS PPS signal
                   else { if( PPS) { PPS=0; GPS_PPS_Off(); } }             // and call handling calls
+#endif
 #endif
     LineIdle+=Delta;                                                      // count idle time
     NoValidData+=Delta;                                                   // count time without any valid NMEA nor UBX packet
     // uint16_t Bytes=0;
     // uint16_t MaxBytesPerTick = 1+(GPS_getBaudRate()+2500)/5000;
-    for( ; ; )                                                            // loop over bytes in the GPS UART buffer
-    { uint8_t Byte; int Err=GPS_UART_Read(Byte); if(Err<=0) break;        // get Byte from serial port, if no bytes then break this loop
-      // CONS_UART_Write(Byte);                                              // copy the GPS output to console (for debug only)
-      // Bytes++;
-      LineIdle=0;                                                         // if there was a byte: restart idle counting
-      NMEA.ProcessByte(Byte);                                             // process through the NMEA interpreter
+    for( ; ; )                                                            // drain the GPS UART buffer: all frames which arrived since the last tick
+    { static uint8_t RxBlock[128];
+      int Bytes=GPS_UART_Read(RxBlock, sizeof(RxBlock)); if(Bytes<=0) break; // get all bytes from serial port, if no bytes then break this loop
+      LineIdle=0;                                                         // if there were bytes: restart idle counting
+      for(int Idx=0; Idx<Bytes; )
+      { bool Idle=1;                                                      // UBX/MAV ignore printable bytes when not inside a frame
 #ifdef WITH_GPS_UBX
-      UBX.ProcessByte(Byte);
+        Idle &= !UBX.isLoading();
 #endif
 #ifdef WITH_MAVLINK
-      MAV.ProcessByte(Byte);
+        Idle &= MAV.Idx==0;
 #endif
-      if(NMEA.isComplete())                                               // NMEA completely received ?
-      { if(NMEA.isChecked()) { GPS_NMEA(); NoValidData=0; }               // NMEA check sum is correct ?
-        NMEA.Clear(); break; }
+        if(Idle) Idx+=NMEA.ProcessBlock(RxBlock+Idx, Bytes-Idx);          // so the body of an NMEA sentence goes in one scan
+        if(Idx>=Bytes) break;
+        uint8_t Byte=RxBlock[Idx++];                                      // the other bytes one by one through all interpreters
+        // CONS_UART_Write(Byte);                                            // copy the GPS output to console (for debug only)
+        NMEA.ProcessByte(Byte);                                           // process through the NMEA interpreter
 #ifdef WITH_GPS_UBX
-      if(UBX.isComplete()) { GPS_UBX(); NoValidData=0; UBX.Clear(); break; }
+        UBX.ProcessByte(Byte);
 #endif
 #ifdef WITH_MAVLINK
-      if(MAV.isComplete()) { GPS_MAV(); NoValidData=0; MAV.Clear(); break; }
+        MAV.ProcessByte(Byte);
 #endif
-      // if(Bytes>=MaxBytesPerTick) break;
+        bool Frame=0;
+        if(NMEA.isComplete())                                             // NMEA completely received ?
+        { if(NMEA.isChecked()) { GPS_NMEA(); NoValidData=0; Frame=1; }    // NMEA check sum is correct ?
+          NMEA.Clear(); }
+#ifdef WITH_GPS_UBX
+        if(UBX.isComplete()) { GPS_UBX(); NoValidData=0; UBX.Clear(); Frame=1; }
+#endif
+#ifdef WITH_MAVLINK
+        if(MAV.isComplete()) { GPS_MAV(); NoValidData=0; MAV.Clear(); Frame=1; }
+#endif
+        if(Frame && GPS_Burst.Active && !GPS_Burst.Complete && GPS_Burst.GxGGA && GPS_Burst.GxRMC && GPS_Burst.GxGSA)
+          GPS_BurstComplete();                                            // declare burst complete right after the frame which completes it
+      }
     }
 /*
 #ifdef DEBUG_PRINT
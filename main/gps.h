@@ -26,6 +26,7 @@ extern          uint16_t GPS_LatCosine;     // [1.0/(1<<12)] Latitude Cosine for
 extern          uint32_t GPS_TimeSinceLock; // [sec] time since GPS has a valid lock
 extern          uint32_t GPS_Random;        // random number produced from the GPS data
 extern          uint16_t GPS_PosPeriod;     // [msec] how often (which period) the GPS/MAV is sending the positions
+extern          uint16_t GPS_BurstDelay;    // [msec] from the start of the GPS data burst till the position is complete
 
 extern          uint16_t GPS_SatSNR;        // [0.25dB] average SNR for satellites being tracked
 extern           uint8_t GPS_SatCnt;        // [0.25dB] number of satellites being tracked
@@ -18,6 +18,7 @@
 #endif
 
 #include "esp_system.h"
+#include "esp_timer.h"
 #include "esp_freertos_hooks.h"
 
 #if defined(WITH_BT_SPP) || defined(WITH_BLE_SPP)
@@ -737,6 +738,7 @@ void  AERO_UART_SetBaudrate(int BaudRate)  {        uart_set_baudrate(AERO_UART,
 #ifdef GPS_UART
 // int   GPS_UART_Full       (void)          { size_t Full=0; uart_get_buffered_data_len(GPS_UART, &Full); return Full; }
 int   GPS_UART_Read       (uint8_t &Byte) { return uart_read_bytes  (GPS_UART, &Byte, 1, 0); }  // should be buffered and non-blocking
+int   GPS_UART_Read       (uint8_t *Data, int MaxLen) { return uart_read_bytes(GPS_UART, Data, MaxLen, 0); } // all what is buffered, up to MaxLen
 void  GPS_UART_Write      (char     Byte) {        uart_write_bytes (GPS_UART, &Byte, 1);    }  // should be buffered and blocking
 void  GPS_UART_Flush      (int MaxWait  ) {        uart_wait_tx_done(GPS_UART, MaxWait);     }
 void  GPS_UART_SetBaudrate(int BaudRate ) {        uart_set_baudrate(GPS_UART, BaudRate);    }
@@ -749,7 +751,32 @@ void GPS_ENABLE (void) { gpio_set_level(PIN_GPS_ENA, 1); }
 
 #ifdef PIN_GPS_PPS
 bool GPS_PPS_isOn(void) { return gpio_get_level(PIN_GPS_PPS); }
-#endif
+
+#ifdef WITH_PPS_IRQ
+static portMUX_TYPE PPS_Mux = portMUX_INITIALIZER_UNLOCKED;
+static int64_t PPS_usEdge = 0;                            // [us] timer at the newest edge
+static bool    PPS_New    = 0;                            // not yet taken by the GPS task
+
+static void IRAM_ATTR GPS_PPS_Handler(void *Arg)
+{ int64_t usTime = esp_timer_get_time();                  // first thing: the latency adds to the error
+  portENTER_CRITICAL_ISR(&PPS_Mux);
+  PPS_usEdge=usTime; PPS_New=1;
+  portEXIT_CRITICAL_ISR(&PPS_Mux); }
+
+void GPS_PPS_Capture(void)
+{ gpio_set_intr_type(PIN_GPS_PPS, GPIO_INTR_POSEDGE);     // the second starts at the rising edge
+  gpio_install_isr_service(0);                            // can fail when already installed, which is fine
+  gpio_isr_handler_add(PIN_GPS_PPS, GPS_PPS_Handler, 0); }
+
+bool GPS_PPS_usTime(int64_t &usEdge)
+{ portENTER_CRITICAL(&PPS_Mux);                           // 64-bit: not atomic against the interrupt
+  bool New=PPS_New; usEdge=PPS_usEdge; PPS_New=0;
+  portEXIT_CRITICAL(&PPS_Mux);
+  return New; }
+#endif // WITH_PPS_IRQ
+#endif // PIN_GPS_PPS
+
+int64_t HAL_usTime(void) { return esp_timer_get_time(); }
 
 //--------------------------------------------------------------------------------------------------------
 // RF chip
@@ -774,6 +801,21 @@ void RFM_RESET(uint8_t On) { }
 
 void RFM_IRQ_SetInput(void) { gpio_set_direction(PIN_RFM_IRQ, GPIO_MODE_INPUT); }
 bool RFM_IRQ_isOn(void)      { return gpio_get_level(PIN_RFM_IRQ); }
+
+#ifdef WITH_RF_IRQ
+static TaskHandle_t RFM_IRQ_Task = 0;                    // task to be woken by the IRQ line
+
+static void IRAM_ATTR RFM_IRQ_Handler(void *Arg)
+{ BaseType_t Woken=pdFALSE;
+  if(RFM_IRQ_Task) vTaskNotifyGiveFromISR(RFM_IRQ_Task, &Woken);
+  if(Woken) portYIELD_FROM_ISR(); }
+
+void RFM_IRQ_Notify(TaskHandle_t Task)
+{ RFM_IRQ_Task=Task;
+  gpio_set_intr_type(PIN_RFM_IRQ, GPIO_INTR_POSEDGE);     // packet done: the line goes HIGH and stays until the IRQ flags are cleared
+  gpio_install_isr_service(0);                            // can fail when already installed, which is fine
+  gpio_isr_handler_add(PIN_RFM_IRQ, RFM_IRQ_Handler, 0); }
+#endif
 #ifdef WITH_SX1262
 void RFM_Busy_SetInput(void) { gpio_set_direction(PIN_RFM_BUSY, GPIO_MODE_INPUT); }
 bool RFM_Busy_isOn(void)      { return gpio_get_level(PIN_RFM_BUSY); }
@@ -80,11 +80,17 @@ int  CONS_UART_Full       (void);          // how many bytes already in the tran
 void CONS_UART_SetBaudrate(int BaudRate);
 
 int   GPS_UART_Read       (uint8_t &Byte); // non-blocking
+int   GPS_UART_Read       (uint8_t *Data, int MaxLen); // non-blocking, returns the number of bytes read
 void  GPS_UART_Write      (char     Byte); // blocking
 void  GPS_UART_Flush      (int MaxWait  ); // wait for data to be pushed out
 void  GPS_UART_SetBaudrate(int BaudRate);
 
 bool GPS_PPS_isOn(void);
+#ifdef WITH_PPS_IRQ
+void GPS_PPS_Capture(void);               // time-stamp the rising PPS edges in an interrupt
+bool GPS_PPS_usTime(int64_t &usEdge);     // [us] local time of the newest edge, 0: no new edge since the last call
+#endif
+int64_t HAL_usTime(void);                 // [us] free-running local timer since boot
 #ifdef WITH_GPS_ENABLE
 void GPS_ENABLE(void);
 void GPS_DISABLE(void);
@@ -99,6 +105,9 @@ void  AERO_UART_SetBaudrate(int BaudRate);
 void RFM_TransferBlock(uint8_t *Data, uint8_t Len);
 void RFM_RESET(uint8_t On);              // RF module reset
 bool RFM_IRQ_isOn(void);                 // query the IRQ state
+#ifdef WITH_RF_IRQ
+void RFM_IRQ_Notify(TaskHandle_t Task);  // notify the task on every rising edge of the IRQ line
+#endif
 void RFM_Delay(int ms);                  // [ms] idle delay
 #ifdef WITH_SX1262
 void RFM_Busy_SetInput(void);
@@ -17,6 +17,10 @@
 #include "proc.h"
 #include "gps.h"
 #include "log.h"
+#include "logzip.h"
+#include "logidx.h"
+#include "logexport.h"
+#include "sdlog.h"
 #include "http.h"
 #include "ognconv.h"
 
@@ -579,6 +583,20 @@ static void Table_System(httpd_req_t *Req)
   Len+=Format_String(Line+Len, "</td></tr>\n");
   httpd_resp_send_chunk(Req, Line, Len);
 
+#ifdef WITH_SDLOG
+  Len =Format_String(Line, "<tr><td>SD log queue</td><td align=\"right\">");
+  Len+=Format_UnsDec(Line+Len, (uint32_t)Log_Full());
+  Line[Len++]='/';
+  Len+=Format_UnsDec(Line+Len, (uint32_t)Log_HighWater());                 // the most bytes ever waiting
+  Len+=Format_String(Line+Len, "B ");
+  Len+=Format_UnsDec(Line+Len, Log_MaxWrite);                              // longest SD write
+  Len+=Format_String(Line+Len, "ms");
+  if(Log_Stalls)  { Line[Len++]=' '; Len+=Format_UnsDec(Line+Len, Log_Stalls); Len+=Format_String(Line+Len, " stalls"); }
+  if(Log_Dropped) { Line[Len++]=' '; Len+=Format_UnsDec(Line+Len, Log_Dropped); Len+=Format_String(Line+Len, "B lost"); }
+  Len+=Format_String(Line+Len, "</td></tr>\n");
+  httpd_resp_send_chunk(Req, Line, Len);
+#endif
+
   Len =Format_String(Line, "<tr><td>SPIFFS</td><td align=\"right\">");
 #ifdef WITH_SPIFFS
   Len+=Format_String(Line+Len, "Yes");
@@ -658,6 +676,11 @@ static void Table_GPS(httpd_req_t *Req)
   Len+=Format_String(Line+Len, "dB</td></tr>\n");
   httpd_resp_send_chunk(Req, Line, Len);
 
+  Len =Format_String(Line, "<tr><td>Burst to fix</td><td align=\"right\">");
+  Len+=Format_UnsDec(Line+Len, GPS_BurstDelay);
+  Len+=Format_String(Line+Len, " ms</td></tr>\n");
+  httpd_resp_send_chunk(Req, Line, Len);
+
   Len =Format_String(Line, "<tr><td>Latitude</td><td align=\"right\">");
   Len+=Format_SignDec(Line+Len, GPS->Latitude/6, 7, 5);
   Len+=Format_String(Line+Len, "&deg;</td></tr>\n");
@@ -755,7 +778,45 @@ static void Table_Relay(httpd_req_t *Req)
     Len+=Format_String(Line+Len, "</td></tr>\n");
     httpd_resp_send_chunk(Req, Line, Len); }
 
-  httpd_resp_sendstr_chunk(Req, "</tbody>\n</table>\n"); }
+  httpd_resp_sendstr_chunk(Req, "</tbody>\n</table>\n");
+
+  httpd_resp_sendstr_chunk(Req, "<table class=\"table table-striped table-bordered\">\n");
+  Len =Format_String(Line, "<tr><td>Relayed</td><td align=\"right\">");
+  Len+=Format_UnsDec(Line+Len, RelaySched.Relayed);
+  Len+=Format_String(Line+Len, "pkt</td></tr>\n");
+  httpd_resp_send_chunk(Req, Line, Len);
+
+  Len =Format_String(Line, "<tr><td>Duplicate</td><td align=\"right\">");
+  Len+=Format_UnsDec(Line+Len, RelaySched.Duplicate);
+  Len+=Format_String(Line+Len, "pkt</td></tr>\n");
+  httpd_resp_send_chunk(Req, Line, Len);
+
+  Len =Format_String(Line, "<tr><td>Suppressed</td><td align=\"right\">");
+  Len+=Format_UnsDec(Line+Len, RelaySched.Suppressed);
+  Len+=Format_String(Line+Len, "pkt</td></tr>\n");
+  httpd_resp_send_chunk(Req, Line, Len);
+
+  Len =Format_String(Line, "<tr><td>Held back</td><td align=\"right\">");
+  Len+=Format_UnsDec(Line+Len, RelaySched.Held);
+  Len+=Format_String(Line+Len, "s</td></tr>\n");
+  httpd_resp_send_chunk(Req, Line, Len);
+
+  Len =Format_String(Line, "<tr><td>Credit spent</td><td align=\"right\">");
+  Len+=Format_UnsDec(Line+Len, RelaySched.CreditSpent);
+  Len+=Format_String(Line+Len, "ms</td></tr>\n");
+  httpd_resp_send_chunk(Req, Line, Len);
+
+  Len =Format_String(Line, "<tr><td>Energy</td><td align=\"right\">");
+  Len+=Format_UnsDec(Line+Len, RelaySched.Energy(Parameters.TxPower));
+  Len+=Format_String(Line+Len, "mJ</td></tr>\n");
+  httpd_resp_send_chunk(Req, Line, Len);
+
+  Len =Format_String(Line, "<tr><td>Efficiency</td><td align=\"right\">");
+  Len+=Format_UnsDec(Line+Len, RelaySched.Efficiency(Parameters.TxPower));
+  Len+=Format_String(Line+Len, "pkt/J</td></tr>\n");
+  httpd_resp_send_chunk(Req, Line, Len);
+
+  httpd_resp_sendstr_chunk(Req, "</table>\n"); }
 
 // -------------------------------------------------------------------------------------------------------------
 
@@ -797,6 +858,11 @@ static void Table_RF(httpd_req_t *Req)
   Len+=Format_String(Line+Len, "/min</td></tr>\n");
   httpd_resp_send_chunk(Req, Line, Len);
 
+  Len =Format_String(Line, "<tr><td>Rx FEC iter.</td><td align=\"right\">");
+  Len+=Format_UnsDec(Line+Len, (uint32_t)(10*RX_OGN_Iter64+RX_OGN_Count64/2)/(RX_OGN_Count64?RX_OGN_Count64:1), 2, 1);
+  Len+=Format_String(Line+Len, "/pkt</td></tr>\n");
+  httpd_resp_send_chunk(Req, Line, Len);
+
   Len =Format_String(Line, "<tr><td>Temperature</td><td align=\"right\">");
   Len+=Format_SignDec(Line+Len, (int16_t)TRX.chipTemp);
   Len+=Format_String(Line+Len, "&deg;C</td></tr>\n");
@@ -804,7 +870,12 @@ static void Table_RF(httpd_req_t *Req)
 
   Len =Format_String(Line, "<tr><td>Rx queue</td><td align=\"right\">");
   Len+=Format_UnsDec(Line+Len, RF_RxFIFO.Full());
-  Len+=Format_String(Line+Len, "pkt</td></tr>\n");
+  Line[Len++]='/';
+  Len+=Format_UnsDec(Line+Len, (uint32_t)RF_RxFIFO.HighWater.load(std::memory_order_relaxed)); // the most packets ever waiting
+  Len+=Format_String(Line+Len, "pkt");
+  size_t Lost=RF_RxFIFO.Overflows.load(std::memory_order_relaxed);                // packets dropped on a full queue
+  if(Lost) { Line[Len++]=' '; Len+=Format_UnsDec(Line+Len, (uint32_t)Lost); Len+=Format_String(Line+Len, " lost"); }
+  Len+=Format_String(Line+Len, "</td></tr>\n");
   httpd_resp_send_chunk(Req, Line, Len);
 
   Len =Format_String(Line, "<tr><td>Band</td><td align=\"right\">");
@@ -1123,16 +1194,79 @@ static int LogFileName(char *Name, time_t Time, const char *Ext=0)
   if(Ext) Len+=Format_String(Name+Len, Ext);
   Name[Len]=0; return Len; }
 
+class LogSelect                                                // which part of a log file to send
+{ public:
+   uint32_t From, To;                                          // [sec] time window
+   uint32_t Address;                                           // aircraft address or 0xFFFFFFFF for all
+
+  public:
+   LogSelect() { From=0; To=0xFFFFFFFF; Address=0xFFFFFFFF; }
+   bool oneAcft(void) const { return Address!=0xFFFFFFFF; }
+
+   int Format(char *Out) const                                 // as the URL query: for the links
+   { int Len=0;
+     if(oneAcft()) { Len+=Format_String(Out+Len, "&Acft="); Len+=Format_Hex(Out+Len, Address, 6); }
+     if(From) { Len+=Format_String(Out+Len, "&From="); Len+=Format_UnsDec(Out+Len, From); }
+     if(To!=0xFFFFFFFF) { Len+=Format_String(Out+Len, "&To="); Len+=Format_UnsDec(Out+Len, To); }
+     Out[Len]=0; return Len; }
+
+   void Read(const char *URL)                                  // from the URL query
+   { char Value[12];
+     if(httpd_query_key_value(URL, "Acft", Value, sizeof(Value))==ESP_OK && Read_Hex(Address, Value)>0) Address&=0x00FFFFFF;
+     if(httpd_query_key_value(URL, "From", Value, sizeof(Value))==ESP_OK) Read_UnsDec(From, Value);
+     if(httpd_query_key_value(URL, "To"  , Value, sizeof(Value))==ESP_OK) Read_UnsDec(To, Value); }
+} ;
+
+static int LogFileName(char *Name, uint32_t FileTime, const LogSelect &Sel, const char *Ext) // name of an extract
+{ int Len=LogFileName(Name, Sel.From>FileTime ? Sel.From:FileTime);
+  if(Sel.oneAcft()) { Name[Len++]='_'; Len+=Format_Hex(Name+Len, Sel.Address, 6); }
+  Len+=Format_String(Name+Len, Ext);
+  Name[Len]=0; return Len; }
+
+static const int        LogExport_BuffSize   = 4096;             // [char] HTTP chunks of the log exports
+static const TickType_t LogExport_YieldTicks = pdMS_TO_TICKS(50); // let the other tasks run every 50ms, not after every packet
+
+class LogSink                                                  // where a log export goes: the HTTP response
+{ public:
+   httpd_req_t *Req;
+   mbedtls_md5_context *MD5;                                   // IGC: digest for the G-record
+   TickType_t Yield;                                           // when we gave way to other tasks the last time
+} ;
+
+static int LogSink_Send(void *Ctx, const char *Data, int Len)  // send a chunk, yield now and then
+{ LogSink *Sink = (LogSink *)Ctx;
+  if(httpd_resp_send_chunk(Sink->Req, Data, Len)!=ESP_OK) return -1; // client gone: stop the export
+  if(Sink->MD5) mbedtls_md5_update_ret(Sink->MD5, (const uint8_t *)Data, Len);
+  TickType_t Now=xTaskGetTickCount();
+  if(Now-Sink->Yield>=LogExport_YieldTicks) { vTaskDelay(1); Sink->Yield=xTaskGetTickCount(); }
+  return Len; }
+
+static OGN_LogExport<OGN_Packet> *LogExport_Open(const char *FileName, uint32_t FileTime, const LogSelect &Sel, uint8_t Format)
+{ OGN_LogExport<OGN_Packet> *Export = new OGN_LogExport<OGN_Packet>; // reader, index and aircraft table: 5KB, thus not on the stack
+  Export->Buff = (char *)malloc(LogExport_BuffSize); Export->Size=LogExport_BuffSize;
+  Export->Format = Format;
+  if(Export->Buff==0 || Export->Open(FileName, FileTime, Sel.From, Sel.To, Sel.Address)<0)
+  { free(Export->Buff); delete Export; return 0; }
+  return Export; }
+
+static void LogExport_Close(OGN_LogExport<OGN_Packet> *Export)
+{ Export->Close(); free(Export->Buff); delete Export; }
+
 // send give log file in the IGC format
-static esp_err_t SendLog_IGC(httpd_req_t *Req, const char *FileName, uint32_t FileTime)
-{ char ContDisp[64];
+static esp_err_t SendLog_IGC(httpd_req_t *Req, const char *FileName, uint32_t FileTime, const LogSelect &Sel)
+{ char ContDisp[80];
   mbedtls_md5_context MD5;
   mbedtls_md5_starts_ret(&MD5);
-  char Line[1000]; int Len=0;
-  Len=Format_String(ContDisp, "attachement; filename=\""); Len+=LogFileName(ContDisp+Len, FileTime, ".IGC"); ContDisp[Len++]='\"'; ContDisp[Len]=0;
+  int Len=0;
+  Len=Format_String(ContDisp, "attachement; filename=\""); Len+=LogFileName(ContDisp+Len, FileTime, Sel, ".IGC"); ContDisp[Len++]='\"'; ContDisp[Len]=0;
   httpd_resp_set_hdr(Req, "Content-Disposition", ContDisp);
   httpd_resp_set_type(Req, "text/plain");
-  FILE *File = fopen(FileName, "rb"); if(File==0) { httpd_resp_send_chunk(Req, 0, 0); return ESP_OK; }
+  OGN_LogExport<OGN_Packet> *Export = LogExport_Open(FileName, FileTime, Sel, OGN_LogExport<OGN_Packet>::FormatIGC);
+  if(Export==0) { httpd_resp_send_chunk(Req, 0, 0); return ESP_OK; }
+  if(Sel.oneAcft()) { Export->TrackAddr=Sel.Address; Export->TrackType=-1; }  // B-records for the selected aircraft
+               else { Export->TrackAddr=Parameters.Address; Export->TrackType=Parameters.AddrType; } // or for our own
+  Export->GeoidSepar=GPS_GeoidSepar;
+  char *Line = Export->Buff;                                   // the header goes through the same buffer
   Len=Format_String(Line, "AXXX ESP32-OGN-TRACKER\nHFFXA020\n");         // IGC file header
   Len+=Format_String(Line+Len, "HFDTE");
   GPS_Time Time; Time.setUnixTime(FileTime);
@@ -1182,31 +1316,9 @@ static esp_err_t SendLog_IGC(httpd_req_t *Req, const char *FileName, uint32_t Fi
   Len+=Format_Hex(Line+Len, (uint16_t)(MAC>>32));                  // ESP32 48-bit ID
   Len+=Format_Hex(Line+Len, (uint32_t) MAC     );
   Line[Len++]='\n';
-  httpd_resp_send_chunk(Req, Line, Len);
-  mbedtls_md5_update_ret(&MD5, (uint8_t *)Line, Len);
-  OGN_LogPacket<OGN_Packet> Packet;
-  Len=0;
-  for( ; ; )
-  { if(fread(&Packet, Packet.Bytes, 1, File)!=1) break;          // read the next packet
-    if(!Packet.isCorrect()) continue;
-    uint32_t Time = Packet.getTime(FileTime);                    // [sec] get exact time from short time in the packet and the file start time
-    Len+=Format_String(Line+Len, "LGNE ");                       // attach APRS as LGNE record
-    char *APRS=Line+Len;
-    Len+=Packet.Packet.WriteAPRS(Line+Len, Time);                // packet in the APRS format
-    Line[Len++]='\n'; Line[Len]=0;
-    bool Own = Packet.Packet.Header.Address==Parameters.Address && Packet.Packet.Header.AddrType==Parameters.AddrType; // 
-    if(Own && !Packet.Packet.Header.NonPos && !Packet.Packet.Header.Encrypted)
-      Len+=APRS2IGC(Line+Len, APRS, GPS_GeoidSepar);             // IGC B-record
-    if(Len>=800)                                                 // when more than 800 bytes then write this part to the socket
-    { httpd_resp_send_chunk(Req, Line, Len);
-      mbedtls_md5_update_ret(&MD5, (uint8_t *)Line, Len);
-      Len=0; vTaskDelay(1); }
-  }
-  fclose(File);
-  if(Len)
-  { httpd_resp_send_chunk(Req, Line, Len);
-    mbedtls_md5_update_ret(&MD5, (uint8_t *)Line, Len);
-    Len=0; }
+  LogSink Sink; Sink.Req=Req; Sink.MD5=&MD5; Sink.Yield=xTaskGetTickCount();
+  if(LogSink_Send(&Sink, Line, Len)<0 || Export->Run(LogSink_Send, &Sink)<0)
+  { LogExport_Close(Export); return ESP_FAIL; }
   uint8_t Digest[16];
   mbedtls_md5_finish_ret(&MD5, Digest);
   Len=0; Line[Len++]='G';                                        // G-record, not signed yet, just MD5
@@ -1214,54 +1326,134 @@ static esp_err_t SendLog_IGC(httpd_req_t *Req, const char *FileName, uint32_t Fi
     Len+=Format_Hex(Line+Len, Digest[Idx]);
   Line[Len++]='\n'; Line[Len]=0;
   httpd_resp_send_chunk(Req, Line, Len);
+  LogExport_Close(Export);
   httpd_resp_send_chunk(Req, 0, 0);
   return ESP_OK; }
 
 // send give log file in the APRS format
-static esp_err_t SendLog_APRS(httpd_req_t *Req, const char *FileName, uint32_t FileTime)
-{ char ContDisp[64];
-  char Line[1000]; int Len=0;
-  Len=Format_String(ContDisp, "attachement; filename=\""); Len+=LogFileName(ContDisp+Len, FileTime, ".aprs"); ContDisp[Len++]='\"'; ContDisp[Len]=0;
+static esp_err_t SendLog_APRS(httpd_req_t *Req, const char *FileName, uint32_t FileTime, const LogSelect &Sel)
+{ char ContDisp[80]; int Len;
+  Len=Format_String(ContDisp, "attachement; filename=\""); Len+=LogFileName(ContDisp+Len, FileTime, Sel, ".aprs"); ContDisp[Len++]='\"'; ContDisp[Len]=0;
   httpd_resp_set_hdr(Req, "Content-Disposition", ContDisp);
   httpd_resp_set_type(Req, "text/plain");
-  FILE *File = fopen(FileName, "rb"); if(File==0) { httpd_resp_send_chunk(Req, 0, 0); return ESP_OK; }
-  OGN_LogPacket<OGN_Packet> Packet;
-  Len=0;
-  for( ; ; )
-  { if(fread(&Packet, Packet.Bytes, 1, File)!=1) break;          // read the next packet
-    if(!Packet.isCorrect()) continue;
-    uint32_t Time = Packet.getTime(FileTime);                    // [sec] get exact time from short time in the packet and the file start time
-    Len+=Packet.Packet.WriteAPRS(Line+Len, Time);                // print the packet in the APRS format
-    Line[Len++]='\n'; Line[Len]=0;
-    if(Len>850) { httpd_resp_send_chunk(Req, Line, Len); Len=0; }
-    vTaskDelay(1); }
-  fclose(File);
-  if(Len) { httpd_resp_send_chunk(Req, Line, Len); Len=0; }
+  OGN_LogExport<OGN_Packet> *Export = LogExport_Open(FileName, FileTime, Sel, OGN_LogExport<OGN_Packet>::FormatAPRS);
+  if(Export==0) { httpd_resp_send_chunk(Req, 0, 0); return ESP_OK; }
+  LogSink Sink; Sink.Req=Req; Sink.MD5=0; Sink.Yield=xTaskGetTickCount();
+  int Records=Export->Run(LogSink_Send, &Sink);
+  LogExport_Close(Export);
+  if(Records<0) return ESP_FAIL;
   httpd_resp_send_chunk(Req, 0, 0);
   return ESP_OK; }
 
 // send given log file in the TLG (binary) format
-static esp_err_t SendLog_TLG(httpd_req_t *Req, const char *FileName, uint32_t FileTime)
-{ char ContDisp[64];
-  char Line[512]; int Len;
+static esp_err_t SendLog_TLG(httpd_req_t *Req, const char *FileName, uint32_t FileTime, const LogSelect &Sel)
+{ char ContDisp[80]; int Len;
   Len=Format_String(ContDisp, "attachement; filename=\"");
   Len+=Parameters.getAprsCall(ContDisp+Len); ContDisp[Len++]='_';
   Len+=Format_Hex(ContDisp+Len, FileTime);
+  if(Sel.oneAcft()) { ContDisp[Len++]='_'; Len+=Format_Hex(ContDisp+Len, Sel.Address, 6); }
   Len+=Format_String(ContDisp+Len, ".TLG"); ContDisp[Len++]='\"'; ContDisp[Len]=0;
   httpd_resp_set_hdr(Req, "Content-Disposition", ContDisp);
   httpd_resp_set_type(Req, "application/octet-stream");
-  FILE *File = fopen(FileName, "rb"); if(File==0) { httpd_resp_send_chunk(Req, 0, 0); return ESP_OK; }
-  for( ; ; )
-  { Len=fread(Line, 1, 512, File); if(Len<=0) break;
+  OGN_LogExport<OGN_Packet> *Export = LogExport_Open(FileName, FileTime, Sel, OGN_LogExport<OGN_Packet>::FormatTLG); // compact logs go out as plain 24-byte records
+  if(Export==0) { httpd_resp_send_chunk(Req, 0, 0); return ESP_OK; }
+  LogSink Sink; Sink.Req=Req; Sink.MD5=0; Sink.Yield=xTaskGetTickCount();
+  int Records=Export->Run(LogSink_Send, &Sink);
+  LogExport_Close(Export);
+  if(Records<0) return ESP_FAIL;
+  httpd_resp_send_chunk(Req, 0, 0);
+  return ESP_OK; }
+
+// page with the index of a log file: aircraft and segments with links to their extracts
+static esp_err_t SendLog_Index(httpd_req_t *Req, const char *FileName, uint32_t FileTime)
+{ char Name[16]; char Line[512]; struct stat Stat;
+  const char *Short = strrchr(FileName, '/'); Short = Short ? Short+1:FileName;
+  strcpy(Name, Short);
+  Html_Start(Req, "OGN-Tracker log index", 3);
+  OGN_LogIndex *Index = new OGN_LogIndex;                       // over 1KB, thus not on the stack
+  uint32_t Size = stat(FileName, &Stat)>=0 ? Stat.st_size:0;
+  if(Index->ReadLog(FileName, FileTime)<0)
+  { delete Index;
+    httpd_resp_sendstr_chunk(Req, "<p>No index for this log file</p>\n");
+    Html_End(Req); return ESP_OK; }
+  int Len=Format_String(Line, "<h2>");
+  Len+=Format_String(Line+Len, Name);
+  Len+=Format_String(Line+Len, "</h2>\n<p>");
+  Len+=Format_UnsDec(Line+Len, Index->Packets);
+  Len+=Format_String(Line+Len, " packets from ");
+  Len+=Format_UnsDec(Line+Len, (uint32_t)Index->Acfts);
+  if(Index->Acfts==Index->MaxAcft) Line[Len++]='+';
+  Len+=Format_String(Line+Len, " aircraft, ");
+  if(Index->Packets)
+  { Len+=Format_DateTime(Line+Len, Index->First);
+    Len+=Format_String(Line+Len, " - ");
+    Len+=Format_HHcMMcSS(Line+Len, Index->Last); }
+  if(Index->End<Size)
+  { Len+=Format_String(Line+Len, ", indexed ");
+    Len+=Format_UnsDec(Line+Len, (Index->End+512)>>10);
+    Len+=Format_String(Line+Len, " of ");
+    Len+=Format_UnsDec(Line+Len, (Size+512)>>10);
+    Len+=Format_String(Line+Len, " KB"); }
+  Len+=Format_String(Line+Len, "</p>\n");
+  httpd_resp_send_chunk(Req, Line, Len);
+
+  httpd_resp_sendstr_chunk(Req, "<table class=\"table table-bordered table-striped\">\n<thead><tr><th>Aircraft</th><th>Packets</th><th></th><th></th><th></th></tr></thead>\n<tbody>\n");
+  for(int Idx=0; Idx<Index->Acfts; Idx++)
+  { LogSelect Sel; Sel.Address=Index->AcftKey[Idx]&0x00FFFFFF;
+    char Query[48]; Sel.Format(Query);
+    Len=Format_String(Line, "<tr><td>");
+    Len+=Format_Hex(Line+Len, (uint8_t)(Index->AcftKey[Idx]>>24));
+    Line[Len++]=':';
+    Len+=Format_Hex(Line+Len, Sel.Address, 6);
+    Len+=Format_String(Line+Len, "</td><td align=\"center\">");
+    Len+=Format_UnsDec(Line+Len, (uint32_t)Index->AcftPackets[Idx]);
+    static const char *Format[3] = { "APRS", "IGC", "TLG" };
+    for(int Fmt=0; Fmt<3; Fmt++)
+    { Len+=Format_String(Line+Len, "</td><td><a href=\"/log.html?Format=");
+      Len+=Format_String(Line+Len, Format[Fmt]);
+      Len+=Format_String(Line+Len, "&File=");
+      Len+=Format_String(Line+Len, Name);
+      Len+=Format_String(Line+Len, Query);
+      Len+=Format_String(Line+Len, "\">");
+      Len+=Format_String(Line+Len, Format[Fmt]);
+      Len+=Format_String(Line+Len, "</a>"); }
+    Len+=Format_String(Line+Len, "</td></tr>\n");
     httpd_resp_send_chunk(Req, Line, Len);
     vTaskDelay(1); }
-  fclose(File);
-  httpd_resp_send_chunk(Req, 0, 0);
+  httpd_resp_sendstr_chunk(Req, "</tbody></table>\n");
+
+  httpd_resp_sendstr_chunk(Req, "<table class=\"table table-bordered table-striped\">\n<thead><tr><th>Time</th><th>Aircraft</th><th>[KB]</th><th></th><th></th></tr></thead>\n<tbody>\n");
+  for(int Idx=0; Idx<Index->Marks; Idx++)
+  { const OGN_LogIndex::Segment &Seg=Index->Mark[Idx];
+    if(Seg.First>Seg.Last) continue;                            // empty segment
+    LogSelect Sel; Sel.From=Seg.First; Sel.To=Seg.Last;
+    char Query[48]; Sel.Format(Query);
+    Len=Format_String(Line, "<tr><td>");
+    Len+=Format_HHcMMcSS(Line+Len, Seg.First);
+    Len+=Format_String(Line+Len, " - ");
+    Len+=Format_HHcMMcSS(Line+Len, Seg.Last);
+    Len+=Format_String(Line+Len, "</td><td align=\"center\">");
+    Len+=Format_UnsDec(Line+Len, (uint32_t)__builtin_popcountll(Seg.AcftMask));
+    Len+=Format_String(Line+Len, "</td><td align=\"center\">");
+    Len+=Format_UnsDec(Line+Len, (Index->segEnd(Idx)-Seg.Offset+512)>>10);
+    Len+=Format_String(Line+Len, "</td><td><a href=\"/log.html?Format=APRS&File=");
+    Len+=Format_String(Line+Len, Name);
+    Len+=Format_String(Line+Len, Query);
+    Len+=Format_String(Line+Len, "\">APRS</a></td><td><a href=\"/log.html?Format=IGC&File=");
+    Len+=Format_String(Line+Len, Name);
+    Len+=Format_String(Line+Len, Query);
+    Len+=Format_String(Line+Len, "\">IGC</a></td></tr>\n");
+    httpd_resp_send_chunk(Req, Line, Len);
+    vTaskDelay(1); }
+  httpd_resp_sendstr_chunk(Req, "</tbody></table>\n");
+  delete Index;
+
+  Html_End(Req);
   return ESP_OK; }
 
 // handle the HTTP request for the log files page
 static esp_err_t log_get_handler(httpd_req_t *Req)
-{ char FullName[32]; char Line[256]; struct stat Stat;
+{ char FullName[32]; char Line[512]; struct stat Stat;
   const char *Path= "/spiffs";
 
   uint16_t URLlen=httpd_req_get_url_query_len(Req);
@@ -1270,14 +1462,16 @@ static esp_err_t log_get_handler(httpd_req_t *Req)
     httpd_req_get_url_query_str(Req, URL, URLlen+1);
     char Name[16]; bool SendFile = httpd_query_key_value(URL, "File", Name, 16)==ESP_OK;
     char Format[8] = { 0 }; httpd_query_key_value(URL, "Format", Format, 8);
+    LogSelect Sel; Sel.Read(URL);                               // possibly a time window and/or one aircraft
     free(URL);
     if(SendFile)
     { AddPath(FullName, Name, Path);
       uint32_t Time=FlashLog_ReadShortFileTime(Name);
       if(Time)
-      { if(strcmp(Format, "APRS")==0) return SendLog_APRS(Req, FullName, Time);
-        if(strcmp(Format, "IGC" )==0) return SendLog_IGC(Req, FullName, Time);
-        return SendLog_TLG(Req, FullName, Time); }
+      { if(strcmp(Format, "APRS" )==0) return SendLog_APRS(Req, FullName, Time, Sel);
+        if(strcmp(Format, "IGC"  )==0) return SendLog_IGC(Req, FullName, Time, Sel);
+        if(strcmp(Format, "Index")==0) return SendLog_Index(Req, FullName, Time);
+        return SendLog_TLG(Req, FullName, Time, Sel); }
     }
   }
   Html_Start(Req, "OGN-Tracker log files", 3);
@@ -1298,7 +1492,8 @@ static esp_err_t log_get_handler(httpd_req_t *Req)
   closedir(Dir);
   std::sort(FileList.begin(), FileList.end());
 
-  httpd_resp_sendstr_chunk(Req, "<table class=\"table table-bordered table-striped\">\n<thead><tr><th>File</th><th></th><th></th><th>[KB]</th><th>Date</th></tr></thead>\n<tbody>\n");
+  OGN_LogIndex *Index = new OGN_LogIndex;                     // the sidecar index gives the packets and aircraft without reading the log
+  httpd_resp_sendstr_chunk(Req, "<table class=\"table table-bordered table-striped\">\n<thead><tr><th>File</th><th></th><th></th><th></th><th>[KB]</th><th>Packets</th><th>Aircraft</th><th>Date</th><th>Last</th></tr></thead>\n<tbody>\n");
   for(size_t Idx=0; Idx<FileList.size(); Idx++)
   { uint32_t Time=FileList[Idx];
     char Name[16];
@@ -1307,6 +1502,7 @@ static esp_err_t log_get_handler(httpd_req_t *Req)
     uint32_t Size=0;
     if(stat(FullName, &Stat)>=0)                              // get file info
       Size = Stat.st_size;
+    bool Indexed = Index->ReadLog(FullName, Time)==0;
     int Len=Format_String(Line, "<tr><td><a href=\"/log.html?File=");
     Len+=Format_String(Line+Len, Name);
     Len+=Format_String(Line+Len, "\">");
@@ -1316,13 +1512,25 @@ static esp_err_t log_get_handler(httpd_req_t *Req)
     Len+=Format_String(Line+Len, "\">APRS</a></td>");
     Len+=Format_String(Line+Len, "<td><a href=\"/log.html?Format=IGC&File=");
     Len+=Format_String(Line+Len, Name);
-    Len+=Format_String(Line+Len, "\">IGC</a></td><td align=\"center\">");
+    Len+=Format_String(Line+Len, "\">IGC</a></td><td>");
+    if(Indexed)
+    { Len+=Format_String(Line+Len, "<a href=\"/log.html?Format=Index&File=");
+      Len+=Format_String(Line+Len, Name);
+      Len+=Format_String(Line+Len, "\">Index</a>"); }
+    Len+=Format_String(Line+Len, "</td><td align=\"center\">");
     Len+=Format_UnsDec(Line+Len, (Size+512)>>10);
+    Len+=Format_String(Line+Len, "</td><td align=\"center\">");
+    if(Indexed) Len+=Format_UnsDec(Line+Len, Index->Packets);
+    Len+=Format_String(Line+Len, "</td><td align=\"center\">");
+    if(Indexed) Len+=Format_UnsDec(Line+Len, (uint32_t)Index->Acfts);
     Len+=Format_String(Line+Len, "</td><td>");
     Len+=Format_DateTime(Line+Len, Time);
+    Len+=Format_String(Line+Len, "</td><td>");
+    if(Indexed && Index->Packets) Len+=Format_HHcMMcSS(Line+Len, Index->Last);
     Len+=Format_String(Line+Len, "</td></tr>\n");
     httpd_resp_send_chunk(Req, Line, Len);
     vTaskDelay(1); }
+  delete Index;
   httpd_resp_sendstr_chunk(Req, "</tbody></table>\n");
 
   Html_End(Req);
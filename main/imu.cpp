@@ -18,6 +18,20 @@ BMX055_MAG MAG;
 BMX055_ACC ACC;
 BMX055_GYR GYR;
 
+static float    GravX, GravY, GravZ;                                  // [g] low passed acceleration: the apparent gravity
+static bool     GravValid=0;
+static float    VertAccSum;                                           // [m/s^2] summed vertical acceleration
+static uint16_t VertAccCount;                                         // and the number of readings summed
+static portMUX_TYPE VertAccMux = portMUX_INITIALIZER_UNLOCKED;
+
+bool IMU_getVertAcc(float &Acc)                                       // called by the SENS task for every baro reading
+{ portENTER_CRITICAL(&VertAccMux);
+  bool Ret = VertAccCount>0;
+  if(Ret) Acc = VertAccSum/VertAccCount;
+  VertAccSum=0; VertAccCount=0;
+  portEXIT_CRITICAL(&VertAccMux);
+  return Ret; }
+
 static uint8_t InitIMU(void)
 { MAG.Bus=BARO_I2C;
   ACC.Bus=BARO_I2C;
@@ -25,17 +39,22 @@ static uint8_t InitIMU(void)
   uint8_t  Err = MAG.CheckID();
   if(!Err) Err = ACC.CheckID();
   if(!Err) Err = GYR.CheckID();
+  if(!Err) Err = ACC.Configure();
   return Err; }
 
-static void ProcIMU(void)
-{
-  int16_t Sec  = 10*(TimeSync_Time()%60);                               // [0.1sec]
-  uint16_t Phase = TimeSync_msTime();                                   // sync to the GPS PPS
-  if(Phase>=500) { Sec+=10; vTaskDelay(1000-Phase); }                   // wait till start of the measuring period
-            else { Sec+= 5; vTaskDelay( 500-Phase); }
-  if(Sec>=600) Sec-=600;                                                // [0.1sec] measurement time
-
-}
+static void ProcIMU(void)                                             // 25Hz: vertical acceleration for the vario
+{ vTaskDelay(40);
+  if(ACC.ReadAcc()) { GravValid=0; return; }
+  float X=ACC.X*(1.0f/BMX055_ACC::OneG), Y=ACC.Y*(1.0f/BMX055_ACC::OneG), Z=ACC.Z*(1.0f/BMX055_ACC::OneG); // [g]
+  if(!GravValid) { GravX=X; GravY=Y; GravZ=Z; GravValid=1; return; }
+  const float Gain=1.0f/64;                                           // about 2.5 sec: follows the bank in turns, not the gusts
+  GravX+=(X-GravX)*Gain; GravY+=(Y-GravY)*Gain; GravZ+=(Z-GravZ)*Gain;
+  float Grav=sqrtf(GravX*GravX+GravY*GravY+GravZ*GravZ);
+  if(Grav<0.5f) return;                                               // free fall or a bad reading: no direction
+  float Vert=(X*GravX+Y*GravY+Z*GravZ)/Grav-Grav;                     // [g] along the apparent gravity, its mean removed
+  portENTER_CRITICAL(&VertAccMux);                                    // no gyro: the slow rest goes into the Kalman bias
+  VertAccSum+=9.80665f*Vert; VertAccCount++;
+  portEXIT_CRITICAL(&VertAccMux); }
 
 #endif
 
@@ -6,6 +6,8 @@
 #endif
 void vTaskIMU(void* pvParameters);
 
+bool IMU_getVertAcc(float &Acc);     // [m/s^2] mean vertical acceleration since the last call, gravity removed
+
 #endif // __IMU_H__
 
 
@@ -16,7 +16,7 @@
 // FindVectors65432bit(10,20,23, 500) => 208, Delta=2579
 
 // every row represents a parity check to be performed on the received codeword
-static const uint32_t LDPC_ParityCheck_n208k160[48][7]
+const uint32_t LDPC_ParityCheck_n208k160[48][7]
 #ifdef __AVR__
 PROGMEM
 #endif
@@ -728,6 +728,20 @@ uint8_t LDPC_Check(const uint8_t *Data) // 20 data bytes followed by 6 parity by
     { uint8_t And = Data[Idx]&Check[Idx]; Count+=Count1s(And); }
     if(Count&1) Errors++; }
   return Errors; }
+// transpose a 32x32 bit matrix, used to convert between the plain and bit-sliced codeword layouts
+void LDPC_Transpose32(uint32_t Out[32], const uint32_t Inp[32])
+{ for(uint8_t Idx=0; Idx<32; Idx++)                     // classic swap-halves algorithm works MSB-first thus reverse the rows
+    Out[Idx]=Inp[31-Idx];
+  uint32_t Mask=0x0000FFFF;
+  for(uint8_t Shift=16; Shift; Shift>>=1, Mask^=Mask<<Shift)
+  { for(uint8_t Idx=0; Idx<32; Idx=(Idx+Shift+1)&(~Shift))
+    { uint32_t Swap = (Out[Idx]^(Out[Idx+Shift]>>Shift))&Mask;
+      Out[Idx]^=Swap; Out[Idx+Shift]^=Swap<<Shift; }
+  }
+  for(uint8_t Idx=0; Idx<16; Idx++)                     // and reverse the rows back
+  { uint32_t Swap=Out[Idx]; Out[Idx]=Out[31-Idx]; Out[31-Idx]=Swap; }
+}
+
 #ifdef WITH_PPM
 uint8_t LDPC_Check_n354k160(const uint32_t *Data, const uint32_t *Parity) // Data and Parity are 32-bit words
 { uint8_t Errors=0;
@@ -19,7 +19,7 @@
 #endif
 
 // extern const uint32_t LDPC_ParityGen_n208k160[48][5];
-// extern const uint32_t LDPC_ParityCheck_n208k160[48][7];
+extern const uint32_t LDPC_ParityCheck_n208k160[48][7];  // packed parity check rows: 7 words = 208 bits per row
 // extern const uint8_t  LDPC_ParityCheckIndex_n208k160[48][24];
 // extern const uint8_t  LDPC_BitWeight_n208k160[208];
 #ifdef WITH_PPM
@@ -92,6 +92,7 @@ class LDPC_Decoder
    int16_t  InpBit[CodeBits]; // a-priori bits
    int16_t  ExtBit[CodeBits]; // extrinsic inf.
    int16_t  OutBit[CodeBits]; // a-posteriori bits
+   uint8_t  Iterations;       // number of ProcessChecks() iterations done by the last Process()
 
    void Input(const uint8_t *Data, const uint8_t *Err)
    { uint8_t Mask=1; uint8_t Idx=0; uint8_t DataByte=0; uint8_t ErrByte=0;
@@ -151,6 +152,16 @@ class LDPC_Decoder
      { OutBit[Bit] = InpBit[Bit] + (ExtBit[Bit]>>1); }
      return Count; }
 
+   uint8_t Process(uint8_t MaxIter=32, uint8_t Stall=0)  // iterate until all checks pass, MaxIter is reached
+   { uint8_t Check=ParityBits; uint8_t MinCheck=Check;    // or (if Stall>0) the number of failed checks does not drop for Stall iterations
+     uint8_t Since=0;
+     for(Iterations=0; Iterations<MaxIter; )
+     { Check=ProcessChecks(); Iterations++;
+       if(Check==0) break;
+       if(Check<MinCheck) { MinCheck=Check; Since=0; continue; }
+       if(Stall && (++Since)>=Stall) break; }
+     return Check; }
+
    int16_t ProcessCheck(uint8_t Row)
    { int16_t MinAmpl=32767; uint8_t MinBit=0; int16_t MinAmpl2=MinAmpl;
      uint32_t Word=0; uint32_t Mask=1;
@@ -175,6 +186,182 @@ class LDPC_Decoder
        Mask<<=1; }
      return CheckFails?-MinAmpl:MinAmpl; }
 
+   const static uint8_t ChaseMaxFlips = 8;               // Chase() tries all 255 combinations of the 8 least reliable bits
+   const static uint8_t ChaseIter     = 2;               // and takes no longer than two iterations of ProcessChecks(): keep them for it
+
+   // Chase-style search after a failed decode: Data holds the Output(); flip combinations of the Flips least reliable bits
+   // (the Manchester-flagged bits enter at zero reliability, thus they are the first unless the checks made them firm)
+   // the syndrome is updated with every flip: one XOR per candidate instead of a LDPC_Check()
+   // return the number of failed checks: zero when a candidate passed, then Data holds the corrected codeword
+   uint8_t Chase(uint8_t Data[CodeBytes], uint8_t Flips=ChaseMaxFlips) const
+   { uint8_t Weak[ChaseMaxFlips]; int16_t WeakAmpl[ChaseMaxFlips]; uint8_t Bits=0;
+     if(Flips>ChaseMaxFlips) Flips=ChaseMaxFlips;
+     for(uint8_t Bit=0; Bit<CodeBits; Bit++)                      // pick the bits with smallest LL, sorted by LL
+     { int16_t Ampl=OutBit[Bit]; if(Ampl<0) Ampl=(-Ampl);
+       uint8_t Idx=Bits;
+       if(Bits<Flips) Bits++;
+       else if(Ampl>=WeakAmpl[Bits-1]) continue;
+       else Idx=Bits-1;
+       for( ; Idx>0 && WeakAmpl[Idx-1]>Ampl; Idx--)
+       { Weak[Idx]=Weak[Idx-1]; WeakAmpl[Idx]=WeakAmpl[Idx-1]; }
+       Weak[Idx]=Bit; WeakAmpl[Idx]=Ampl; }
+     uint8_t WeakIdx[CodeBits];                                   // for every bit: which of the weak ones it is, plus one
+     for(uint8_t Bit=0; Bit<CodeBits; Bit++) WeakIdx[Bit]=0;
+     for(uint8_t Idx=0; Idx<Bits; Idx++) WeakIdx[Weak[Idx]]=Idx+1;
+     uint64_t Syndrome=0; uint64_t FlipMask[ChaseMaxFlips];     // failed checks, the checks each weak bit takes part in
+     for(uint8_t Idx=0; Idx<Bits; Idx++) FlipMask[Idx]=0;
+     uint8_t Check=0;
+     for(uint8_t Row=0; Row<ParityBits; Row++)
+     { const uint8_t *CheckIndex = LDPC_ParityCheckIndex_n208k160[Row];
+       uint8_t CheckWeight = *CheckIndex++; uint8_t Parity=0;
+       for(uint8_t Idx=0; Idx<CheckWeight; Idx++)
+       { uint8_t Bit=CheckIndex[Idx];
+         Parity^=Data[Bit>>3]>>(Bit&7);
+         if(WeakIdx[Bit]) FlipMask[WeakIdx[Bit]-1] |= (uint64_t)1<<Row; }
+       if(Parity&1) { Syndrome|=(uint64_t)1<<Row; Check++; } }
+     if(Check==0) return 0;
+     uint8_t State=0;                                             // which of the weak bits are flipped now
+     for(uint16_t Cand=1; Cand<((uint16_t)1<<Bits); Cand++)       // Gray-code order: a single bit flip per candidate
+     { uint8_t Flip=__builtin_ctz(Cand);
+       Syndrome^=FlipMask[Flip]; State^=1<<Flip;
+       if(Syndrome) continue;
+       for(uint8_t Idx=0; State; Idx++, State>>=1)                // all checks pass: apply the flips to the data
+       { if(State&1) { uint8_t Bit=Weak[Idx]; Data[Bit>>3]^=1<<(Bit&7); } }
+       return 0; }
+     return Check; }
+
+} ;
+
+void LDPC_Transpose32(uint32_t Out[32], const uint32_t Inp[32]); // Out[Bit] bit #Idx = Inp[Idx] bit #Bit
+
+template <class Word=uint32_t>
+ class LDPC_BatchDecoder                                  // bit-sliced hard-decision n208k160 decoder: 32 or 64 codewords processed in parallel
+{ public:
+   const static uint8_t CodeBits   = LDPC_Decoder::CodeBits;
+   const static uint8_t ParityBits = LDPC_Decoder::ParityBits;
+   const static uint8_t CodeWords  = LDPC_Decoder::CodeWords;
+   const static uint8_t Lanes      = 8*sizeof(Word);     // number of codewords in the batch: one per bit of a Word
+   const static uint8_t MaxBitWeight = 6;                // max. number of parity checks a single bit takes part in
+
+  public:
+   Word    Slice[CodeBits];                              // bit #Lane of Slice[Bit] is bit #Bit of the codeword #Lane
+   Word    Syndrome[ParityBits];                         // bit #Lane is set when the parity check fails for the codeword #Lane
+   uint8_t BitWeight[CodeBits];                          // number of parity checks per bit
+   uint8_t BitCheck[CodeBits][MaxBitWeight];             // which parity checks every bit takes part in
+
+  public:
+   LDPC_BatchDecoder()
+   { for(uint8_t Bit=0; Bit<CodeBits; Bit++)
+       BitWeight[Bit]=0;
+     for(uint8_t Row=0; Row<ParityBits; Row++)           // invert the parity check index table: list checks per bit
+     { const uint8_t *CheckIndex = LDPC_ParityCheckIndex_n208k160[Row];
+       uint8_t CheckWeight = *CheckIndex++;
+       for(uint8_t Idx=0; Idx<CheckWeight; Idx++)
+       { uint8_t Bit=CheckIndex[Idx];
+         if(BitWeight[Bit]<MaxBitWeight) BitCheck[Bit][BitWeight[Bit]++]=Row; }
+     }
+     Clear(); }
+
+   void Clear(void)
+   { for(uint8_t Bit=0; Bit<CodeBits; Bit++)
+       Slice[Bit]=0; }
+
+   void Input(uint8_t Lane, const uint32_t Data[CodeWords])  // put a single codeword into the given lane
+   { Word LaneMask = (Word)1<<Lane;
+     for(uint8_t Bit=0; Bit<CodeBits; Bit++)
+     { if((Data[Bit>>5]>>(Bit&31))&1) Slice[Bit]|=LaneMask;
+                                 else Slice[Bit]&=~LaneMask; }
+   }
+
+   void Output(uint8_t Lane, uint32_t Data[CodeWords]) const // get a single codeword out of the given lane
+   { for(uint8_t Idx=0; Idx<CodeWords; Idx++)
+       Data[Idx]=0;
+     for(uint8_t Bit=0; Bit<CodeBits; Bit++)
+     { if((Slice[Bit]>>Lane)&1) Data[Bit>>5] |= (uint32_t)1<<(Bit&31); }
+   }
+
+   void Input(const uint32_t *Data, int Frames)          // put up to Lanes consecutive codewords (CodeWords each) into the batch
+   { if(Frames>Lanes) Frames=Lanes;
+     Clear();
+     uint32_t Inp[32]; uint32_t Out[32];
+     for(uint8_t Block=0; Block*32<Frames; Block++)      // blocks of 32 lanes
+     { for(uint8_t Idx=0; Idx<CodeWords; Idx++)          // 32x32 bit blocks of the codewords
+       { for(uint8_t Lane=0; Lane<32; Lane++)
+         { int Frame=Block*32+Lane;
+           Inp[Lane] = Frame<Frames ? Data[Frame*CodeWords+Idx]:0; }
+         LDPC_Transpose32(Out, Inp);
+         for(uint8_t Bit=0; Bit<32; Bit++)
+         { uint8_t CodeBit=Idx*32+Bit; if(CodeBit>=CodeBits) break;
+           Slice[CodeBit] |= (Word)Out[Bit]<<(Block*32); }
+       }
+     }
+   }
+
+   void Output(uint32_t *Data, int Frames) const         // get up to Lanes consecutive codewords out of the batch
+   { if(Frames>Lanes) Frames=Lanes;
+     uint32_t Inp[32]; uint32_t Out[32];
+     for(uint8_t Block=0; Block*32<Frames; Block++)
+     { for(uint8_t Idx=0; Idx<CodeWords; Idx++)
+       { for(uint8_t Bit=0; Bit<32; Bit++)
+         { uint8_t CodeBit=Idx*32+Bit;
+           Inp[Bit] = CodeBit<CodeBits ? (uint32_t)(Slice[CodeBit]>>(Block*32)):0; }
+         LDPC_Transpose32(Out, Inp);
+         for(uint8_t Lane=0; Lane<32; Lane++)
+         { int Frame=Block*32+Lane; if(Frame>=Frames) break;
+           Data[Frame*CodeWords+Idx]=Out[Lane]; }
+       }
+     }
+   }
+
+   Word Check(uint8_t *Errors=0)                         // run all parity checks on all lanes: return mask of lanes which fail
+   { Word Fail=0;                                        // optionally count failed checks per lane into Errors[Lanes]
+     for(uint8_t Row=0; Row<ParityBits; Row++)
+     { const uint8_t *CheckIndex = LDPC_ParityCheckIndex_n208k160[Row];
+       uint8_t CheckWeight = *CheckIndex++;
+       Word Parity=0;
+       for(uint8_t Idx=0; Idx<CheckWeight; Idx++)
+         Parity ^= Slice[CheckIndex[Idx]];
+       Syndrome[Row]=Parity; Fail|=Parity; }
+     if(Errors)
+     { for(uint8_t Lane=0; Lane<Lanes; Lane++)
+         Errors[Lane]=0;
+       for(uint8_t Row=0; Row<ParityBits; Row++)
+       { Word Parity=Syndrome[Row];
+         for(uint8_t Lane=0; Parity; Lane++, Parity>>=1)
+           Errors[Lane]+=Parity&1; }
+     }
+     return Fail; }
+
+   Word FlipBits(Word Active, uint8_t Margin=0)          // a bit-flip step based on the last Check(): flip bits where at least Weight-Margin
+   { Word Flipped=0;                                     // of their checks fail, return mask of lanes where any bit got flipped
+     for(uint8_t Bit=0; Bit<CodeBits; Bit++)
+     { Word Cnt0=0, Cnt1=0, Cnt2=0;                      // bit-sliced 3-bit counter of failed checks for every lane
+       uint8_t Weight=BitWeight[Bit];
+       for(uint8_t Idx=0; Idx<Weight; Idx++)
+       { Word Fail=Syndrome[BitCheck[Bit][Idx]];
+         Word Carry0=Cnt0&Fail; Cnt0^=Fail;
+         Word Carry1=Cnt1&Carry0; Cnt1^=Carry0;
+         Cnt2|=Carry1; }
+       uint8_t Thres = Weight-Margin;                    // count must be at least this: compare the bit-sliced counter to a constant
+       if(Thres<=Weight/2) Thres=Weight/2+1;             // but never flip without the majority of the checks failing
+       Word Greater=0; Word Equal=~(Word)0;
+       if(Thres&4) Equal&=Cnt2; else { Greater|=Equal&Cnt2; Equal&=~Cnt2; }
+       if(Thres&2) Equal&=Cnt1; else { Greater|=Equal&Cnt1; Equal&=~Cnt1; }
+       if(Thres&1) Equal&=Cnt0; else { Greater|=Equal&Cnt0; Equal&=~Cnt0; }
+       Word Flip = (Greater|Equal)&Active;
+       Slice[Bit]^=Flip; Flipped|=Flip; }
+     return Flipped; }
+
+   Word Process(uint8_t Iter=32)                         // check and iterate all lanes: return mask of lanes still failing
+   { Word Fail=Check();
+     for( ; Fail && Iter; Iter--)
+     { Word Active=Fail;                                 // start with the most reliable flips: bits with all their checks failing
+       for(uint8_t Margin=0; Active && Margin<MaxBitWeight/2; Margin++)
+         Active &= ~FlipBits(Active, Margin);            // relax the threshold only for lanes where nothing got flipped yet
+       if(Active==Fail) break;                           // no lane could flip any bit: give up
+       Fail=Check(); }
+     return Fail; }
+
 } ;
 
 template <class Float=float>
@@ -5,12 +5,17 @@
 #include <utime.h>
 #include <unistd.h>
 
+#include <vector>
+#include <algorithm>
+
 #include "hal.h"                      // Hardware Abstraction Layer
 
 #include "log.h"                      // LOG task: log the own position and other positions heard
 
 #include "gps.h"
 #include "ogn.h"                      // OGN packet structures, encoding/decoding/etc.
+#include "logzip.h"                   // compact log format and the reader for both formats
+#include "logidx.h"                   // sidecar index of the log files
 #include "timesync.h"
 
 // #define DEBUG_PRINT
@@ -41,6 +46,14 @@ static uint32_t FlashLog_FileFlush=0;             // track where the log file ha
 
 FIFO<OGN_LogPacket<OGN_Packet>, 32> FlashLog_FIFO;
 
+#ifdef WITH_LOG_ZIP
+static OGN_LogZip<OGN_Packet> FlashLog_Zip;                   // aircraft table of the current log file
+static uint8_t FlashLog_ZipBlock[OGN_LogZip<OGN_Packet>::MaxBlockBytes]; // one coded batch of packets
+#endif
+#ifdef WITH_LOG_INDEX
+static OGN_LogIndex FlashLog_Index;                           // index of the current log file
+#endif
+
 int FlashLog_ShortFileName(char *FileName, uint32_t Time)     // make the short (without path) file name for given start date
 { int Len = Format_Hex(FileName, Time);                       // Time in %08X format
   strcpy(FileName+Len, FlashLog_Ext); Len+=strlen(FlashLog_Ext); // add extension
@@ -62,6 +75,12 @@ uint32_t FlashLog_ReadShortFileTime(const char *FileName, int Len) // extract th
 uint32_t FlashLog_ReadShortFileTime(const char *FileName)     //
 { return FlashLog_ReadShortFileTime(FileName, strlen(FileName)); }
 
+static int FlashLog_Remove(const char *FileName)              // remove a log file and its index
+{ char IndexName[32];
+  OGN_LogIndex::FileName(IndexName, FileName);
+  unlink(IndexName);
+  return unlink(FileName); }
+
 #ifdef WITH_SD
 int FlashLog_CopyToSD(bool Remove)                            // copy log files to SD card
 { int Files=0;
@@ -98,7 +117,7 @@ int FlashLog_CopyToSD(bool Remove)                            // copy log files
     { DstTime.actime  = Time;                                 // set access and modification times of the dest. file
       DstTime.modtime = Time;
       utime(DstName, &DstTime); }                             // write to the FAT
-    if(Remove) unlink(SrcName);                               // remove source file if requested
+    if(Remove) FlashLog_Remove(SrcName);                      // remove source file if requested
     Files++; }                                                // count copied files
   closedir(Dir);                                              // close directory (for searching of log files)
   return Files; }                                             // return number of copied files
@@ -121,36 +140,42 @@ int FlashLog_FindOldestFile(uint32_t &Oldest, uint32_t After) // find the oldest
   return Files; }                                              // return number of log files
 
 int FlashLog_ListFiles(void)                                  // list log files sorted by time
-{ int Files=0;
-  char Line[64];
+{ char Line[64];
   char FullName[32];
-  // char HHMMSS[8];
   struct stat Stat;
-  uint32_t PrevTime=0;
+  std::vector<uint32_t> FileList;                              // start times of the log files
+  DIR *Dir=opendir(FlashLog_Path); if(!Dir) return -1;         // a single pass through the directory
   for( ; ; )
+  { struct dirent *Ent = readdir(Dir); if(!Ent) break;
+    if(Ent->d_type != DT_REG) continue;
+    uint32_t Time=FlashLog_ReadShortFileTime(Ent->d_name);
+    if(Time) FileList.push_back(Time); }
+  closedir(Dir);
+  std::sort(FileList.begin(), FileList.end());
+  OGN_LogIndex *Index = new OGN_LogIndex;                      // over 1KB, thus not on the stack
+  for(size_t Idx=0; Idx<FileList.size(); Idx++)
   { vTaskDelay(1);                                             // not to overload the priority level
-    uint32_t Time = 0;
-    FlashLog_FindOldestFile(Time, PrevTime);                  // find the next oldest file
-    if(Time==0xFFFFFFFF) break;                                // if none found then stop the list
-    PrevTime=Time;
+    uint32_t Time=FileList[Idx];
     FlashLog_FullFileName(FullName, Time);
     if(stat(FullName, &Stat)<0) continue;                      // get file info
-    int Size = Stat.st_size;                                   // if above minimum size: skip
+    int Size = Stat.st_size;
     strcpy(Line, "$POGNL,");
     uint8_t Len=7;
-    // strcpy(Line+Len, FullName+strlen(FlashLog_Path)); Len+=12; // print the short name only
     const char *Name = strrchr(FullName, '/'); Name++;
     strcpy(Line+Len, Name); Len+=strlen(Name);                 // print the short name only
     Line[Len++]=',';
     Len+=Format_HHMMSS(Line+Len, Time);                        // print the time-of-day
     Line[Len++]=',';
-    Len+=Format_UnsDec(Line+Len, (uint32_t)Size/OGN_LogPacket<OGN_Packet>::Bytes); // number of packets stored
+    uint32_t Packets;                                          // number of packets stored: from the index if complete
+    if(Index->ReadLog(FullName, Time)==0 && Index->End==(uint32_t)Size) Packets=Index->Packets;
+    else Packets=OGN_LogReader<OGN_Packet>::Count(FullName, Size);
+    Len+=Format_UnsDec(Line+Len, Packets);
     Len+=NMEA_AppendCheckCRNL(Line, Len);
     xSemaphoreTake(CONS_Mutex, portMAX_DELAY);
     Format_String(CONS_UART_Write, Line, 0, Len);
-    xSemaphoreGive(CONS_Mutex);
-    Files++; }
-  return Files; }
+    xSemaphoreGive(CONS_Mutex); }
+  delete Index;
+  return FileList.size(); }
 
 /*
 int FlashLog_ListFiles(void)                            //
@@ -187,11 +212,12 @@ int FlashLog_ListFile(const char *FileName, uint32_t FileTime)    // print the c
   // Format_String(CONS_UART_Write, FileName);
   // Format_String(CONS_UART_Write, ")\n");
   // xSemaphoreGive(CONS_Mutex);
-  FILE *File=fopen(FileName, "rb"); if(File==0) return -1;
+  OGN_LogReader<OGN_Packet> *File = new OGN_LogReader<OGN_Packet>; // plain or compact: 3KB, thus not on the stack
+  if(File->Open(FileName)<0) { delete File; return -1; }
   OGN_LogPacket<OGN_Packet> Packet;
   int Packets=0;
   for( ; ; )
-  { if(fread(&Packet, Packet.Bytes, 1, File)!=1) break;          // read the next packet
+  { if(!File->Read(Packet)) break;                               // read the next packet
     if(!Packet.isCorrect()) continue;
     // if(Packet.Packet.Header.NonPos) continue;                    // skip non-position packets (although we could print them too)
     uint32_t Time = Packet.getTime(FileTime);                    // [sec] get exact time from short time in the packet and the file start time
@@ -203,7 +229,7 @@ int FlashLog_ListFile(const char *FileName, uint32_t FileTime)    // print the c
     xSemaphoreGive(CONS_Mutex);
     vTaskDelay(10);                                              // limit the printout to some 100 packet/sec
     Packets++; }                                                 // count printed packets
-  fclose(File);
+  delete File;
   xSemaphoreTake(CONS_Mutex, portMAX_DELAY);                     // 
   Format_String(CONS_UART_Write, FileName);
   Format_String(CONS_UART_Write, " => ");
@@ -240,7 +266,7 @@ static int FlashLog_CleanEmpty(int MinSize=0)                 // delete empty fi
   closedir(Dir);
   for( int File=0; File<DelFiles; File++)
   { FlashLog_FullFileName(FullName, DelFile[File]);
-    unlink(FullName);
+    FlashLog_Remove(FullName);
     vTaskDelay(1); }
   return DelFiles; }
 
@@ -265,7 +291,7 @@ static int FlashLog_Clean(size_t MinFree=0)                          // clean ol
   Format_String(CONS_UART_Write, " files\n");
   xSemaphoreGive(CONS_Mutex);
 #endif
-  if(unlink(FullName)<0) return -1;                                  // remove the oldest file
+  if(FlashLog_Remove(FullName)<0) return -1;                         // remove the oldest file
   return 1; }
 
 static int FlashLog_Clean(size_t MinFree, int Loops)                // repeat the clean procedure several times
@@ -275,14 +301,41 @@ static int FlashLog_Clean(size_t MinFree, int Loops)                // repeat th
     vTaskDelay(1); Count++; }
   return Count; }
 
+static void FlashLog_SaveIndex(void)                               // save the index of the current log file up to here
+{
+#ifdef WITH_LOG_INDEX
+  if(FlashLog_File==0 || FlashLog_Index.Marks==0) return;
+  char IndexName[32];
+  OGN_LogIndex::FileName(IndexName, FlashLog_FileName);
+  FlashLog_Index.End=ftell(FlashLog_File);
+  FlashLog_Index.Write(IndexName);
+#endif
+}
+
+static void FlashLog_Close(void)                                   // close the current log file and save its index
+{ if(FlashLog_File==0) return;
+  FlashLog_SaveIndex();
+  fclose(FlashLog_File); FlashLog_File=0; }
+
 static int FlashLog_Open(uint32_t Time)                            // open a new log file for given start time
-{ if(FlashLog_File) { fclose(FlashLog_File); FlashLog_File=0; }    // if a file open already, close it
+{ FlashLog_Close();                                                // if a file open already, close it
   FlashLog_CleanEmpty(32);                                         // remove empty files or shorter than 32 bytes
   FlashLog_Clean(2*FlashLog_MaxSize, 2);                           // clean files to get free space at least twice the max. file size
   FlashLog_FullFileName(FlashLog_FileName, Time);                  // name of the new log file
   FlashLog_FileTime=Time;                                          // record the time of the log file
   FlashLog_File = fopen(FlashLog_FileName, "wb");                  // open the new file
   FlashLog_FileFlush = 0;
+#ifdef WITH_LOG_INDEX
+  FlashLog_Index.Clear(Time);                                      // new file: empty index
+  { char IndexName[32];                                            // and no index from a former file of the same name
+    OGN_LogIndex::FileName(IndexName, FlashLog_FileName);
+    unlink(IndexName); }
+#endif
+#ifdef WITH_LOG_ZIP
+  FlashLog_Zip.Clear();                                            // new file: no aircraft known yet
+  if(FlashLog_File && fwrite(FlashLog_Zip.Magic(), 1, FlashLog_Zip.MagicLen, FlashLog_File)!=FlashLog_Zip.MagicLen)
+  { fclose(FlashLog_File); FlashLog_File=0; }
+#endif
 #ifdef DEBUG_PRINT
   xSemaphoreTake(CONS_Mutex, portMAX_DELAY);
   Format_String(CONS_UART_Write, "FlashLog_Open() ");
@@ -306,7 +359,7 @@ static int FlashLog_Record(OGN_LogPacket<OGN_Packet> *Packet, int Packets, uint3
     uint32_t WritePos = ftell(FlashLog_File);
     uint32_t WriteSize = Packets*sizeof(OGN_LogPacket<OGN_Packet>);
     if( (TimeSinceStart>=FlashLog_MaxTime) || ((WritePos+WriteSize)>FlashLog_MaxSize) ) // is it too long in time or in size ?
-    { fclose(FlashLog_File); FlashLog_File=0; }                              // decide to close the current log file
+      FlashLog_Close();                                                      // decide to close the current log file
   }
   if(FlashLog_File==0)
   {
@@ -315,8 +368,27 @@ static int FlashLog_Record(OGN_LogPacket<OGN_Packet> *Packet, int Packets, uint3
 #endif
     FlashLog_Open(Time); }                                                   // if file closed, then attempt to open a new one
   if(FlashLog_File==0) return -1;                                            // if file still not open, then give up
+#ifdef WITH_LOG_INDEX
+  if(FlashLog_Index.needMark(Packet->getTime(FlashLog_FileTime)))           // time for a new segment in the index
+  { FlashLog_SaveIndex();                                                    // save the index up to here
+    FlashLog_Index.addMark(ftell(FlashLog_File));
+#ifdef WITH_LOG_ZIP
+    FlashLog_Zip.Clear();                                                    // the segment can be decoded on its own
+#endif
+  }
+  for(int Idx=0; Idx<Packets; Idx++) FlashLog_Index.Add(Packet[Idx]);
+#endif
+#ifdef WITH_LOG_ZIP
+  for(int Idx=0; Idx<Packets; )                                              // code the batch per aircraft against the previous positions
+  { int Len=Packets-Idx; if(Len>FlashLog_Zip.MaxBlockRecords) Len=FlashLog_Zip.MaxBlockRecords;
+    int Bytes=FlashLog_Zip.EncodeBlock(FlashLog_ZipBlock, Packet+Idx, Len);
+    if(fwrite(FlashLog_ZipBlock, 1, Bytes, FlashLog_File)!=Bytes)          // write the block to the log file
+    { fclose(FlashLog_File); FlashLog_File=0; FlashLog_Clean(0, 4); return -1; } // if failure then close the log file and report error
+    Idx+=Len; }
+#else
   if(fwrite(Packet, Packet->Bytes, Packets, FlashLog_File)!=Packets)         // write the packet to the log file
   { fclose(FlashLog_File); FlashLog_File=0; FlashLog_Clean(0, 4); return -1; } // if failure then close the log file and report error
+#endif
 #ifdef WITH_SPIFFS_FAT
   uint32_t WritePos = ftell(FlashLog_File);
   if(WritePos-FlashLog_FileFlush>FlashLog_SaveSize) FlashLog_Reopen();
@@ -395,7 +467,7 @@ void vTaskLOG(void* pvParameters)
       TickType_t Diff = Tick-PrevTick;                              // time since last log action
       if(Diff>=8000) { Copy(); PrevTick=Tick; continue; }           // if more than 8.0sec than copy the packets
     } else                                                          // when not flying
-    { if(FlashLog_File) { fclose(FlashLog_File); FlashLog_File=0; } // if file open then close it
+    { FlashLog_Close();                                             // if file open then close it
       while(FlashLog_FIFO.Full()>=FlashLog_FIFO.Len/2)              // flush the packet queue but keep it half-full
       { FlashLog_FIFO.Read(); vTaskDelay(1); }
     }
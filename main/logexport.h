@@ -0,0 +1,80 @@
+#ifndef __LOGEXPORT_H__
+#define __LOGEXPORT_H__
+
+#include <stdint.h>
+#include <string.h>
+
+#include "ogn.h"
+#include "ognconv.h"
+#include "logidx.h"
+
+// Log file export: the records of a log file (plain or compact, the whole file or an extract through the index)
+// formatted as APRS lines, IGC LGNE lines with B-records, or plain TLG records, into one output buffer.
+// Send() gets the buffer when it is nearly full and at the end: large chunks, no copy in between,
+// and the caller decides when to yield, thus no task delay per record.
+
+template <class OGNx_Packet=OGN1_Packet>
+ class OGN_LogExport
+{ public:
+   static const uint8_t FormatTLG  = 0;                   // plain 24-byte records
+   static const uint8_t FormatAPRS = 1;                   // APRS line per record
+   static const uint8_t FormatIGC  = 2;                   // LGNE line per record, B-record for the selected aircraft
+   static const int     MaxRecordLen = 320;               // [char] longest output of a single record: LGNE+APRS+B-record
+
+   typedef int (*SendFunc)(void *Ctx, const char *Data, int Len); // negative: stop the export (client gone)
+
+   OGN_LogQuery<OGNx_Packet> Query;
+   char    *Buff;                                         // the output buffer, from the caller
+   int      Size;                                         // [char] its size: well above MaxRecordLen
+   uint8_t  Format;
+   uint32_t TrackAddr;                                    // IGC: aircraft for the B-records
+   int8_t   TrackType;                                    // and its address-type, negative: any
+   int      GeoidSepar;                                   // [m] IGC: for the GNSS altitude of the B-records
+   uint32_t Records;                                      // exported so far
+   uint32_t Bytes;                                        // [char] sent so far
+
+  public:
+   OGN_LogExport() { Buff=0; Size=0; Format=FormatAPRS; TrackAddr=0; TrackType=-1; GeoidSepar=0; }
+
+   int Open(const char *FileName, uint32_t FileTime, uint32_t From=0, uint32_t To=0xFFFFFFFF, uint32_t Address=0xFFFFFFFF)
+   { Records=0; Bytes=0;
+     return Query.Open(FileName, FileTime, From, To, Address); }
+
+   void Close(void) { Query.Close(); }
+
+   int FormatRecord(char *Out, OGN_LogPacket<OGNx_Packet> &Rec)  // one record: return the output length
+   { if(Format==FormatTLG) { memcpy(Out, &Rec, Rec.Bytes); return Rec.Bytes; }
+     uint32_t Time = Rec.getTime(Query.FileTime);         // [sec] exact time from the short time and the file start time
+     int Len=0;
+     if(Format==FormatIGC) { memcpy(Out, "LGNE ", 5); Len=5; } // APRS as the LGNE record
+     const char *APRS=Out+Len;
+     Len+=Rec.Packet.WriteAPRS(Out+Len, Time);
+     Out[Len++]='\n'; Out[Len]=0;
+     if(Format==FormatIGC && !Rec.Packet.Header.NonPos && !Rec.Packet.Header.Encrypted
+        && Rec.Packet.Header.Address==TrackAddr && (TrackType<0 || Rec.Packet.Header.AddrType==TrackType))
+       Len+=APRS2IGC(Out+Len, APRS, GeoidSepar);         // IGC B-record
+     return Len; }
+
+   int Run(SendFunc Send, void *Ctx)                      // export all: return the number of records or -1 when Send() failed
+   { int Len=0;
+     OGN_LogPacket<OGNx_Packet> Rec;
+     for( ; ; )
+     { if(Format==FormatTLG)                              // records straight into the buffer: it comes from malloc() thus aligned
+       { if(!Query.Read(*(OGN_LogPacket<OGNx_Packet> *)(Buff+Len))) break;
+         Len+=Rec.Bytes; }
+       else
+       { if(!Query.Read(Rec)) break;
+         Len+=FormatRecord(Buff+Len, Rec); }
+       Records++;
+       if(Len>Size-MaxRecordLen)                          // no room for another record: send the buffer
+       { if(Send(Ctx, Buff, Len)<0) return -1;
+         Bytes+=Len; Len=0; }
+     }
+     if(Len)
+     { if(Send(Ctx, Buff, Len)<0) return -1;
+       Bytes+=Len; }
+     return Records; }
+
+} ;
+
+#endif // __LOGEXPORT_H__
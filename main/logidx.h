@@ -0,0 +1,188 @@
+#ifndef __LOGIDX_H__
+#define __LOGIDX_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "ogn.h"
+#include "logzip.h"
+
+// Sidecar index of a log file: built in RAM while the log is written and saved next to it under the .TLI extension.
+// Holds the time range, the number of records, the aircraft seen and a mark every Period seconds: the file offset
+// of a segment with the time range and the aircraft of this segment. The writer clears the compact aircraft table
+// at every mark, thus a reader can start at any mark and skip the segments which do not have what it looks for.
+//
+// File: 8-byte Magic, the header from FileTime to Marks, then AcftKey[Acfts], AcftPackets[Acfts] and Mark[Marks].
+// The index is saved at every mark and when the log is closed: records after End are not indexed yet.
+
+class OGN_LogIndex
+{ public:
+   static const int      MaxAcft  = 63;                   // aircraft listed: the others share the top bit of the masks
+   static const int      MaxMarks = 32;                   // segments per log file
+   static const uint32_t Period   = 120;                  // [sec] a new segment every two minutes
+   static const int      MagicLen = 8;
+   static const char *Magic(void) { return "OGNTLI1"; }   // file start: 7 chars and the NUL
+
+   class Segment
+   { public:
+      uint32_t Offset;                                    // [byte] where the segment starts in the log file
+      uint32_t First, Last;                               // [sec] time range of its records
+      uint64_t AcftMask;                                  // aircraft in this segment: bit per AcftKey[] entry, top bit: not listed
+   } ;
+
+   uint32_t FileTime;                                     // [sec] start time of the log file, as in its name
+   uint32_t End;                                          // [byte] log file size covered by the index
+   uint32_t First, Last;                                  // [sec] time range of all records
+   uint32_t Packets;                                      // number of records
+   uint8_t  Acfts, Marks;                                 // entries used in AcftKey[] and Mark[]
+   uint16_t Spare;
+   uint32_t AcftKey[MaxAcft];                             // address and address-type: the lower 26 bits of the packet header
+   uint16_t AcftPackets[MaxAcft];                         // number of records per aircraft
+   Segment  Mark[MaxMarks];
+
+  public:
+   void Clear(uint32_t FileTime=0)
+   { this->FileTime=FileTime; End=0; First=0xFFFFFFFF; Last=0; Packets=0; Acfts=0; Marks=0; Spare=0; }
+
+   static int FileName(char *Name, const char *LogName)   // sidecar name: the log file name with .TLI
+   { int Len=strlen(LogName); memcpy(Name, LogName, Len+1);
+     if(Len) Name[Len-1]='I';
+     return Len; }
+
+   static uint32_t getKey(uint32_t HeaderWord) { return HeaderWord&0x03FFFFFF; }
+
+   int findAcft(uint32_t Key) const
+   { for(int Idx=0; Idx<Acfts; Idx++) if(AcftKey[Idx]==Key) return Idx;
+     return -1; }
+
+   uint64_t getMask(uint32_t Address) const               // aircraft mask for the given 24-bit address, whatever the address-type
+   { uint64_t Mask=0;
+     for(int Idx=0; Idx<Acfts; Idx++) if((AcftKey[Idx]&0x00FFFFFF)==Address) Mask|=(uint64_t)1<<Idx;
+     return Mask ? Mask:(uint64_t)1<<MaxAcft; }          // not listed: only in segments with not-listed aircraft
+
+   void Add(uint32_t Key, uint32_t Time)                  // a record written to the log
+   { Packets++;
+     if(Time<First) First=Time;
+     if(Time>Last ) Last=Time;
+     int Idx=findAcft(Key);
+     if(Idx<0 && Acfts<MaxAcft) { Idx=Acfts++; AcftKey[Idx]=Key; AcftPackets[Idx]=0; }
+     if(Idx>=0 && AcftPackets[Idx]<0xFFFF) AcftPackets[Idx]++;
+     if(Marks==0) return;
+     Segment &Seg=Mark[Marks-1];
+     if(Time<Seg.First) Seg.First=Time;
+     if(Time>Seg.Last ) Seg.Last=Time;
+     Seg.AcftMask|=(uint64_t)1<<(Idx>=0 ? Idx:MaxAcft); }
+
+   template <class OGNx_Packet>
+    void Add(const OGN_LogPacket<OGNx_Packet> &Rec)
+   { Add(getKey(Rec.Packet.HeaderWord), Rec.getTime(FileTime)); }
+
+   bool needMark(uint32_t Time) const                     // time for a new segment ?
+   { if(Marks==0) return 1;
+     if(Marks>=MaxMarks) return 0;
+     const Segment &Seg=Mark[Marks-1];
+     return Seg.First!=0xFFFFFFFF && Time>=Seg.First+Period; }
+
+   void addMark(uint32_t Offset)                          // new segment starts at this file position
+   { Segment &Seg=Mark[Marks++];
+     Seg.Offset=Offset; Seg.First=0xFFFFFFFF; Seg.Last=0; Seg.AcftMask=0; }
+
+   uint32_t segEnd(int Idx) const { return Idx+1<Marks ? Mark[Idx+1].Offset:End; }
+
+   int Write(const char *Name) const                      // save the sidecar: 0=success, -1=failure
+   { FILE *File=fopen(Name, "wb"); if(File==0) return -1;
+     bool OK = fwrite(Magic(), 1, MagicLen, File)==MagicLen
+            && fwrite(&FileTime, 1, HeadBytes(), File)==HeadBytes()
+            && fwrite(AcftKey, sizeof(uint32_t), Acfts, File)==(size_t)Acfts
+            && fwrite(AcftPackets, sizeof(uint16_t), Acfts, File)==(size_t)Acfts
+            && fwrite(Mark, sizeof(Segment), Marks, File)==(size_t)Marks;
+     fclose(File); return OK ? 0:-1; }
+
+   int Read(const char *Name, uint32_t FileTime)          // load the sidecar of the log file starting at FileTime: 0=success
+   { Clear(FileTime);
+     FILE *File=fopen(Name, "rb"); if(File==0) return -1;
+     char Head[MagicLen];
+     bool OK = fread(Head, 1, MagicLen, File)==MagicLen && memcmp(Head, Magic(), MagicLen)==0
+            && fread(&this->FileTime, 1, HeadBytes(), File)==HeadBytes()
+            && this->FileTime==FileTime && Acfts<=MaxAcft && Marks<=MaxMarks
+            && fread(AcftKey, sizeof(uint32_t), Acfts, File)==(size_t)Acfts
+            && fread(AcftPackets, sizeof(uint16_t), Acfts, File)==(size_t)Acfts
+            && fread(Mark, sizeof(Segment), Marks, File)==(size_t)Marks;
+     fclose(File);
+     if(!OK) { Clear(FileTime); return -1; }
+     return 0; }
+
+   int ReadLog(const char *LogName, uint32_t FileTime)    // load the sidecar for the given log file name
+   { char Name[40]; if(strlen(LogName)>=sizeof(Name)) return -1;
+     FileName(Name, LogName); return Read(Name, FileTime); }
+
+  private:
+   static size_t HeadBytes(void) { return offsetof(OGN_LogIndex, AcftKey)-offsetof(OGN_LogIndex, FileTime); }
+} ;
+
+// Reads the records of a time window and/or of one aircraft: seeks to the segments which have them, when the log
+// has an index, then the records after the indexed part. Without an index it reads the whole file, filtered.
+// Holds the reader and the index: about 5KB, thus allocate it on the heap.
+
+template <class OGNx_Packet=OGN1_Packet>
+ class OGN_LogQuery
+{ public:
+   OGN_LogReader<OGNx_Packet> Reader;
+   OGN_LogIndex Index;
+   uint32_t FileTime;                                     // [sec] start time of the log file
+   uint32_t From, To;                                     // [sec] time window
+   uint32_t Address;                                      // 24-bit aircraft address or 0xFFFFFFFF for all
+   uint64_t Mask;                                         // aircraft bits of the index to look for
+   bool     Indexed;                                      // a valid index has been found
+   bool     Running;                                      // reading a run of segments
+   bool     Tail;                                         // reading after the indexed part
+   uint8_t  Seg;                                          // next segment to check
+   uint32_t RunEnd;                                       // [byte] where the current run of segments ends, zero: end of file
+
+  public:
+   int Open(const char *FileName, uint32_t FileTime, uint32_t From=0, uint32_t To=0xFFFFFFFF, uint32_t Address=0xFFFFFFFF)
+   { this->FileTime=FileTime; this->From=From; this->To=To; this->Address=Address;
+     int Format=Reader.Open(FileName); if(Format<0) return Format;
+     struct stat Stat;
+     Indexed = Index.ReadLog(FileName, FileTime)==0 && stat(FileName, &Stat)>=0 && Index.End<=(uint32_t)Stat.st_size;
+     Mask = Address==0xFFFFFFFF ? ~(uint64_t)0 : Index.getMask(Address);
+     Seg=0; RunEnd=0;
+     Running=Tail=!Indexed;                               // without index: read from the start to the end
+     return Format; }
+
+   void Close(void) { Reader.Close(); }
+
+   bool Select(int Idx) const                             // does the segment have what we look for ?
+   { const OGN_LogIndex::Segment &Segm=Index.Mark[Idx];
+     return (Segm.AcftMask&Mask) && Segm.Last>=From && Segm.First<=To; }
+
+   bool nextRun(void)                                     // seek to the next run of selected segments or to the tail
+   { while(Seg<Index.Marks && !Select(Seg)) Seg++;
+     if(Seg>=Index.Marks)
+     { if(Tail) return 0;
+       Tail=1; RunEnd=0; return Reader.Seek(Index.End); }
+     uint32_t Start=Index.Mark[Seg].Offset;
+     while(Seg<Index.Marks && Select(Seg)) Seg++;
+     RunEnd=Index.segEnd(Seg-1);
+     return Reader.Seek(Start); }
+
+   bool Match(const OGN_LogPacket<OGNx_Packet> &Rec) const
+   { if(From==0 && To==0xFFFFFFFF && Address==0xFFFFFFFF) return 1; // whole file
+     if(Address!=0xFFFFFFFF && Rec.Packet.Header.Address!=Address) return 0;
+     uint32_t Time=Rec.getTime(FileTime);
+     return Time>=From && Time<=To; }
+
+   bool Read(OGN_LogPacket<OGNx_Packet> &Rec)             // next matching record: 0 when no more
+   { for( ; ; )
+     { if(Running && RunEnd && Reader.atBlockStart() && Reader.Tell()>=RunEnd) Running=0;
+       if(!Running) { if(!nextRun()) return 0; Running=1; }
+       if(!Reader.Read(Rec)) { if(Tail) return 0; Running=0; continue; }
+       if(Rec.isCorrect() && Match(Rec)) return 1; }
+   }
+
+} ;
+
+#endif // __LOGIDX_H__
@@ -0,0 +1,336 @@
+#ifndef __LOGZIP_H__
+#define __LOGZIP_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "ogn.h"
+
+// Compact track log: OGN_LogPacket records coded per aircraft against the previous record of the same aircraft.
+// Time, latitude, longitude and altitude are coded against a linear prediction from the previous step, the other
+// position fields against their previous values, all as Exp-Golomb codes in a bit stream. Other packets (status, info,
+// encrypted) and the first packet of an aircraft go as literals. Lossless: the reader gives back the same 24-byte records.
+//
+// File:  8-byte Magic, then blocks, one per FlashLog_Record() batch: [Bytes:16][Records:8][Check:8] and the bits.
+// The aircraft table carries over the blocks thus a file is read from the start or from a block where the writer cleared
+// the table: these are the marks in the log index (logidx.h). A bad or truncated block ends the file.
+
+class LogZip_BitWriter                                    // LSB-first bit stream into a byte buffer
+{ public:
+   uint8_t *Data;
+   int      Len, MaxLen;        // [bytes]
+   uint64_t Buff;               // bits not yet written to Data
+   int      Bits;               // number of bits in Buff: always below 8 between calls
+
+  public:
+   void Start(uint8_t *Data, int MaxLen) { this->Data=Data; this->MaxLen=MaxLen; Len=0; Buff=0; Bits=0; }
+
+   void Put(uint32_t Value, int Count)                    // Count<=32
+   { if(Count<32) Value&=((uint32_t)1<<Count)-1;
+     Buff|=(uint64_t)Value<<Bits; Bits+=Count;
+     while(Bits>=8) { if(Len<MaxLen) Data[Len]=Buff; Len++; Buff>>=8; Bits-=8; } }
+
+   void PutBit(bool Bit) { Put(Bit, 1); }
+
+   void PutExpGolomb(uint32_t Value, int Order)           // unsigned: leading zeros, then the value+(1<<Order) from its MSB down
+   { uint32_t Code=Value+((uint32_t)1<<Order);
+     int Len=31-__builtin_clz(Code);                      // number of bits below the leading one
+     Put(0, Len-Order); Put((Code<<1)|1, Len+1); }        // zeros, then the stop bit and the low bits (LSB-first)
+
+   void PutSigned(int32_t Value, int Order)               // signed: zig-zag then Exp-Golomb
+   { PutExpGolomb(((uint32_t)Value<<1)^(uint32_t)(Value>>31), Order); }
+
+   int getBits(void) const { return Len*8+Bits; }
+   int Flush(void) { if(Bits) Put(0, 8-Bits); return Len; }  // pad to a byte: return the number of bytes
+   bool Overflow(void) const { return Len>MaxLen; }
+} ;
+
+class LogZip_BitReader
+{ public:
+   const uint8_t *Data;
+   int      Len, Ptr;           // [bytes]
+   uint64_t Buff;
+   int      Bits;
+   bool     Error;              // read past the end or a broken code
+
+  public:
+   void Start(const uint8_t *Data, int Len) { this->Data=Data; this->Len=Len; Ptr=0; Buff=0; Bits=0; Error=0; }
+
+   uint32_t Get(int Count)                                // Count<=32
+   { while(Bits<Count)
+     { if(Ptr>=Len) { Error=1; return 0; }
+       Buff|=(uint64_t)Data[Ptr++]<<Bits; Bits+=8; }
+     uint32_t Value = Count<32 ? (uint32_t)Buff&(((uint32_t)1<<Count)-1) : (uint32_t)Buff;
+     Buff>>=Count; Bits-=Count; return Value; }
+
+   bool GetBit(void) { return Get(1); }
+
+   uint32_t GetExpGolomb(int Order)
+   { int Zeros=0;
+     while(Get(1)==0) { if(Error || Zeros>=32-Order) { Error=1; return 0; } Zeros++; }
+     int Len=Zeros+Order;
+     uint32_t Code=Get(Len);
+     Code|=(uint32_t)1<<Len;                              // the leading one is not in the stream
+     return Code-((uint32_t)1<<Order); }
+
+   int32_t GetSigned(int Order)
+   { uint32_t Code=GetExpGolomb(Order); return (int32_t)(Code>>1)^-(int32_t)(Code&1); }
+} ;
+
+template <class OGNx_Packet=OGN1_Packet>
+ class OGN_LogZip                                         // the per-aircraft model: the same on the writer and the reader side
+{ public:
+   static const int  Slots = 64;                          // aircraft kept: 6-bit slot index in the stream
+   static const int  MaxBlockRecords = 32;                // records per block, as many as FlashLog_FIFO holds
+   static const int  LiteralBits = 7+16+8+32+4*32;        // slot+kind, time, flags, the packet
+   static const int  MaxBlockBytes = 4+(MaxBlockRecords*LiteralBits+7)/8;
+   static const int  MagicLen = 8;
+   static const char *Magic(void) { return "OGNTLZ1"; }   // file start: 7 chars and the NUL
+
+   class Aircraft
+   { public:
+      OGN_LogPacket<OGNx_Packet> Prev;                    // the last record of this aircraft
+      int32_t  dLat, dLon;                                // the last step: for the prediction
+      int16_t  dAlt, dHead;
+      uint8_t  dTime;                                     // [sec] time of the last step, zero: no prediction
+      bool     Valid;
+      uint16_t Used;                                      // for the writer to find the least recently used
+   } ;
+
+   Aircraft Acft[Slots];
+   uint16_t UseCount;
+
+  public:
+   void Clear(void) { for(int Idx=0; Idx<Slots; Idx++) { Acft[Idx].Valid=0; Acft[Idx].Used=0; } UseCount=0; }
+
+   static int32_t SignExt(int32_t Value, int Bits)        // keep the lower Bits and sign-extend
+   { int Shift=32-Bits; return (int32_t)((uint32_t)Value<<Shift)>>Shift; }
+
+   static int32_t SignMag(uint32_t Code, int Bits)        // sign-magnitude VR code => monotone integer
+   { uint32_t Mag=Code&(((uint32_t)1<<(Bits-1))-1);
+     return (Code>>(Bits-1))&1 ? -1-(int32_t)Mag : (int32_t)Mag; }
+
+   static uint32_t MagSign(int32_t Value, int Bits)       // and back
+   { return Value<0 ? ((uint32_t)1<<(Bits-1))|(uint32_t)(-1-Value) : (uint32_t)Value; }
+
+   static bool isPosition(const OGNx_Packet &Packet) { return !Packet.Header.NonPos && !Packet.Header.Encrypted; }
+
+   static uint8_t getFix(const OGNx_Packet &Packet)       // the fix bits which rarely change
+   { return Packet.Position.FixQuality | (Packet.Position.FixMode<<2) | (Packet.Position.BaroMSB<<3) | (Packet.Position.Stealth<<4); }
+
+   static void setFix(OGNx_Packet &Packet, uint8_t Fix)
+   { Packet.Position.FixQuality=Fix; Packet.Position.FixMode=Fix>>2; Packet.Position.BaroMSB=Fix>>3; Packet.Position.Stealth=Fix>>4; }
+
+   static int32_t Predict(int32_t Prev, int32_t Step, uint8_t dTime, uint8_t StepTime)
+   { if(StepTime==0 || dTime==0 || dTime>8) return Prev;  // extrapolate over short gaps only
+     return Prev + Step*dTime/StepTime; }
+
+   void Update(Aircraft &Slot, const OGN_LogPacket<OGNx_Packet> &Rec, bool Delta, uint8_t dTime) // after every record
+   { if(Delta && dTime)
+     { Slot.dLat =SignExt(Rec.Packet.Position.Latitude -Slot.Prev.Packet.Position.Latitude , 24);
+       Slot.dLon =SignExt(Rec.Packet.Position.Longitude-Slot.Prev.Packet.Position.Longitude, 24);
+       Slot.dAlt =SignExt(Rec.Packet.Position.Altitude -Slot.Prev.Packet.Position.Altitude , 14);
+       Slot.dHead=SignExt(Rec.Packet.Position.Heading  -Slot.Prev.Packet.Position.Heading  , 10);
+       Slot.dTime=dTime; }
+     else if(!Delta) Slot.dTime=0;                        // literal: no step known
+     Slot.Prev=Rec; Slot.Valid=1; Slot.Used=++UseCount; }
+
+   int FindSlot(uint32_t Key) const                        // slot of this aircraft or -1
+   { for(int Idx=0; Idx<Slots; Idx++)
+       if(Acft[Idx].Valid && (Acft[Idx].Prev.Packet.HeaderWord&0x03FFFFFF)==Key) return Idx;
+     return -1; }
+
+   int FreeSlot(void) const                                // an empty slot or the least recently used one
+   { int Oldest=0;
+     for(int Idx=0; Idx<Slots; Idx++)
+     { if(!Acft[Idx].Valid) return Idx;
+       if((int16_t)(Acft[Idx].Used-Acft[Oldest].Used)<0) Oldest=Idx; }
+     return Oldest; }
+
+   // writer side
+
+   void EncodeLiteral(LogZip_BitWriter &Out, const OGN_LogPacket<OGNx_Packet> &Rec)
+   { Out.PutBit(0);
+     Out.Put(Rec.Time, 16); Out.Put(Rec.Flags, 8);
+     const uint32_t *Word=(const uint32_t *)&Rec.Packet;
+     for(int Idx=0; Idx<5; Idx++) Out.Put(Word[Idx], 32); }
+
+   void EncodeDelta(LogZip_BitWriter &Out, const Aircraft &Slot, const OGN_LogPacket<OGNx_Packet> &Rec, uint8_t &dTime)
+   { const OGNx_Packet &Prev=Slot.Prev.Packet;
+     const OGNx_Packet &Pkt=Rec.Packet;
+     Out.PutBit(1);
+     uint8_t Head=Pkt.HeaderWord>>24;
+     if(Head==(uint8_t)(Prev.HeaderWord>>24)) Out.PutBit(0); else { Out.PutBit(1); Out.Put(Head, 8); }
+     Out.PutSigned((int16_t)(Rec.Time-Slot.Prev.Time), 0);
+     Out.PutSigned((int8_t)(Rec.Flags-Slot.Prev.Flags), 1);
+     uint8_t Time=Pkt.Position.Time, PrevTime=Prev.Position.Time;
+     if(Time<60 && PrevTime<60)
+     { dTime = Time>=PrevTime ? Time-PrevTime : Time+60-PrevTime;  // [sec] seconds pass the minute
+       Out.PutExpGolomb(dTime, 1); }
+     else { dTime=0; Out.PutExpGolomb(60+Time, 1); }                 // time not valid: the value itself
+     uint8_t Fix=getFix(Pkt);
+     if(Fix==getFix(Prev)) Out.PutBit(0); else { Out.PutBit(1); Out.Put(Fix, 5); }
+     Out.PutSigned(SignExt(Pkt.Position.DOP-Prev.Position.DOP, 6), 0);
+     Out.PutSigned(SignExt(Pkt.Position.Latitude -Predict(Prev.Position.Latitude , Slot.dLat, dTime, Slot.dTime), 24), 3);
+     Out.PutSigned(SignExt(Pkt.Position.Longitude-Predict(Prev.Position.Longitude, Slot.dLon, dTime, Slot.dTime), 24), 3);
+     Out.PutSigned(SignExt(Pkt.Position.Altitude -Predict(Prev.Position.Altitude , Slot.dAlt, dTime, Slot.dTime), 14), 1);
+     Out.PutSigned(SignExt(Pkt.Position.Speed-Prev.Position.Speed, 10), 1);
+     Out.PutSigned(SignExt(SignMag(Pkt.Position.TurnRate, 8)-SignMag(Prev.Position.TurnRate, 8), 8), 1);
+     Out.PutSigned(SignExt(Pkt.Position.Heading  -Predict(Prev.Position.Heading  , Slot.dHead, dTime, Slot.dTime), 10), 2);
+     Out.PutSigned(SignExt(SignMag(Pkt.Position.ClimbRate, 9)-SignMag(Prev.Position.ClimbRate, 9), 9), 1);
+     Out.PutSigned(SignExt(Pkt.Position.BaroAltDiff-Prev.Position.BaroAltDiff, 8), 0);
+     if(Pkt.Position.AcftType==Prev.Position.AcftType) Out.PutBit(0); else { Out.PutBit(1); Out.Put(Pkt.Position.AcftType, 4); }
+   }
+
+   void Encode(LogZip_BitWriter &Out, const OGN_LogPacket<OGNx_Packet> &Rec) // one record into the stream
+   { uint32_t Key=Rec.Packet.HeaderWord&0x03FFFFFF;
+     int Idx=FindSlot(Key);
+     if(Idx<0) Idx=FreeSlot();
+     Aircraft &Slot=Acft[Idx];
+     Out.Put(Idx, 6);
+     if(Slot.Valid && (Slot.Prev.Packet.HeaderWord&0x03FFFFFF)==Key && isPosition(Slot.Prev.Packet) && isPosition(Rec.Packet))
+     { LogZip_BitWriter Start=Out; uint8_t dTime=0;
+       EncodeDelta(Out, Slot, Rec, dTime);
+       if(Out.getBits()-Start.getBits()<=LiteralBits-6)   // delta not longer than the literal: take it
+       { Update(Slot, Rec, 1, dTime); return; }
+       Out=Start; }                                       // else go back and write the literal
+     EncodeLiteral(Out, Rec);
+     Update(Slot, Rec, 0, 0); }
+
+   int EncodeBlock(uint8_t *Block, const OGN_LogPacket<OGNx_Packet> *Rec, int Records) // up to MaxBlockRecords: return the block size
+   { LogZip_BitWriter Out; Out.Start(Block+4, MaxBlockBytes-4);
+     for(int Idx=0; Idx<Records; Idx++) Encode(Out, Rec[Idx]);
+     int Len=Out.Flush();
+     uint8_t Check=0x5A; for(int Idx=0; Idx<Len; Idx++) Check+=Block[4+Idx];
+     Block[0]=Len; Block[1]=Len>>8; Block[2]=Records; Block[3]=Check^0xA5;
+     return 4+Len; }
+
+   // reader side
+
+   int DecodeBlock(const uint8_t *Data, int Size, OGN_LogPacket<OGNx_Packet> *Rec) // a block from memory into Rec[MaxBlockRecords]
+   { if(Size<4) return -1;                                // return the number of records or -1 when broken or truncated
+     int Len=Data[0] | (Data[1]<<8); int Records=Data[2];  // the next block is at Data+4+Len
+     if(4+Len>Size || Records==0 || Records>MaxBlockRecords) return -1;
+     uint8_t Check=0x5A; for(int Idx=0; Idx<Len; Idx++) Check+=Data[4+Idx];
+     if((Check^0xA5)!=Data[3]) return -1;
+     LogZip_BitReader Inp; Inp.Start(Data+4, Len);
+     for(int Idx=0; Idx<Records; Idx++) if(!Decode(Inp, Rec[Idx])) return -1;
+     return Records; }
+
+   bool Decode(LogZip_BitReader &Inp, OGN_LogPacket<OGNx_Packet> &Rec) // one record from the stream
+   { Aircraft &Slot=Acft[Inp.Get(6)];
+     if(Inp.GetBit()==0)                                  // literal
+     { Rec.Time=Inp.Get(16); Rec.Flags=Inp.Get(8);
+       uint32_t *Word=(uint32_t *)&Rec.Packet;
+       for(int Idx=0; Idx<5; Idx++) Word[Idx]=Inp.Get(32);
+       if(Inp.Error) return 0;
+       Rec.setCheck(); Update(Slot, Rec, 0, 0); return 1; }
+     if(!Slot.Valid) return 0;                            // delta against nothing: broken stream
+     const OGNx_Packet &Prev=Slot.Prev.Packet;
+     OGNx_Packet &Pkt=Rec.Packet;
+     Pkt=Prev;
+     if(Inp.GetBit()) Pkt.HeaderWord=(Pkt.HeaderWord&0x00FFFFFF) | (Inp.Get(8)<<24);
+     Rec.Time =Slot.Prev.Time +Inp.GetSigned(0);
+     Rec.Flags=Slot.Prev.Flags+Inp.GetSigned(1);
+     uint32_t Time=Inp.GetExpGolomb(1); uint8_t dTime=0;
+     if(Time<60) { dTime=Time; Time+=Prev.Position.Time; if(Time>=60) Time-=60; }
+            else { Time-=60; }
+     Pkt.Position.Time=Time;
+     if(Inp.GetBit()) setFix(Pkt, Inp.Get(5));
+     Pkt.Position.DOP=Prev.Position.DOP+Inp.GetSigned(0);
+     Pkt.Position.Latitude =Predict(Prev.Position.Latitude , Slot.dLat, dTime, Slot.dTime)+Inp.GetSigned(3);
+     Pkt.Position.Longitude=Predict(Prev.Position.Longitude, Slot.dLon, dTime, Slot.dTime)+Inp.GetSigned(3);
+     Pkt.Position.Altitude =Predict(Prev.Position.Altitude , Slot.dAlt, dTime, Slot.dTime)+Inp.GetSigned(1);
+     Pkt.Position.Speed    =Prev.Position.Speed+Inp.GetSigned(1);
+     Pkt.Position.TurnRate =MagSign(SignExt(SignMag(Prev.Position.TurnRate, 8)+Inp.GetSigned(1), 8), 8);
+     Pkt.Position.Heading  =Predict(Prev.Position.Heading  , Slot.dHead, dTime, Slot.dTime)+Inp.GetSigned(2);
+     Pkt.Position.ClimbRate=MagSign(SignExt(SignMag(Prev.Position.ClimbRate, 9)+Inp.GetSigned(1), 9), 9);
+     Pkt.Position.BaroAltDiff=Prev.Position.BaroAltDiff+Inp.GetSigned(0);
+     if(Inp.GetBit()) Pkt.Position.AcftType=Inp.Get(4);
+     if(Inp.Error) return 0;
+     Rec.setCheck(); Update(Slot, Rec, 1, dTime); return 1; }
+
+} ;
+
+// Streaming reader for the log files: plain 24-byte records or the compact format, told apart by the Magic.
+// Keeps one block and the aircraft table: about 3KB, thus better not on a small task stack.
+// Plain records are read as well a block at a time, into the same buffer.
+
+template <class OGNx_Packet=OGN1_Packet>
+ class OGN_LogReader
+{ public:
+   FILE    *File;
+   bool     Zip;                                          // compact format ?
+   OGN_LogZip<OGNx_Packet> Model;
+   LogZip_BitReader Inp;
+   uint8_t  Block[OGN_LogZip<OGNx_Packet>::MaxBlockBytes];
+   uint8_t  Records;                                      // records left in the current block
+   uint16_t Ptr;                                          // [byte] next plain record in Block[]
+   uint32_t Pos;                                          // [byte] plain: file position after Block[], saves ftell() per record
+
+  public:
+   OGN_LogReader() { File=0; }
+  ~OGN_LogReader() { Close(); }
+
+   int Open(const char *FileName)                         // open and tell the format: 1=compact, 0=plain, -1=cannot open
+   { Close();
+     File=fopen(FileName, "rb"); if(File==0) return -1;
+     char Head[OGN_LogZip<OGNx_Packet>::MagicLen];
+     Zip = fread(Head, 1, sizeof(Head), File)==sizeof(Head) && memcmp(Head, Model.Magic(), sizeof(Head))==0;
+     if(!Zip) rewind(File);
+     Model.Clear(); Records=0; Pos=0;
+     return Zip; }
+
+   void Close(void) { if(File) { fclose(File); File=0; } }
+
+   bool Seek(uint32_t Offset)                             // jump to a record or, in a compact file, to a block which starts with a cleared table
+   { if(File==0) return 0;
+     Model.Clear(); Records=0; Pos=Offset;
+     return fseek(File, Offset, SEEK_SET)==0; }
+
+   uint32_t Tell(void) const                              // [byte] the file position: meaningful between blocks
+   { if(File==0) return 0;
+     if(Zip) return ftell(File);
+     return Pos-Records*OGN_LogPacket<OGNx_Packet>::Bytes; } // plain: records not yet taken from Block[]
+   bool atBlockStart(void) const { return !Zip || Records==0; } // a plain file is cut at any record
+
+   bool ReadBlock(void)                                   // read and check the next block: 0 at the end of file or a broken block
+   { uint8_t Head[4];
+     if(fread(Head, 1, 4, File)!=4) return 0;
+     int Len=Head[0] | (Head[1]<<8);
+     if(Len>(int)sizeof(Block) || Head[2]==0 || Head[2]>OGN_LogZip<OGNx_Packet>::MaxBlockRecords) return 0;
+     if(fread(Block, 1, Len, File)!=(size_t)Len) return 0;
+     uint8_t Check=0x5A; for(int Idx=0; Idx<Len; Idx++) Check+=Block[Idx];
+     if((Check^0xA5)!=Head[3]) return 0;
+     Inp.Start(Block, Len); Records=Head[2]; return 1; }
+
+   bool Read(OGN_LogPacket<OGNx_Packet> &Rec)             // next record: 0 when no more
+   { if(File==0) return 0;
+     if(!Zip)
+     { if(Records==0)
+       { Records=fread(Block, Rec.Bytes, sizeof(Block)/Rec.Bytes, File); Ptr=0;
+         if(Records==0) return 0;
+         Pos+=Records*Rec.Bytes; }
+       memcpy(&Rec, Block+Ptr, Rec.Bytes); Ptr+=Rec.Bytes; Records--; return 1; }
+     if(Records==0 && !ReadBlock()) { Close(); return 0; }
+     Records--;
+     if(!Model.Decode(Inp, Rec)) { Close(); return 0; }
+     return 1; }
+
+   static int Count(const char *FileName, int FileSize)   // number of records without decoding them
+   { FILE *File=fopen(FileName, "rb"); if(File==0) return -1;
+     char Head[OGN_LogZip<OGNx_Packet>::MagicLen];
+     if(fread(Head, 1, sizeof(Head), File)!=sizeof(Head) || memcmp(Head, OGN_LogZip<OGNx_Packet>::Magic(), sizeof(Head))!=0)
+     { fclose(File); return FileSize/OGN_LogPacket<OGNx_Packet>::Bytes; }
+     int Count=0;
+     for( ; ; )
+     { uint8_t Block[4]; if(fread(Block, 1, 4, File)!=4) break;
+       int Len=Block[0] | (Block[1]<<8);
+       if(fseek(File, Len, SEEK_CUR)!=0) break;
+       Count+=Block[2]; }
+     fclose(File); return Count; }
+
+} ;
+
+#endif // __LOGZIP_H__
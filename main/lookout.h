@@ -76,6 +76,8 @@ class LookOut_Target           // describes a flying aircrafts
 
    // uint16_t HorRelSpeed(void) const { }
 
+   uint32_t EvictRank(void) const { return Rank^0xFF000000; } // highest goes first when slots run out: warned targets last
+
    uint32_t DistSqr(void) const { return (int32_t)dX*dX + (int32_t)dY*dY + (int32_t)dZ*dZ; } // [0.25m^2]  Distance-square to the Target
    uint32_t VelSqr (void) const { return (int32_t)Vx*Vx + (int32_t)Vy*Vy + (int32_t)Vz*Vz; } // [0.5m/s^2] Relative velocity square of the Target
 
@@ -144,7 +146,7 @@ class LookOut_Target           // describes a flying aircrafts
 
 // =======================================================================================================
 
-template <const uint8_t MaxTgts=32>
+template <const uint8_t MaxTgts=32>         // up to 255 targets: slot index 0xFF marks the end of the index lists
  class LookOut
 { public:
    union
@@ -176,8 +178,6 @@ template <const uint8_t MaxTgts=32>
    } ;
 
    uint8_t     WarnLevel;                 // highest warning level of all the targets
-   uint8_t     WeakestIdx;                // index for the weakest target (or a not allocated target)
-   uint32_t    WeakestRank;               // rank of the weakest target
 
    uint8_t AcftType;
 
@@ -188,6 +188,24 @@ template <const uint8_t MaxTgts=32>
    const static uint8_t MaxTargets  = MaxTgts; // maximum number of targets
    LookOut_Target     Target[MaxTargets]; // array of Targets
 
+   const static uint8_t  NoIdx     = 0xFF;                      // end-of-list marker for the slot indexes below
+   const static uint16_t HashSize  = MaxTgts>64 ? 256:64;       // number of ID hash buckets: must be a power of 2
+   const static uint8_t  CellShift = 12;                        // [0.5m] grid cell is 2048m wide
+   const static uint8_t  GridSize  = 16;                        // 16x16 cells cover the whole int16_t X/Y range
+   const static int16_t  MaxTgtSpeed = 2*150;                   // [0.5m/s] assumed max. target speed to limit the search in the grid
+   const static uint8_t  MaxEvict  =  4;                        // number of weakest targets kept as candidates to be replaced
+
+   uint8_t HashHead[HashSize];            // first slot in every ID hash bucket
+   uint8_t HashNext[MaxTargets];          // next slot in the same ID hash bucket
+   uint8_t CellHead[GridSize*GridSize];   // first slot in every grid cell
+   uint8_t CellNext[MaxTargets];          // next slot in the same grid cell
+   uint8_t CellIdx[MaxTargets];           // which cell the slot is linked into
+   uint8_t FreeSlot[MaxTargets];          // stack of not allocated slots
+   uint8_t FreeSlots;                     // number of not allocated slots
+   uint8_t EvictIdx[MaxEvict];            // weakest targets seen by recent calculations: highest rank first
+   uint8_t EvictCount;
+   uint8_t SweepRow;                      // grid row recalculated in full on this ProcessOwn() call, even when out of reach
+
    const static int32_t   DistRange = 10000; // [m] drop immediately anything beyond this distance
    const static int16_t MinHorizSepar = 100; // [m] minimum horizontal separation
    const static int16_t MinVertSepar  =  50; // [m] minimum vertical separation
@@ -201,12 +219,106 @@ template <const uint8_t MaxTgts=32>
 
    void Clear(void)
    { Flags=0; ID=0; Pos.Clear(); Pred=0;
-     Targets=0; WeakestIdx=0; WeakestRank=0xFFFFFFFF;
+     Targets=0;
      WorstTgtIdx=0; WorstTgtTime=0xFF;
      for(uint8_t Idx=0; Idx<MaxTargets; Idx++)
      { Target[Idx].Clear(); }
+     for(uint16_t Idx=0; Idx<HashSize; Idx++)
+       HashHead[Idx]=NoIdx;
+     for(uint16_t Idx=0; Idx<GridSize*GridSize; Idx++)
+       CellHead[Idx]=NoIdx;
+     for(uint8_t Idx=0; Idx<MaxTargets; Idx++)        // all slots are free, lowest index on top of the stack
+       FreeSlot[Idx]=MaxTargets-1-Idx;
+     FreeSlots=MaxTargets;
+     EvictCount=0; SweepRow=0; }
+
+   // -----------------------------------------------------------------------------------------------------
+   // slot management: ID hash, X/Y grid, free slots and the weakest targets
+
+   static uint8_t IDhash(uint32_t ID) { return (ID*2654435761u)>>24; }           // multiplicative hash: top bits are best mixed
+   static uint8_t getCell(int16_t Coord) { return (uint16_t)(Coord+0x8000)>>CellShift; } // [0.5m] => [cell]
+
+   int16_t findSlot(uint32_t ID) const                    // find the slot (allocated and linked) with the given ID
+   { for(uint8_t Idx=HashHead[IDhash(ID)&(HashSize-1)]; Idx!=NoIdx; Idx=HashNext[Idx])
+     { if(Target[Idx].ID==ID) return Idx; }
+     return -1; }
+
+   void LinkCell(uint8_t Idx)                             // put the slot into the grid cell for its position
+   { uint8_t Cell = getCell(Target[Idx].Pos.X)*GridSize + getCell(Target[Idx].Pos.Y);
+     CellIdx[Idx]=Cell; CellNext[Idx]=CellHead[Cell]; CellHead[Cell]=Idx; }
+
+   void UnlinkCell(uint8_t Idx)
+   { uint8_t *Link=CellHead+CellIdx[Idx];
+     for( ; *Link!=NoIdx; Link=CellNext+(*Link))
+     { if(*Link==Idx) { *Link=CellNext[Idx]; break; } }
+   }
+
+   void MoveCell(uint8_t Idx)                             // move the slot to another cell if the position has moved out
+   { uint8_t Cell = getCell(Target[Idx].Pos.X)*GridSize + getCell(Target[Idx].Pos.Y);
+     if(Cell==CellIdx[Idx]) return;
+     UnlinkCell(Idx); LinkCell(Idx); }
+
+   void Link(uint8_t Idx)                                 // register a newly allocated slot in the ID hash and the grid
+   { uint8_t Bucket = IDhash(Target[Idx].ID)&(HashSize-1);
+     HashNext[Idx]=HashHead[Bucket]; HashHead[Bucket]=Idx;
+     LinkCell(Idx);
+     Target[Idx].Alloc=1; Targets++; }
+
+   void Free(uint8_t Idx)                                 // unregister and deallocate a slot
+   { if(!Target[Idx].Alloc) return;
+     uint8_t *Link=HashHead+(IDhash(Target[Idx].ID)&(HashSize-1));
+     for( ; *Link!=NoIdx; Link=HashNext+(*Link))
+     { if(*Link==Idx) { *Link=HashNext[Idx]; break; } }
+     UnlinkCell(Idx);
+     DropEvict(Idx);
+     Target[Idx].Alloc=0; Targets--;
+     FreeSlot[FreeSlots++]=Idx; }
+
+   void DropEvict(uint8_t Idx)                            // remove the slot from the weakest candidates
+   { uint8_t Src=0, Dst=0;
+     for( ; Src<EvictCount; Src++)
+     { if(EvictIdx[Src]!=Idx) EvictIdx[Dst++]=EvictIdx[Src]; }
+     EvictCount=Dst; }
+
+   void OfferEvict(uint8_t Idx)                           // after the rank of a slot is (re)calculated: keep the MaxEvict weakest
+   { DropEvict(Idx); if(!Target[Idx].Alloc) return;
+     uint32_t Rank=Target[Idx].EvictRank();
+     uint8_t Pos=EvictCount;
+     for( ; Pos>0; Pos--)
+     { if(Target[EvictIdx[Pos-1]].EvictRank()>=Rank) break; }
+     if(Pos>=MaxEvict) return;
+     if(EvictCount<MaxEvict) EvictCount++;
+     for(uint8_t Src=EvictCount-1; Src>Pos; Src--)
+       EvictIdx[Src]=EvictIdx[Src-1];
+     EvictIdx[Pos]=Idx; }
+
+   uint8_t getSlot(void)                                  // get a slot for a new position: a free one or the weakest target
+   { if(FreeSlots==0)
+     { uint8_t Weakest=0;
+       if(EvictCount) Weakest=EvictIdx[0];
+       else                                               // no candidates known: full scan (rare)
+       { for(uint8_t Idx=1; Idx<MaxTargets; Idx++)
+           if(Target[Idx].EvictRank()>=Target[Weakest].EvictRank()) Weakest=Idx; }
+       Free(Weakest); }
+     return FreeSlot[--FreeSlots]; }
+
+   void ReturnSlot(uint8_t Idx)                           // return a slot from getSlot() which did not get allocated
+   { FreeSlot[FreeSlots++]=Idx; }
+
+   uint8_t getCellReach(void) const                       // [cells] how far from own cell a target can be a threat
+   { int32_t Reach = ((int32_t)(MaxTgtSpeed+Pos.Speed)*(2*(WarnTime+4)+2*12))>>1; // [0.5m] like calcHorizMargin() with up to 12sec time diff.
+     Reach += 2*MinHorizSepar + 2*255;                    // [0.5m] separation and max. position errors
+     return (Reach>>CellShift)+1; }
+
+   void RebuildCells(void)                                // after the reference point moved all X/Y change
+   { for(uint16_t Idx=0; Idx<GridSize*GridSize; Idx++)
+       CellHead[Idx]=NoIdx;
+     for(uint8_t Idx=0; Idx<MaxTargets; Idx++)
+     { if(Target[Idx].Alloc) LinkCell(Idx); }
    }
 
+   // -----------------------------------------------------------------------------------------------------
+
    int16_t getRelBearing(const LookOut_Target *Tgt) const  // [360/0x10000 deg] relative bearing to the target
    { return Tgt->getBearing()-Pos.Heading; }
 
@@ -393,22 +505,32 @@ template <const uint8_t MaxTgts=32>
        AdjustRefLatLon(OwnPos); }                                                         // adjust horizontal Lat/Lon position if needed.
 
      WarnLevel=0;
-     Targets=0;
      WorstTgtIdx=0;                                                                   // get ready to search the most dangerous aircraft
      WorstTgtTime=0xFF;
-     for(uint8_t Idx=0; Idx<MaxTargets; Idx++)                                        // go over targets
-     { LookOut_Target *Tgt = Target+Idx;
-       if(!Tgt->Alloc) continue;                                                      // skip empty slots
-       if(Tgt->DistMargin==0)                                                         // those with no safety margin
-       { while(Tgt->Pos.T<=(Pos.T-4))                                                 // bring closer in time to my (new) position
-         { Tgt->Pos.StepFwd2secs(); Tgt->Pred+=4; }
-       }
-       uint8_t Warn=calcTarget(Tgt);                                                  // (re)calculate the target
-       if(Warn)
-       { if(Warn>WarnLevel) WarnLevel=Warn;                                           // register highest warning level
-         if(Tgt->TimeMargin<WorstTgtTime) { WorstTgtTime=Tgt->TimeMargin; WorstTgtIdx=Idx; } // and shortest time margin
+     uint8_t OwnRow=getCell(Pos.X), OwnCol=getCell(Pos.Y);                            // own cell in the grid
+     uint8_t Reach=getCellReach();                                                    // targets further away cannot become a threat soon
+     SweepRow++; if(SweepRow>=GridSize) SweepRow=0;                                   // but recalc. one full row every time to refresh their rank
+     for(uint8_t Row=0; Row<GridSize; Row++)
+     { bool Sweep = Row==SweepRow;
+       if(!Sweep && abs(Row-OwnRow)>Reach) continue;
+       for(uint8_t Col=0; Col<GridSize; Col++)
+       { if(!Sweep && abs(Col-OwnCol)>Reach) continue;
+         for(uint8_t Idx=CellHead[Row*GridSize+Col]; Idx!=NoIdx; )                  // go over targets in this cell
+         { LookOut_Target *Tgt = Target+Idx;
+           uint8_t Next=CellNext[Idx];                                                // the target may move to another cell
+           if(Tgt->DistMargin==0)                                                     // those with no safety margin
+           { while(Tgt->Pos.T<=(Pos.T-4))                                             // bring closer in time to my (new) position
+             { Tgt->Pos.StepFwd2secs(); Tgt->Pred+=4; }
+             MoveCell(Idx); }
+           uint8_t Warn=calcTarget(Tgt);                                              // (re)calculate the target
+           OfferEvict(Idx);
+           if(Warn)
+           { if(Warn>WarnLevel) WarnLevel=Warn;                                       // register highest warning level
+             if(Tgt->TimeMargin<WorstTgtTime) { WorstTgtTime=Tgt->TimeMargin; WorstTgtIdx=Idx; } // and shortest time margin
+           }
+           Idx=Next; }
        }
-       Targets++; }
+     }
      // printf("ProcessOwn() ... exit\n");
      // if(Targets==0) return 0;                                                       // return NULL if no targets are tracked
      LookOut_Target *Tgt = Target+WorstTgtIdx;
@@ -416,10 +538,10 @@ template <const uint8_t MaxTgts=32>
      return Tgt; }                                                                     // return the pointer to the most dangerous target
 
    const LookOut_Target *ProcessTarget(ADSL_Packet &Packet, uint32_t RxTime)           // process a position of another aircraft in ADS-L format
-   { // printf("ProcessTarget(%d) ... entry\n", WeakestIdx);
-     LookOut_Target *New = Target+WeakestIdx;                                          // get a free or lowest rank slot
+   { uint8_t NewIdx = getSlot();                                                       // get a free or lowest rank slot
+     LookOut_Target *New = Target+NewIdx;
      New->Clear();                                                                     // put the new position there
-     if(New->Pos.Read(Packet, RxTime, RefTime, RefLat, RefLon, RefAlt, LatCos, GeoidSepar, DistRange)<0) return 0; // calculate the position against the reference position
+     if(New->Pos.Read(Packet, RxTime, RefTime, RefLat, RefLon, RefAlt, LatCos, GeoidSepar, DistRange)<0) { ReturnSlot(NewIdx); return 0; } // calculate the position against the reference position
      if(!New->Pos.hasStdAlt)                                                           // if no baro altitude
      { if(Pos.hasStdAlt) { New->Pos.dStdAlt=Pos.dStdAlt; New->Pos.hasStdAlt=1; } }     // take it from own
      New->Address  = Packet.getAddress();
@@ -429,10 +551,10 @@ template <const uint8_t MaxTgts=32>
 
    template <class OGNx_Packet>
     const LookOut_Target *ProcessTarget(OGNx_Packet &Packet, uint32_t RxTime, const char *Call=0)  // process a position of another aircraft in OGN format
-   { // printf("ProcessTarget(%d) ... entry\n", WeakestIdx);
-     LookOut_Target *New = Target+WeakestIdx;                                          // get a free or lowest rank slot
+   { uint8_t NewIdx = getSlot();                                                       // get a free or lowest rank slot
+     LookOut_Target *New = Target+NewIdx;
      New->Clear();                                                                     // put the new position there
-     if(New->Pos.Read(Packet, RxTime, RefTime, RefLat, RefLon, RefAlt, LatCos, DistRange)<0) return 0; // calculate the position against the reference position
+     if(New->Pos.Read(Packet, RxTime, RefTime, RefLat, RefLon, RefAlt, LatCos, DistRange)<0) { ReturnSlot(NewIdx); return 0; } // calculate the position against the reference position
      if(!New->Pos.hasStdAlt)                                                           // if no baro altitude
      { if(Pos.hasStdAlt) { New->Pos.dStdAlt=Pos.dStdAlt; New->Pos.hasStdAlt=1;} }      // take it from own
      New->Address  = Packet.Header.Address;
@@ -442,20 +564,17 @@ template <const uint8_t MaxTgts=32>
          else   New->Call[0]=0;
      return ProcessTarget(New); }
 
-   const LookOut_Target *ProcessTarget(LookOut_Target *New)
+   const LookOut_Target *ProcessTarget(LookOut_Target *New)                            // New is a slot from getSlot(), not yet allocated
    {  // printf("ProcessTarget() ... %08X\n", ID);
-     uint8_t OldIdx;
-     LookOut_Target *Old = 0;                                                                   // possible previous index to the same ID
-     for(OldIdx=0; OldIdx<MaxTargets; OldIdx++)                                        // scan targets already on the list
-     { if(Target[OldIdx].Alloc==0) continue;                                           // skip not allocated
-       if(OldIdx==WeakestIdx) continue;                                                // skip the new position
-       if(Target[OldIdx].ID==New->ID) break; }                                         // to find previous position for the target
-     if(OldIdx<MaxTargets)                                                             // if found
+     uint8_t NewIdx = New-Target;
+     LookOut_Target *Old = 0;                                                          // possible previous index to the same ID
+     int16_t OldIdx = findSlot(New->ID);                                               // find previous position for the target
+     if(OldIdx>=0)                                                                     // if found
      { Old = Target+OldIdx;
-       if((Old->Pos.T-Old->Pred)>Target[WeakestIdx].Pos.T)                             // if position is not really newer
-         return Old;                                                                   // then stop processing this (not new) position
-       Old->Alloc=0; }                                                                 // mark old position as "not allocated"
-     New->Alloc=1;                                                                     // mark this position as allocated
+       if((Old->Pos.T-Old->Pred)>New->Pos.T)                                           // if position is not really newer
+       { ReturnSlot(NewIdx); return Old; }                                             // then stop processing this (not new) position
+       Free(OldIdx); }                                                                 // mark old position as "not allocated", the data stays
+     Link(NewIdx);                                                                     // mark this position as allocated
 
      if(Old && Old->Call[0] && New->Call[0]==0) { strncpy(New->Call, Old->Call, 10); New->Call[10]=0; } // copy the call
 
@@ -487,17 +606,7 @@ template <const uint8_t MaxTgts=32>
      uint8_t Warn=calcTarget(New);                                                     // calculate the safety margin for the target
      if(Warn>WarnLevel) WarnLevel=Warn;                                                // record higest warnign level
      // printf("ProcessTarget() ... calc()\n");
-
-     uint8_t MaxIdx=WeakestIdx; uint32_t Max=New->Rank;                                // look for the lowest rank position on the list
-     for( uint8_t Idx=MaxIdx; ; )                                                      // go over targets
-     { Idx++; if(Idx>=MaxTargets) Idx=0;
-       if(Idx==WeakestIdx) break;                                                      // end the loop when back at New
-       LookOut_Target &Tgt = Target[Idx];
-       if(!Tgt.Alloc) { MaxIdx=Idx; break; }                                           // if unallocated target found: stop the search
-       // if(Tgt.Rank==0xFFFFFFFF) { MaxIdx=Idx; break; }                                 // if abs. weakest target found: stop the search
-       if(Tgt.Rank>=Max) { Max=Tgt.Rank; MaxIdx=Idx; }                                 // if weaker rank found: note it
-     }
-     WeakestIdx=MaxIdx;                                                                // tqke the weakest slot for the nest time
+     OfferEvict(NewIdx);                                                               // candidate for the slot to be taken next time
 
      return New; }
 
@@ -621,7 +730,7 @@ template <const uint8_t MaxTgts=32>
      for(uint8_t Idx=0; Idx<MaxTargets; Idx++)                         // go over the targets
      { LookOut_Target &Tgt = Target[Idx]; if(!Tgt.Alloc) continue;     // skip unallocated
        Tgt.Pos.T-=2*TimeDelta;                                         // shift the relative time
-       if((Tgt.Pos.T-Tgt.Pred)<(-2*30)) Tgt.Alloc=0;                   // if older than 30sec then drop the target
+       if((Tgt.Pos.T-Tgt.Pred)<(-2*30)) Free(Idx);                     // if older than 30sec then drop the target
      }
    }
 
@@ -647,6 +756,7 @@ template <const uint8_t MaxTgts=32>
      Pos.Y -= LonDist;
      for(uint8_t Idx=0; Idx<MaxTargets; Idx++)                     // shift the relative position of every target
      { if(Target[Idx].Alloc) { Target[Idx].Pos.X-=LatDist; Target[Idx].Pos.Y-=LonDist; } }
+     RebuildCells();                                               // all targets moved in the grid
      LatCos = Icos(GPS_Position::calcLatAngle16(RefLat));
    }
 
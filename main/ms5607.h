@@ -70,21 +70,29 @@ class MS5607
       Calib[Idx]=SwapBytes(Calib[Idx]); }
     return 0; }
 
+  uint8_t TrigRawPress(void)                     // start the pressure conversion: 9ms
+  { Error=I2C_Write(Bus, ADDR, CMD_ADC_CONV+CMD_ADC_D1+CMD_ADC_4096, 0); return Error; }
+
+  uint8_t TrigRawTemp(void)                      // start the temperature conversion: 9ms
+  { Error=I2C_Write(Bus, ADDR, CMD_ADC_CONV+CMD_ADC_D2+CMD_ADC_4096, 0); return Error; }
+
+  uint8_t ReadADC(int32_t &Raw)                  // read the result of the last conversion
+  { Raw=0;
+    Error=I2C_Read(Bus, ADDR, CMD_ADC_READ, (uint8_t *)(&Raw), 3); if(Error) return Error;
+    Raw = ((Raw<<16)&0xFF0000) | (Raw&0x00FF00) | ((Raw>>16)&0x0000FF); // swap bytes
+    return 0; }
+
   uint8_t ReadRawPress(void)                     // convert and read raw pressure
   { RawPress=0;
-    Error=I2C_Write(Bus, ADDR, CMD_ADC_CONV+CMD_ADC_D1+CMD_ADC_4096, 0); if(Error) return Error;
+    if(TrigRawPress()) return Error;
     vTaskDelay(12);
-    Error=I2C_Read(Bus, ADDR, CMD_ADC_READ, (uint8_t *)(&RawPress), 3); if(Error) return Error;
-    RawPress = ((RawPress<<16)&0xFF0000) | (RawPress&0x00FF00) | ((RawPress>>16)&0x0000FF); // swap bytes
-    return 0; }
+    return ReadADC(RawPress); }
 
-  uint8_t ReadRawTemp(void)                     // convert and read raw temperature
+  uint8_t ReadRawTemp(void)                      // convert and read raw temperature
   { RawTemp=0;
-    Error=I2C_Write(Bus, ADDR, CMD_ADC_CONV+CMD_ADC_D2+CMD_ADC_4096, 0); if(Error) return Error;
+    if(TrigRawTemp()) return Error;
     vTaskDelay(12);
-    Error=I2C_Read(Bus, ADDR, CMD_ADC_READ, (uint8_t *)(&RawTemp), 3); if(Error) return Error;
-    RawTemp = ((RawTemp<<16)&0xFF0000) | (RawTemp&0x00FF00) | ((RawTemp>>16)&0x0000FF); // swap bytes
-    return 0; }
+    return ReadADC(RawTemp); }
 
   uint8_t Acquire(void)                        // convert and read raw pressure then temperature
   { if(ReadRawPress()) return Error;
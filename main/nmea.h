@@ -54,6 +54,16 @@ inline uint8_t NMEA_AppendCheckCRNL(char    *NMEA, uint8_t Len) { return NMEA_Ap
        }
        return; }
 
+   int ProcessBlock(const uint8_t *Block, int Bytes) // fast ProcessByte() over the printable bytes inside a sentence
+     { if(!isLoading() || isComplete()) return 0; // only when loading: the '$', the end of the frame and errors are left to ProcessByte()
+       uint8_t Chk=Check; int Idx;
+       for(Idx=0; Idx<Bytes; Idx++)
+       { uint8_t Byte=Block[Idx];
+         if(Byte<=' ' || Byte>=0x80 || Len>=MaxLen) break; // control, non-ASCII (possibly UBX/MAV) or too long: stop here
+         if(Byte==',') { if(Parms<MaxParms) Parm[Parms++]=Len+1; }
+         Data[Len++]=Byte; Chk^=Byte; }
+       Check=Chk; return Idx; }              // return the number of bytes taken
+
    uint8_t isLoading(void) const  { return State &0x01; }
    void   setLoading(void)        {        State|=0x01; }
 
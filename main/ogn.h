@@ -573,8 +573,10 @@ class OGN_PPM_Packet                                        // OGN packet with F
 
 // ---------------------------------------------------------------------------------------------------------------------
 
+// Relay queue for a few slots: every operation scans all the slots, which is the fastest up to about 32 slots.
+
 template<class OGNx_Packet, uint8_t Size=8>
- class OGN_PrioQueue
+ class OGN_PrioQueueLinear
 { public:
    // static const uint8_t Size = 8;            // number of packets kept
    OGN_RxPacket<OGNx_Packet> Packet[Size];   // OGN packets
@@ -615,6 +617,11 @@ template<class OGNx_Packet, uint8_t Size=8>
      // else reCalc();
      return Prev; }
 
+   OGN_RxPacket<OGNx_Packet> *find(uint32_t AddressAndType)                   // the allocated packet of this ID, if any
+   { for(uint8_t Idx=0; Idx<Size; Idx++)
+     { if(Packet[Idx].Alloc && Packet[Idx].Packet.getAddressAndType()==AddressAndType) return Packet+Idx; }
+     return 0; }
+
    uint8_t getRand(uint32_t Rand) const                                       // get a position by random selection but probabilities prop. to ranks
    { if(Sum==0) return Rand%Size;                                             //
      uint16_t RankIdx = Rand%Sum;
@@ -672,6 +679,193 @@ template<class OGNx_Packet, uint8_t Size=8>
 
 } ;
 
+// Relay queue for many slots: received packets with their relay rank. An ID hash finds the previous packet of the same aircraft,
+// a Fenwick tree over the ranks gives the rank-proportional random pick, a tournament tree the lowest rank slot
+// to be overwritten and a list per time-of-second the packets to drop: every operation is O(log Size) or better.
+// Packet[] is public for the displays, but Alloc and Rank should only be changed through the member functions.
+
+template<class OGNx_Packet, uint8_t Size=8>
+ class OGN_PrioQueueTree
+{ public:
+   static const uint8_t HashSize = 2*Size;   // ID hash: half full at most, thus short probe chains; Size up to 127
+   static const uint8_t None     = 0xFF;     // end of a time list
+   static const uint8_t TopBit   = Size>=128?128:Size>=64?64:Size>=32?32:Size>=16?16:Size>=8?8:Size>=4?4:Size>=2?2:1;
+
+   OGN_RxPacket<OGNx_Packet> Packet[Size];   // OGN packets
+   uint16_t             Sum;                 // sum of all ranks
+   uint8_t              Low, LowIdx;         // the lowest rank and the index of it
+
+  private:
+   uint8_t  Weight[Size];                    // rank as counted in Sum and the trees, zero for a free slot
+   uint16_t RankTree[Size+1];                // Fenwick tree over Weight[]
+   uint8_t  LowTree[2*Size];                 // tournament tree: slot with the lowest Weight[] below each node, [1] for all, leaves from [Size]
+   uint8_t  Hash[HashSize];                  // slot+1 per address-and-type, zero: empty, linear probing
+   uint8_t  TimeHead[64];                    // first slot of every Position.Time value
+   uint8_t  TimeNext[Size], TimePrev[Size];  // double-linked list of the allocated slots with same Position.Time
+
+  public:
+   OGN_PrioQueueTree() { Clear(); }
+
+   void Clear(void)                                                           // clear (reset) the queue
+   { for(uint8_t Idx=0; Idx<Size; Idx++)                                      // clear every packet
+     { Packet[Idx].Clear(); Weight[Idx]=0; TimeNext[Idx]=TimePrev[Idx]=None; }
+     for(uint8_t Idx=0; Idx<HashSize; Idx++) Hash[Idx]=0;
+     for(uint8_t Idx=0; Idx<64; Idx++) TimeHead[Idx]=None;
+     reCalc(); }                                                              // clear the rank sum, lowest rank
+
+   OGN_RxPacket<OGNx_Packet> * operator [](uint8_t Idx) { return Packet+Idx; }
+
+   uint8_t getNew(void)                                                       // get (index of) a free or lowest rank packet
+   { uint8_t Idx=LowIdx;
+     unlinkHash(Idx);                                                         // content is about to be overwritten
+     if(Packet[Idx].Alloc) unlinkTime(Idx);
+     Packet[Idx].Alloc=0; Packet[Idx].Rank=0; setWeight(Idx, 0);              // remove old packet from the rank sum
+     return Idx; }
+
+   uint8_t size(void)                                                        // count all slots with Alloc flag set
+   { uint8_t Count=0;
+     for(uint8_t Idx=0; Idx<Size; Idx++)
+     { if(Packet[Idx].Alloc) Count++; }
+     return Count; }
+
+   OGN_RxPacket<OGNx_Packet> *addNew(uint8_t NewIdx)                          // add the new packet to the queue
+   { OGN_RxPacket<OGNx_Packet> *Prev = 0;
+     if(Packet[NewIdx].Alloc) unlinkTime(NewIdx);
+     Packet[NewIdx].Alloc=1;                                                  // mark this slot as allocated
+     uint32_t AddressAndType = Packet[NewIdx].Packet.getAddressAndType();     // get ID of this packet: ID is address-type and address (2+24 = 26 bits)
+     uint8_t Pos=findHash(AddressAndType);                                    // look for another packet with same ID
+     uint8_t Idx=Hash[Pos];
+     if(Idx && Idx-1!=NewIdx)
+     { Prev=Packet+(Idx-1); clean(Idx-1); }                                   // then remove it: set rank to zero
+     Hash[Pos]=NewIdx+1;                                                      // the new packet takes its place in the hash
+     linkTime(NewIdx);
+     setWeight(NewIdx, Packet[NewIdx].Rank);                                  // add the new packet to the rank sum
+     return Prev; }
+
+   OGN_RxPacket<OGNx_Packet> *find(uint32_t AddressAndType)                   // the last packet of this ID, if any: it may be cleaned already
+   { uint8_t Idx=Hash[findHash(AddressAndType)];
+     return Idx ? Packet+(Idx-1):0; }
+
+   uint8_t getRand(uint32_t Rand) const                                       // get a position by random selection but probabilities prop. to ranks
+   { if(Sum==0) return Rand%Size;                                             //
+     uint16_t RankIdx = Rand%Sum;
+     uint8_t Idx=0;                                                           // descend the Fenwick tree: first slot where the rank sum exceeds RankIdx
+     for(uint8_t Step=TopBit; Step; Step>>=1)
+     { uint8_t Next=Idx+Step; if(Next>Size) continue;
+       if(RankTree[Next]<=RankIdx) { Idx=Next; RankIdx-=RankTree[Next]; }
+     }
+     return Idx; }
+
+   void reCalc(void)                                                           // rebuild the rank sum and the trees from the slots
+   { Sum=0;
+     for(uint8_t Idx=0; Idx<Size; Idx++)
+     { Weight[Idx] = Packet[Idx].Alloc ? Packet[Idx].Rank:0; Sum+=Weight[Idx]; }
+     for(uint8_t Node=1; Node<=Size; Node++) RankTree[Node]=Weight[Node-1];
+     for(uint8_t Node=1; Node<=Size; Node++)                                   // Fenwick tree in O(Size): each node adds itself to its parent
+     { uint8_t Parent=Node+(Node&(-Node)); if(Parent<=Size) RankTree[Parent]+=RankTree[Node]; }
+     for(uint8_t Idx=0; Idx<Size; Idx++) LowTree[Size+Idx]=Idx;
+     for(uint8_t Node=Size-1; Node; Node--) LowTree[Node]=Winner(Node);
+     Low=Weight[LowIdx=LowTree[1]]; }
+
+   void cleanTime(uint8_t Time)                                                // clean up slots of given Time
+   { cleanList(Time&63);
+     for(uint8_t Sec=60; Sec<64; Sec++) cleanList(Sec); }                      // and those with invalid time
+
+   void clean(uint8_t Idx)                                                      // clean given slot, remove it from the sum
+   { if(Packet[Idx].Alloc) unlinkTime(Idx);
+     Packet[Idx].Rank=0; Packet[Idx].Alloc=0; setWeight(Idx, 0); }             // stays in the hash: the previous packet for the next one of this ID
+
+   void decrRank(uint8_t Idx, uint8_t Decr=1)                                   // decrement rank of given slot
+   { uint8_t Rank=Packet[Idx].Rank; if(Rank==0) return;                         // if zero already: do nothing
+     if(Decr>Rank) Decr=Rank;                                                   // if to decrement by more than the rank already: reduce the decrement
+     Rank-=Decr;                                                                // decrement the rank
+     Packet[Idx].Rank=Rank; setWeight(Idx, Packet[Idx].Alloc ? Rank:0); }       // update the rank of this slot, the sum and the trees
+
+   uint8_t Print(char *Out)
+   { uint8_t Len=0;
+     for(uint8_t Idx=0; Idx<Size; Idx++)                                        // loop through the slots
+     { if(Packet[Idx].Alloc==0) continue;
+       uint8_t Rank=Packet[Idx].Rank;
+       Out[Len++]=' '; Len+=Format_Hex(Out+Len, Rank);                          // print the slot Rank
+       // if(Rank)                                                                 // if Rank is none-zero
+       { Out[Len++]='/'; Len+=Format_Hex(Out+Len, Packet[Idx].Packet.getAddressAndType() );   // print address-type and address
+         Out[Len++]=':';
+         if(Packet[Idx].Packet.Header.Encrypted) Len+=Format_String(Out+Len, "ee");
+         else Len+=Format_UnsDec(Out+Len, (uint32_t)Packet[Idx].Packet.Position.Time, 2); // [sec] print time
+       }
+     }
+     Out[Len++]=' '; Len+=Format_Hex(Out+Len, Sum);                             // sum of all Ranks
+     Out[Len++]='/'; Len+=Format_Hex(Out+Len, LowIdx);                          // index of the lowest Rank or a free slot
+     Out[Len++]='\n'; Out[Len]=0; return Len; }
+
+  private:
+   void setWeight(uint8_t Idx, uint8_t New)                                     // new rank of a slot into the sum and both trees
+   { int16_t Diff = (int16_t)New-Weight[Idx];
+     if(Diff)
+     { Weight[Idx]=New; Sum+=Diff;
+       for(uint8_t Node=Idx+1; Node<=Size; Node+=Node&(-Node)) RankTree[Node]+=Diff;
+       uint8_t Node=(Size+Idx)>>1;
+       if(Diff<0)                                                               // lower: replace up to where it does not win, then stop
+       { for( ; Node; Node>>=1)
+         { uint8_t Win=LowTree[Node];
+           if(Win!=Idx) { if(New>=Weight[Win]) break; LowTree[Node]=Idx; } }
+       }
+       else for( ; Node; Node>>=1) LowTree[Node]=Winner(Node); }                 // higher: replay all the way up
+     Low=Weight[LowIdx=LowTree[1]]; }
+
+   uint8_t Winner(uint8_t Node) const
+   { uint8_t Left=LowTree[2*Node], Right=LowTree[2*Node+1];
+     return Weight[Right]<Weight[Left] ? Right:Left; }
+
+   static uint8_t hashPos(uint32_t AddressAndType) { return ((AddressAndType*0x9E3779B1)>>16)%HashSize; }
+
+   uint8_t findHash(uint32_t AddressAndType) const                              // hash position of this ID or the empty one where it would go
+   { uint8_t Pos=hashPos(AddressAndType);
+     for( ; Hash[Pos]; )
+     { if(Packet[Hash[Pos]-1].Packet.getAddressAndType()==AddressAndType) break;
+       Pos++; if(Pos>=HashSize) Pos=0; }
+     return Pos; }
+
+   void unlinkHash(uint8_t Idx)                                                 // remove the slot from the hash, if it is there
+   { uint8_t Pos=findHash(Packet[Idx].Packet.getAddressAndType());
+     if(Hash[Pos]!=Idx+1) return;
+     for( ; ; )                                                                 // backward-shift deletion: no tombstones
+     { Hash[Pos]=0; uint8_t Gap=Pos;
+       for( ; ; )
+       { Pos++; if(Pos>=HashSize) Pos=0;
+         if(Hash[Pos]==0) return;
+         uint8_t Home=hashPos(Packet[Hash[Pos]-1].Packet.getAddressAndType());
+         bool Stay = Gap<=Pos ? Gap<Home && Home<=Pos : Gap<Home || Home<=Pos; // home between the gap and here: cannot move
+         if(!Stay) break; }
+       Hash[Gap]=Hash[Pos]; }
+   }
+
+   void linkTime(uint8_t Idx)
+   { uint8_t Time=Packet[Idx].Packet.Position.Time;
+     TimePrev[Idx]=None; TimeNext[Idx]=TimeHead[Time];
+     if(TimeHead[Time]!=None) TimePrev[TimeHead[Time]]=Idx;
+     TimeHead[Time]=Idx; }
+
+   void unlinkTime(uint8_t Idx)
+   { uint8_t Prev=TimePrev[Idx], Next=TimeNext[Idx];
+     if(Prev!=None) TimeNext[Prev]=Next;
+     else TimeHead[Packet[Idx].Packet.Position.Time]=Next;
+     if(Next!=None) TimePrev[Next]=Prev;
+     TimePrev[Idx]=TimeNext[Idx]=None; }
+
+   void cleanList(uint8_t Time)
+   { while(TimeHead[Time]!=None) clean(TimeHead[Time]); }
+
+} ;
+
+// The relay queue by its size: the trees pay off only above 32 slots, below they cost time and RAM.
+
+template<class OGNx_Packet, uint8_t Size=8, bool Tree=(Size>32)>
+ class OGN_PrioQueue : public OGN_PrioQueueLinear<OGNx_Packet, Size> { } ;
+
+template<class OGNx_Packet, uint8_t Size>
+ class OGN_PrioQueue<OGNx_Packet, Size, 1> : public OGN_PrioQueueTree<OGNx_Packet, Size> { } ;
+
 class GPS_Time
 { public:
    int8_t  Year, Month, Day;    // Date (UTC) from GPS
@@ -1849,8 +2043,11 @@ class GPS_Position: public GPS_Time
 
   public:
 
+   static uint32_t ZeroBytes(uint32_t Word)                    // 0x80 in every byte of the word which is zero, 0x00 in the others
+   { return ~(((Word&0x7F7F7F7F)+0x7F7F7F7F) | Word | 0x7F7F7F7F); }
+
    int8_t static IndexNMEA(uint8_t Index[20], const char *Seq) // index parameters and verify the NMEA checksum
-   { int8_t Ptr=0;
+   { int Ptr=0;
      uint8_t Check=0;
      if(Seq[Ptr]!='$') return -1;                              // first chat. must be dollar sign
      Ptr++;
@@ -1860,12 +2057,25 @@ class GPS_Position: public GPS_Time
      if(Seq[Ptr]!=',') return -1;                              // comma after the sentence name
      Check^=Seq[Ptr++];                                        // take comma to the checksum
      Index[0]=Ptr; int8_t Params=1;                            // first parameter
+     uint32_t CheckWord=0;                                     // checksum of the chars taken four at a time, folded at the end
      for( ; ; )
-     { char ch=Seq[Ptr++]; if(ch<' ') return -1;               // go through the chars
+     {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+       if((((uintptr_t)(Seq+Ptr))&3)==0)                       // when aligned take four chars at once: an aligned word never crosses past the string page
+       { uint32_t Word; memcpy(&Word, __builtin_assume_aligned(Seq+Ptr, 4), 4);
+         uint32_t Stop = ZeroBytes(Word^0x2A2A2A2A) | ZeroBytes(Word&0xE0E0E0E0) | (Word&0x80808080); // star, control or non-ASCII chars
+         if(Stop==0)                                           // none of them: only commas need attention
+         { for(uint32_t Comma=ZeroBytes(Word^0x2C2C2C2C); Comma; Comma&=Comma-1)
+             Index[Params++] = Ptr+(__builtin_ctz(Comma)>>3)+1; // the first char is in the lowest byte
+           CheckWord^=Word; Ptr+=4; continue; }
+       }                                                       // otherwise go char-by-char through this word
+#endif
+       char ch=Seq[Ptr++]; if(ch<' ') return -1;               // go through the chars
        if(ch=='*') break;                                      // break at star (check-sum should follow)
        Check^=ch;                                              // get chars to the checksum
        if(ch==',') { Index[Params++]=Ptr; }                    // if comma then counr next parameter
      }
+     CheckWord^=CheckWord>>16; CheckWord^=CheckWord>>8; Check^=(uint8_t)CheckWord; // XOR of the four bytes
      if(Seq[Ptr++]!=HexDigit(Check>>4)  ) return -2;           // verify checksum
      if(Seq[Ptr++]!=HexDigit(Check&0x0F)) return -2;
      // printf("%s => [%d]\n", Seq, Params);
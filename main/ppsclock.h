@@ -0,0 +1,148 @@
+#ifndef __PPSCLOCK_H__
+#define __PPSCLOCK_H__
+
+#include <stdint.h>
+#include <math.h>
+
+// Microsecond time base disciplined by the GPS PPS. A free-running local timer (esp_timer: 1us) is captured
+// on every PPS edge and a straight line is fitted through the last Window edges. The line gives the local time
+// of the second boundary and the local length of one second, thus the oscillator drift. Edges far from the line
+// (late interrupt, GPS glitch) are rejected, and MaxReject rejections in a row restart the fit. Time queries
+// come with an uncertainty from the fit residuals; it grows with the time since the last edge.
+// Update() runs in one task. getTime() and getDrift(Drift) may run in any task: they never wait for the writer,
+// which may be a lower priority task preempted in the middle of an update, but return 0 then and the caller falls back.
+
+class PPS_Clock
+{ public:
+   static const uint8_t Window    =  16;                  // PPS edges in the fit: up to 16, see Excl
+   static const uint8_t MinEdges  =   3;                  // for a valid fit
+   static const int32_t MaxAge    = 120;                  // [sec] older edges are left out of the fit
+   static const int32_t MinGate   =  20;                  // [us] the narrowest gate for new edges
+   static const int32_t Latency   =   3;                  // [us] from the PPS edge to the timer read in the interrupt
+   static const int32_t StartGate = 100;                  // [ppm] accepted local clock error before the fit
+   static const uint8_t MaxReject =   4;                  // rejected edges in a row: restart the fit
+   static const int32_t MaxHold   = 600;                  // [sec] no time after that long without an edge
+   static const int32_t DriftRate =  10;                  // [ppb/sec] change of the oscillator drift with temperature: for the uncertainty
+
+   int64_t  EdgeLocal[Window];                            // [us] local timer at the PPS edges
+   uint32_t EdgeTime[Window];                             // [sec] UTC second which starts at the edge
+   uint16_t Excl;                                         // edges left out of the fit, one bit each: far off the others
+   uint8_t  Edges, EdgeIdx;                               // edges stored, where the next one goes
+   uint8_t  Reject;                                       // edges rejected in a row
+   uint32_t Rejected;                                     // edges rejected in total
+
+   volatile uint32_t Seq;                                 // odd while the fit is being updated
+   bool     Valid;                                        // fitted over at least MinEdges
+   uint8_t  Points;                                       // edges in the fit
+   uint32_t RefTime;                                      // [sec] second of the last accepted edge
+   int64_t  RefLocal;                                     // [ns] fitted local time of RefTime
+   int64_t  Period;                                       // [ns] fitted local length of one second
+   float    Sigma;                                        // [ns] RMS residual of the fit
+   int32_t  SumX;                                         // [sec] sum of the edge times relative to RefTime
+   int64_t  Spread;                                       // [sec^2] Points*SumXX-SumX*SumX
+
+  public:
+   PPS_Clock() { Seq=0; Clear(); }
+
+   void Clear(void)
+   { Seq++; Edges=0; EdgeIdx=0; Excl=0; Reject=0; Valid=0; Points=0; RefTime=0; RefLocal=0; Period=1000000000; Sigma=0; SumX=0; Spread=0; Seq++; }
+
+   int32_t getDrift(void) const { return Period-1000000000; } // [ppb] local clock fast (positive) or slow against GPS
+
+   bool getDrift(int32_t &Drift) const                    // [ppb] as above, from any task, 0: no fit
+   { uint32_t Start=Seq; __sync_synchronize();
+     if(Start&1) return 0;                                // update in progress: do not spin, on one core the writer would never finish
+     bool Ret=Valid; Drift=getDrift();
+     __sync_synchronize();
+     return Ret && Seq==Start; }                          // changed under us: no drift this time
+
+   int Update(int64_t usLocal, uint32_t Time)             // new PPS edge captured at local [us], starts the UTC second Time
+   { usLocal-=Latency;                                    // 1=accepted, 0=rejected, -1=restarted the fit
+     if(Edges)
+     { uint8_t  Last=(EdgeIdx+Window-1)%Window;
+       int32_t  Secs=Time-EdgeTime[Last];
+       bool OK = Secs>0 && Secs<=MaxHold;
+       if(OK && Valid)                                    // check against the line
+       { int64_t Err = usLocal*1000 - (RefLocal + Period*(int64_t)(Time-RefTime));
+         int64_t Gate = 5*getUncert(Time-RefTime)+1000*MinGate;
+         OK = Err<=Gate && Err>=(-Gate); }
+       else if(OK)                                        // no line yet: check against the previous edge, not one left out
+       { for(uint8_t Back=1; Back<Edges && (Excl>>Last)&1; Back++) Last=(EdgeIdx+Window-1-Back)%Window;
+         Secs=Time-EdgeTime[Last];
+         int64_t Err = (usLocal-EdgeLocal[Last]) - (int64_t)1000000*Secs;
+         int64_t Gate = (int64_t)StartGate*Secs+MinGate;
+         OK = Err<=Gate && Err>=(-Gate); }
+       if(!OK)
+       { Rejected++;
+         if(Valid) { Reject++; if(Reject<MaxReject) return 0; } // no line yet: one of the two is off, start again from the new one
+         Seq++; Edges=0; EdgeIdx=0; Excl=0; Valid=0; Seq++; } // too many in a row: the line is off, start again from this edge
+     }
+     int Ret = Edges ? 1:-1;
+     Reject=0;
+     EdgeLocal[EdgeIdx]=usLocal; EdgeTime[EdgeIdx]=Time; Excl&=~(1<<EdgeIdx);
+     EdgeIdx++; if(EdgeIdx>=Window) EdgeIdx=0;
+     if(Edges<Window) Edges++;
+     Fit(usLocal, Time);
+     return Ret; }
+
+   bool getTime(int64_t usLocal, uint32_t &Time, uint32_t &usTime, uint32_t &usUncert) const // UTC time at local [us], 0: no time
+   { uint32_t Start=Seq; __sync_synchronize();
+     if(Start&1) return 0;                                // update in progress: do not spin, on one core the writer would never finish
+     bool Ret=Valid;
+     if(Ret)
+     { int64_t Elapsed = usLocal*1000-RefLocal;           // [ns] local time since the fitted edge
+       int64_t Sec = Elapsed/Period; int64_t Rem=Elapsed-Sec*Period;
+       if(Rem<0) { Sec--; Rem+=Period; }
+       Ret = Sec>=(-MaxHold) && Sec<=MaxHold;
+       Time    = RefTime+Sec;
+       usTime  = Rem*1000000/Period;
+       usUncert = (getUncert((float)Elapsed/Period)+999)/1000; }
+     __sync_synchronize();
+     return Ret && Seq==Start; }                          // changed under us: no time this call
+
+   int64_t getUncert(float Secs) const                    // [ns] uncertainty of the line Secs after the last edge
+   { if(!Valid) return 1000000000;
+     float Dist = Points*Secs-SumX;
+     float Var = Sigma*Sigma*(Spread+Dist*Dist)/((float)Points*Spread);
+     float Wander = 0.5f*DriftRate*Secs*Secs;             // [ns] the drift does not stay
+     return (int64_t)sqrtf(Var+Wander*Wander)+1000; }     // plus the 1us resolution of the timer
+
+  private:
+   void Fit(int64_t usLocal, uint32_t Time)               // least squares line through the recent edges, relative to the newest
+   { for(uint8_t Pass=0; ; Pass++)
+     { int64_t N=0, Sx=0, Sxx=0, Sy=0, Sxy=0;
+       for(uint8_t Idx=0; Idx<Edges; Idx++)
+       { if((Excl>>Idx)&1) continue;
+         int32_t X = EdgeTime[Idx]-Time; if(X<=(-MaxAge)) continue; // [sec]
+         int64_t Y = EdgeLocal[Idx]-usLocal;              // [us]
+         N++; Sx+=X; Sxx+=(int64_t)X*X; Sy+=Y; Sxy+=X*Y; }
+       int64_t Den = N*Sxx-Sx*Sx;
+       if(N<MinEdges || Den<=0) return;                   // too few recent edges: keep the line we have, if any
+       int64_t Slope = 1000*(N*Sxy-Sx*Sy)/Den;            // [ns] local length of the second
+       int64_t Ofs = (1000*Sy-Slope*Sx)/N;                // [ns] line at the newest edge
+       double Sum2=0, Worst2=0; int WorstIdx=-1;
+       for(uint8_t Idx=0; Idx<Edges; Idx++)
+       { if((Excl>>Idx)&1) continue;
+         int32_t X = EdgeTime[Idx]-Time; if(X<=(-MaxAge)) continue;
+         double Res = 1000*(EdgeLocal[Idx]-usLocal) - (Ofs+Slope*X);
+         Sum2 += Res*Res; if(Res*Res>Worst2) { Worst2=Res*Res; WorstIdx=Idx; } }
+       if(Pass<2 && N>=4 && Worst2>(0.25e6*MinGate*MinGate) && Worst2>16*(Sum2-Worst2)/(N-3)) // one edge far off the others: a late interrupt
+       { Excl|=1<<WorstIdx; continue; }                   // leave it out, but keep its time: it may be the newest edge
+       if(N<2*MinEdges && Sum2>(N-2)*(1e6*MinGate*MinGate)) // few edges and they do not agree: drop one, keep the line we have
+       { int Oldest=-1;
+         for(uint8_t Idx=0; Idx<Edges; Idx++)
+         { if((Excl>>Idx)&1) continue;
+           int32_t X = EdgeTime[Idx]-Time; if(X<=(-MaxAge)) continue;
+           if(Oldest<0 || EdgeTime[Idx]<EdgeTime[Oldest]) Oldest=Idx; }
+         if(N>=4) Oldest=WorstIdx;
+         Excl|=1<<Oldest; return; }
+       Seq++; __sync_synchronize();
+       RefTime=Time; Points=N; SumX=Sx; Spread=Den; Valid=1;
+       Period=Slope; RefLocal=usLocal*1000+Ofs;
+       Sigma = N>2 ? sqrt(Sum2/(N-2)):0;
+       __sync_synchronize(); Seq++; return; }
+   }
+
+} ;
+
+#endif // __PPSCLOCK_H__
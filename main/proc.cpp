@@ -118,6 +118,7 @@ static int FlashLog(OGN_TxPacket<OGN_Packet> *Packet, uint32_t Time)
 // #endif
 
 OGN_PrioQueue<OGN_Packet, RelayQueueSize> RelayQueue;       // received packets and candidates to be relayed
+OGN_RelaySched<OGN_Packet> RelaySched;                      // relay duty cycle, back-off and counters
 
 #ifdef DEBUG_PRINT
 static void PrintRelayQueue(uint8_t Idx)                    // for debug
@@ -133,6 +134,7 @@ static void PrintRelayQueue(uint8_t Idx)                    // for debug
 
 static bool GetRelayPacket(OGN_TxPacket<OGN_Packet> *Packet)      // prepare a packet to be relayed
 { if(RelayQueue.Sum==0) return 0;                     // if no packets in the relay queue
+  if(!RelaySched.Allow(TX_Credit)) return 0;          // low on TX credit or backing off: keep the air time for own positions
   XorShift32(RX_Random);                              // produce a new random number
   uint8_t Idx=RelayQueue.getRand(RX_Random);          // get weight-random packet from the relay queue
   if(RelayQueue.Packet[Idx].Rank==0) return 0;        // should not happen ...
@@ -143,6 +145,7 @@ static bool GetRelayPacket(OGN_TxPacket<OGN_Packet> *Packet)      // prepare a p
   Packet->calcFEC();                                  // Calc. the FEC code => packet ready for transmission
   // PrintRelayQueue(Idx);  // for debug
   RelayQueue.decrRank(Idx);                           // reduce the rank of the packet selected for relay
+  RelaySched.Sent(RelayQueue.Packet[Idx].Packet);     // count it and remember it to spot duplicates
   return 1; }
 
 static void CleanRelayQueue(uint32_t Time, uint32_t Delay=20) // remove "old" packets from the relay queue
@@ -301,10 +304,7 @@ static void ReadStatus(OGN_Packet &Packet)
       Format_String(CONS_UART_Write, Line, 0, Len);                          // send the NMEA out to the console
       xSemaphoreGive(CONS_Mutex); }
 #ifdef WITH_SDLOG
-    if(Log_Free()>=128)
-    { xSemaphoreTake(Log_Mutex, portMAX_DELAY);
-      Format_String(Log_Write, Line, 0, Len);                                // send the NMEA out to the log file
-      xSemaphoreGive(Log_Mutex); }
+    Log_Append(Line, Len);                                                   // send the NMEA out to the log file
 #endif
   }
 }
@@ -348,6 +348,8 @@ static void ProcessRxPacket(OGN_RxPacket<OGN_Packet> *RxPacket, uint8_t RxPacket
   uint8_t MyOwnPacket = ( RxPacket->Packet.Header.Address  == Parameters.Address  )
                      && ( RxPacket->Packet.Header.AddrType == Parameters.AddrType );
   if(MyOwnPacket) return;                                                             // don't process my own (relayed) packets
+  if(RxPacket->Packet.Header.Relay)                                                   // relayed by another station: a duplicate of ours or our candidate ?
+    RelaySched.Heard(RxPacket->Packet, RelayQueue.find(RxPacket->Packet.getAddressAndType()), RX_Random);
   if(RxPacket->Packet.Header.Encrypted && RxPacket->RxErr<10)                         // here we attempt to relay encrypted packets
   { RxPacket->calcRelayRank(GPS_Altitude/10);
     OGN_RxPacket<OGN_Packet> *PrevRxPacket = RelayQueue.addNew(RxPacketIdx);          // add to the relay queue and get the previous packet of same ID
@@ -368,10 +370,7 @@ static void ProcessRxPacket(OGN_RxPacket<OGN_Packet> *RxPacket, uint8_t RxPacket
         Format_String(CONS_UART_Write, Line, 0, Len);
         xSemaphoreGive(CONS_Mutex); }
 #ifdef WITH_SDLOG
-      if(Log_Free()>=128)
-      { xSemaphoreTake(Log_Mutex, portMAX_DELAY);
-        Format_String(Log_Write, Line, 0, Len);
-        xSemaphoreGive(Log_Mutex); }
+      Log_Append(Line, Len);
 #endif
     }
 #endif
@@ -420,10 +419,7 @@ static void ProcessRxPacket(OGN_RxPacket<OGN_Packet> *RxPacket, uint8_t RxPacket
       Format_String(CONS_UART_Write, Line, 0, Len);
       xSemaphoreGive(CONS_Mutex);
 #ifdef WITH_SDLOG
-    if(Log_Free()>=128)
-    { xSemaphoreTake(Log_Mutex, portMAX_DELAY);
-      Format_String(Log_Write, Line, 0, Len);                                // send the NMEA out to the log file
-      xSemaphoreGive(Log_Mutex); }
+    Log_Append(Line, Len);                                                   // send the NMEA out to the log file
 #endif
     }
 #endif
@@ -447,7 +443,16 @@ static void DecodeRxPacket(RFM_FSK_RxPktData *RxPkt)
   // TickType_t ExecTime=xTaskGetTickCount();
 
   { RX_OGN_Packets++;
-    uint8_t Check = RxPkt->Decode(*RxPacket, Decoder);
+    uint8_t Iter=32; uint8_t Stall=0;                           // LDPC decoder budget: cut it down when more packets wait in the queue
+    size_t Queued=RF_RxFIFO.Full();
+    if(Queued>5) { Iter=16; Stall=4; }
+    else if(Queued>1) Stall=8;                                  // give up when failed checks do not drop for that many iterations
+#ifdef WITH_RX_CHASE
+    uint8_t Check = RxPkt->Decode(*RxPacket, Decoder, Iter, 8, Stall); // on failure try the 8 least reliable bits, in place of the last two iterations
+#else
+    uint8_t Check = RxPkt->Decode(*RxPacket, Decoder, Iter, 0, Stall);
+#endif
+    RX_OGN_Iter += Decoder.Iterations;
 #ifdef DEBUG_PRINT
     xSemaphoreTake(CONS_Mutex, portMAX_DELAY);
     Format_String(CONS_UART_Write, "DecodeRxPkt: ");
@@ -468,6 +473,14 @@ static void DecodeRxPacket(RFM_FSK_RxPktData *RxPkt)
 
 // -------------------------------------------------------------------------------------------------------------------
 
+#ifdef WITH_RF_IRQ
+static TickType_t TicksToSlot(void)                                    // [ticks] till the slot processing 340ms after the PPS
+{ int32_t Wait = 340-(int32_t)TimeSync_msTime();
+  if(Wait<=0) Wait+=1000;
+  if(Wait>100) Wait=100;                                               // limit: the time could be corrected meanwhile
+  return pdMS_TO_TICKS(Wait)+1; }
+#endif
+
 #ifdef __cplusplus
   extern "C"
 #endif
@@ -482,6 +495,10 @@ void vTaskPROC(void* pvParameters)
   xSemaphoreGive(CONS_Mutex);
 #endif
   RelayQueue.Clear();
+  RelaySched.Clear();
+#ifdef WITH_RF_IRQ
+  RF_RxTask = xTaskGetCurrentTaskHandle();                           // vTaskRF wakes us up on every received packet
+#endif
 
 #ifdef WITH_LOOKOUT
   Look.Clear();
@@ -494,7 +511,12 @@ void vTaskPROC(void* pvParameters)
   // OGN_TxPacket<OGN_Packet> InfoPacket;                                 // information packet
 
   for( ; ; )
-  { vTaskDelay(1);
+  {
+#ifdef WITH_RF_IRQ
+    if(RF_RxFIFO.isEmpty()) ulTaskNotifyTake(pdTRUE, TicksToSlot()); // sleep until a packet is received or a new slot starts
+#else
+    vTaskDelay(1);
+#endif
 
     RFM_FSK_RxPktData *RxPkt = RF_RxFIFO.getRead();                     // check for new received packets
     if(RxPkt)                                                           // if there is a new received packet
@@ -696,10 +718,7 @@ void vTaskPROC(void* pvParameters)
         Format_String(CONS_UART_Write, Line, 0, Len);
         xSemaphoreGive(CONS_Mutex);
 #ifdef WITH_SDLOG
-        if(Log_Free()>=128)
-        { xSemaphoreTake(Log_Mutex, portMAX_DELAY);
-          Format_String(Log_Write, Line, 0, Len);                                // send the NMEA out to the log file
-          xSemaphoreGive(Log_Mutex); }
+        Log_Append(Line, Len);                                                   // send the NMEA out to the log file
 #endif // WITH_SDLOG
       }
 #endif // WITH_PFLAA
@@ -738,10 +757,7 @@ void vTaskPROC(void* pvParameters)
         Format_String(CONS_UART_Write, Line, 0, Len);
         xSemaphoreGive(CONS_Mutex);
 #ifdef WITH_SDLOG
-        if(Log_Free()>=128)
-        { xSemaphoreTake(Log_Mutex, portMAX_DELAY);
-          Format_String(Log_Write, Line, 0, Len);                                // send the NMEA out to the log file
-          xSemaphoreGive(Log_Mutex); }
+        Log_Append(Line, Len);                                                   // send the NMEA out to the log file
 #endif // WITH_SDLOG
       }
 #endif // WITH_PFLAA
@@ -852,6 +868,7 @@ void vTaskPROC(void* pvParameters)
       RF_TxFIFO.Write();
     }
     CleanRelayQueue(SlotTime);
+    RelaySched.Tick();
 
   }
 
@@ -11,13 +11,16 @@ extern  int32_t BatteryVoltageRate;   // [1/256 mV] averaged
 // extern FlightMonitor Flight;
 
 #ifdef WITH_ESP32
-const uint8_t RelayQueueSize = 32;
+const uint8_t RelayQueueSize = 64;
 #else
 const uint8_t RelayQueueSize = 16;
 #endif
 
 extern OGN_PrioQueue<OGN_Packet, RelayQueueSize> RelayQueue;       // received packets and candidates to be relayed
 
+#include "relay.h"
+extern OGN_RelaySched<OGN_Packet> RelaySched;                      // when to relay and how well it goes
+
 #ifdef __cplusplus
   extern "C"
 #endif
@@ -0,0 +1,101 @@
+#ifndef __RELAY_H__
+#define __RELAY_H__
+
+#include <stdint.h>
+
+#include "ogn.h"
+#include "format.h"
+
+// Relay scheduler: decides when a packet from the relay queue may go on air and keeps the score.
+// A relay costs AirTime of TX_Credit: no relays while the credit is below MinCredit, thus the own positions
+// keep their share of the 1% duty cycle. When another station relays a packet which we relayed as well,
+// we hold back for a few seconds; a queued candidate which another station relayed first is dropped.
+
+template <class OGNx_Packet=OGN1_Packet>
+ class OGN_RelaySched
+{ public:
+   static const int32_t AirTime   =  5;                   // [ms] TX_Credit charged per transmitted packet, as in rf.cpp
+   static const int32_t MinCredit = 20;                   // [ms] no relays below this credit
+   static const uint8_t Recent    =  8;                   // our last relays, kept to spot duplicates
+
+   uint32_t Relayed;                                      // packets passed to the Tx queue as relays
+   uint32_t Duplicate;                                    // our relays which another station relayed as well
+   uint32_t Suppressed;                                   // candidates dropped: another station relayed them first
+   uint32_t Held;                                         // [sec] time when relays were held back: low credit or back-off
+   uint32_t CreditSpent;                                  // [ms] TX credit of the relays passed to the Tx queue: at most what went on air
+   uint8_t  BackOff;                                      // [sec] no relays for that long
+
+  private:
+   bool     HeldNow;                                      // a relay was held back in this second: counted into Held by Tick()
+   uint32_t RecentKey[Recent];                            // address-and-type of our last relays, 0xFFFFFFFF: none
+   uint32_t RecentData[Recent];                           // and their payload, folded
+   uint8_t  RecentIdx;
+
+  public:
+   OGN_RelaySched() { Clear(); }
+
+   void Clear(void)
+   { Relayed=Duplicate=Suppressed=Held=CreditSpent=0; BackOff=0; HeldNow=0; RecentIdx=0;
+     for(uint8_t Idx=0; Idx<Recent; Idx++) { RecentKey[Idx]=0xFFFFFFFF; RecentData[Idx]=0; } }
+
+   static uint32_t Fold(const OGNx_Packet &Packet)        // same packet, whoever relays it: the header differs only by the relay count
+   { return Packet.Data[0]^Packet.Data[1]^Packet.Data[2]^Packet.Data[3]; }
+
+   void Tick(void)                                        // call every second
+   { if(BackOff) BackOff--;
+     if(HeldNow) { Held++; HeldNow=0; } }
+
+   bool Allow(int32_t Credit)                             // may another relay go into the Tx queue ? Credit = TX_Credit [ms]
+   { if(BackOff==0 && Credit>=MinCredit) return 1;
+     HeldNow=1; return 0; }
+
+   void Sent(const OGNx_Packet &Packet)                   // a relay passed to the Tx queue
+   { Relayed++; CreditSpent+=AirTime;
+     RecentKey[RecentIdx]=Packet.getAddressAndType(); RecentData[RecentIdx]=Fold(Packet);
+     RecentIdx++; if(RecentIdx>=Recent) RecentIdx=0; }
+
+   void Heard(const OGNx_Packet &Packet, const OGN_RxPacket<OGNx_Packet> *Queued, uint32_t Rand) // a packet relayed by another station
+   { uint32_t Key=Packet.getAddressAndType(), Data=Fold(Packet);                                  // Queued: our packet of the same ID, if any
+     for(uint8_t Idx=0; Idx<Recent; Idx++)
+     { if(RecentKey[Idx]!=Key || RecentData[Idx]!=Data) continue;                                 // we relayed it too: the area is covered
+       RecentKey[Idx]=0xFFFFFFFF;                                                                   // count it once, however many relay it
+       Duplicate++; BackOff=1+Rand%4; return; }
+     if(Queued && Queued->Alloc && Queued->Rank && Fold(Queued->Packet)==Data) Suppressed++; } // our candidate: the relay queue drops it
+
+   static uint32_t TxPower_uW(int8_t TxPower)             // [uW] transmitter power from [dBm]
+   { static const uint16_t Mant[10] = { 1000, 1259, 1585, 1995, 2512, 3162, 3981, 5012, 6310, 7943 };
+     if(TxPower<(-40)) TxPower=(-40);
+     if(TxPower>20) TxPower=20;
+     uint32_t Power=Mant[(TxPower+40)%10];
+     for(int Exp=(TxPower+40)/10; Exp; Exp--) Power*=10;
+     return Power/10000; }
+
+   uint32_t Energy(int8_t TxPower) const                  // [mJ] = [mWs] radiated by relays: an upper bound, see CreditSpent
+   { return ((uint64_t)CreditSpent*TxPower_uW(TxPower)+500000)/1000000; }
+
+   uint32_t Efficiency(int8_t TxPower) const              // [1/J] useful relays, not duplicated, per joule radiated: a lower bound
+   { uint32_t mJ=Energy(TxPower); if(mJ==0 || Duplicate>=Relayed) return 0;
+     return (uint64_t)(Relayed-Duplicate)*1000/mJ; }
+
+   int Print(char *Out, int8_t TxPower) const             // one line for the console
+   { int Len=0;
+     Len+=Format_String(Out+Len, "Relay: ");
+     Len+=Format_UnsDec(Out+Len, Relayed);
+     Len+=Format_String(Out+Len, " relayed, ");
+     Len+=Format_UnsDec(Out+Len, Duplicate);
+     Len+=Format_String(Out+Len, " duplicate, ");
+     Len+=Format_UnsDec(Out+Len, Suppressed);
+     Len+=Format_String(Out+Len, " suppressed, ");
+     Len+=Format_UnsDec(Out+Len, Held);
+     Len+=Format_String(Out+Len, "s held, ");
+     Len+=Format_UnsDec(Out+Len, CreditSpent);
+     Len+=Format_String(Out+Len, "ms ");
+     Len+=Format_UnsDec(Out+Len, Energy(TxPower));
+     Len+=Format_String(Out+Len, "mJ ");
+     Len+=Format_UnsDec(Out+Len, Efficiency(TxPower));
+     Len+=Format_String(Out+Len, "/J\n");
+     Out[Len]=0; return Len; }
+
+} ;
+
+#endif // __RELAY_H__
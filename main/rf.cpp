@@ -37,7 +37,10 @@ static const uint8_t *OGN_SYNC = OGN2_SYNC;
 static uint32_t  RF_SlotTime;               // [sec] UTC time which belongs to the current time slot (0.3sec late by GPS UTC)
        FreqPlan  RF_FreqPlan;               // frequency hopping pattern calculator
 
-       FIFO<RFM_FSK_RxPktData, 16> RF_RxFIFO;         // buffer for received packets
+  SPSC_FIFO<RFM_FSK_RxPktData, 16> RF_RxFIFO;         // buffer for received packets
+#ifdef WITH_RF_IRQ
+  TaskHandle_t RF_RxTask = 0;                          // task notified of every packet written to RF_RxFIFO
+#endif
        FIFO<OGN_TxPacket<OGN_Packet>, 4> RF_TxFIFO;   // buffer for transmitted packets
 
 #ifdef WITH_ADSL
@@ -57,6 +60,10 @@ static LowPass2<uint32_t, 4,2,4> RX_RSSI;   // low pass filter to average the RX
 static Delay<uint8_t, 64> RX_OGN_CountDelay;
        uint16_t           RX_OGN_Count64=0; // counts received packets for the last 64 seconds
 
+       uint16_t RX_OGN_Iter=0;              // [iter] counts LDPC decoder iterations spent on received packets
+static Delay<uint16_t, 64> RX_OGN_IterDelay;
+       uint32_t           RX_OGN_Iter64=0;  // counts LDPC decoder iterations for the last 64 seconds
+
       uint32_t RX_Random=0x12345678;        // Random number from LSB of RSSI readouts
 
 static uint8_t RX_Channel=0;                // (hopping) channel currently being received
@@ -116,24 +123,36 @@ static uint8_t ReceivePacket(void)                              // see if a pack
 
   RFM_FSK_RxPktData *RxPkt = RF_RxFIFO.getWrite();
   RxPkt->Time    = RF_SlotTime;                                 // store reception time
-  RxPkt->msTime = TimeSync_msTime(); if(RxPkt->msTime<200) RxPkt->msTime+=1000;
+  RxPkt->msTime = TimeSync_msPPS(); if(RxPkt->msTime<200) RxPkt->msTime+=1000;
   RxPkt->Channel = RX_Channel;                                  // store reception channel
   RxPkt->RSSI    = RxRSSI;                                      // store signal strength
   TRX.OGN_ReadPacket(RxPkt->Data, RxPkt->Err);                  // get the packet data from the FIFO
   // RxPkt->Print(CONS_UART_Write);                                // for debug
 
   RF_RxFIFO.Write();                                            // complete the write to the receiver FIFO
+#ifdef WITH_RF_IRQ
+  if(RF_RxTask) xTaskNotifyGive(RF_RxTask);                     // wake up the decoder
+#endif
   TRX.setModeRX();                                              // back to receive (but we already have AutoRxRestart)
   TRX.ClearIrqFlags();
   return 1; }                                                   // return: 1 packet we have received
 
+#ifdef WITH_RF_IRQ
+const int32_t RF_IRQ_MaxWait = 10;                             // [ticks] longest sleep without checking DIO0
+#endif
+
 static uint32_t ReceiveUntil(TickType_t End)
 { uint32_t Count=0;
   for( ; ; )
   { Count+=ReceivePacket();
     int32_t Left = End-xTaskGetTickCount();
     if(Left<=0) break;
+#ifdef WITH_RF_IRQ
+    if(Left>RF_IRQ_MaxWait) Left=RF_IRQ_MaxWait;                // check DIO0 now and then anyway, should an edge be missed
+    ulTaskNotifyTake(pdTRUE, Left); }                           // sleep until the IRQ line signals a packet
+#else
     vTaskDelay(1); }
+#endif
 #ifdef WITH_SX1262
 #ifdef DEBUG_PRINT
   xSemaphoreTake(CONS_Mutex, portMAX_DELAY);
@@ -454,6 +473,9 @@ extern "C"
   TRX.TransferByte = RFM_TransferByte;          // [call]
 #endif
   TRX.DIO0_isOn    = RFM_IRQ_isOn;              // [call] read IRQ (it is DIO1 for sx1262)
+#ifdef WITH_RF_IRQ
+  RFM_IRQ_Notify(xTaskGetCurrentTaskHandle());  // IRQ line wakes up this task
+#endif
 #ifdef WITH_SX1262
   TRX.Busy_isOn    = RFM_Busy_isOn;             // [call] read Busy
 #endif
@@ -482,6 +504,9 @@ extern "C"
 
   RX_OGN_Count64 = 0;
   RX_OGN_CountDelay.Clear();
+  RX_OGN_Iter    = 0;
+  RX_OGN_Iter64  = 0;
+  RX_OGN_IterDelay.Clear();
 
   RX_Channel = RF_FreqPlan.getChannel(TimeSync_Time(), 0, 1);                  // set initial RX channel
   SetRxChannel();
@@ -580,7 +605,7 @@ extern "C"
         uint8_t RxRSSI=TRX.ReadRSSI();                       // measure the channel noise level
         RX_Random = (RX_Random<<1) | (RxRSSI&1);
         RxRssiSum+=RxRSSI; RxRssiCount++;
-      } while(TimeSync_msTime()<270);                        // until 300ms from the PPS
+      } while(TimeSync_msPPS()<270);                         // until 300ms from the PPS
       RX_RSSI.Process(RxRssiSum/RxRssiCount);                // [-0.5dBm] average noise on channel
 #ifdef DEBUG_PRINT
       xSemaphoreTake(CONS_Mutex, portMAX_DELAY);
@@ -611,6 +636,8 @@ extern "C"
     RX_OGN_Count64 += RX_OGN_Packets - RX_OGN_CountDelay.Input(RX_OGN_Packets); // add OGN packets received, subtract packets received 64 seconds ago
 
     RX_OGN_Packets=0;                                                           // clear the received packet count
+    RX_OGN_Iter64 += RX_OGN_Iter - RX_OGN_IterDelay.Input(RX_OGN_Iter);         // same for the LDPC decoder iterations
+    RX_OGN_Iter=0;
 
     StartRFchip();                                                             // reset and rewrite the RF chip config
 
@@ -642,7 +669,7 @@ extern "C"
       uint8_t RxRSSI=TRX.ReadRSSI();                                           // read RSSI
       RX_Random = (RX_Random<<1) | (RxRSSI&1);                                 // take lower bit for random number generator
       RxRssiSum+=RxRSSI; RxRssiCount++;
-    } while(TimeSync_msTime()<350);                                            // keep going until 400 ms after PPS
+    } while(TimeSync_msPPS()<350);                                             // keep going until 400 ms after PPS
     RX_RSSI.Process(RxRssiSum/RxRssiCount);                                    // [-0.5dBm] average noise on channel
 
     TX_Credit+=10; if(TX_Credit>3600000) TX_Credit=600000;                     // [ms] count the transmission credit
@@ -671,10 +698,10 @@ extern "C"
     }
 #ifdef WITH_ADSL
     if(Parameters.TxADSL && RF_FreqPlan.Plan<=1 && ADSL_Slot==0 && ADSL_TxPkt)
-      TimeSlot(TxChan, 800-TimeSync_msTime(), ADSL_TxPkt, TRX.averRSSI, 0, TxTime);
+      TimeSlot(TxChan, 800-TimeSync_msPPS(), ADSL_TxPkt, TRX.averRSSI, 0, TxTime);
     else
 #endif
-      TimeSlot(TxChan, 800-TimeSync_msTime(), Parameters.TxOGN?TxPktData0:0, TRX.averRSSI, 0, TxTime); // run a Time-Slot till 0.800sec
+      TimeSlot(TxChan, 800-TimeSync_msPPS(), Parameters.TxOGN?TxPktData0:0, TRX.averRSSI, 0, TxTime); // run a Time-Slot till 0.800sec
 
     TRX.setModeStandby();
     TxChan = RF_FreqPlan.getChannel(RF_SlotTime, 1, 1);                        // transmit channel
@@ -740,10 +767,10 @@ extern "C"
 #endif
 #ifdef WITH_ADSL
     if(Parameters.TxADSL && RF_FreqPlan.Plan<=1 && ADSL_Slot==1 && ADSL_TxPkt)
-      TimeSlot(TxChan, SlotEnd-TimeSync_msTime(), ADSL_TxPkt, TRX.averRSSI, 0, TxTime);
+      TimeSlot(TxChan, SlotEnd-TimeSync_msPPS(), ADSL_TxPkt, TRX.averRSSI, 0, TxTime);
     else
 #endif
-      TimeSlot(TxChan, SlotEnd-TimeSync_msTime(), Parameters.TxOGN?TxPktData1:0, TRX.averRSSI, 0, TxTime);
+      TimeSlot(TxChan, SlotEnd-TimeSync_msPPS(), Parameters.TxOGN?TxPktData1:0, TRX.averRSSI, 0, TxTime);
 
 #ifdef WITH_PAW
    static uint8_t PAWtxBackOff = 4;
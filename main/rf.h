@@ -16,7 +16,10 @@
 #include "fanet.h"
 #endif
 
-  extern FIFO<RFM_FSK_RxPktData, 16> RF_RxFIFO;   // buffer for received packets
+  extern SPSC_FIFO<RFM_FSK_RxPktData, 16> RF_RxFIFO;   // buffer for received packets
+#ifdef WITH_RF_IRQ
+  extern TaskHandle_t RF_RxTask;                      // task notified of every packet written to RF_RxFIFO
+#endif
   extern FIFO<OGN_TxPacket<OGN_Packet>, 4> RF_TxFIFO;   // buffer for transmitted packets
 
 #ifdef WITH_ADSL
@@ -35,6 +38,8 @@
   extern FreqPlan  RF_FreqPlan;               // frequency hopping pattern calculator
   extern  int32_t    TX_Credit;               // [ms] counts transmitter time to avoid using more than 1%
   extern uint16_t RX_OGN_Count64;             // counts received packets for the last 64 seconds
+  extern uint16_t RX_OGN_Iter;                // [iter] counts LDPC decoder iterations spent on received packets
+  extern uint32_t RX_OGN_Iter64;              // counts LDPC decoder iterations for the last 64 seconds
   extern uint32_t RX_Random;                  // Random number from LSB of RSSI readouts
 
          void XorShift32(uint32_t &Seed);     // simple random number generator
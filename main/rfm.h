@@ -135,14 +135,14 @@ class RFM_FSK_RxPktData             // OGN packet received by the RF chip
      return Count; }
 
  template <class OGNx_Packet>
-  uint8_t Decode(OGN_RxPacket<OGNx_Packet> &Packet, LDPC_Decoder &Decoder, uint8_t Iter=32) const
-  { uint8_t Check=0;
-    uint8_t RxErr = ErrCount();                                // conunt Manchester decoding errors
+  uint8_t Decode(OGN_RxPacket<OGNx_Packet> &Packet, LDPC_Decoder &Decoder, uint8_t Iter=32, uint8_t ChaseFlips=0, uint8_t Stall=0) const
+  { uint8_t RxErr = ErrCount();                                // conunt Manchester decoding errors
     Decoder.Input(Data, Err);                                  // put data into the FEC decoder
-    for( ; Iter; Iter--)                                       // more loops is more chance to recover the packet
-    { Check=Decoder.ProcessChecks();                           // do an iteration
-      if(Check==0) break; }                                    // if FEC all fine: break
+    if(ChaseFlips) Iter-=Decoder.ChaseIter;                    // keep the time for the Chase search: the worst case stays that of Iter
+    uint8_t Check=Decoder.Process(Iter, Stall);                // more loops is more chance to recover the packet, stop early when no progress
     Decoder.Output(Packet.Packet.Byte());                      // get corrected bytes into the OGN packet
+    if(Check && ChaseFlips)                                    // if failed: try flipping the least reliable bits
+      Check=Decoder.Chase(Packet.Packet.Byte(), ChaseFlips);
     RxErr += ErrCount(Packet.Packet.Byte());
     if(RxErr>15) RxErr=15;
     Packet.RxErr  = RxErr;
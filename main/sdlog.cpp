@@ -20,34 +20,59 @@
 static char  LogFileName[32];
 static FILE *LogFile = 0;
 
-static   uint16_t  LogDate = 0;                                   // [~days] date = FatTime>>16
-static TickType_t  LogOpenTime;                                   // [msec] when was the log file (re)open
-static const TickType_t LogReopen = 30000;                        // [msec] when to close and re-open the log file
+static TickType_t  LogSyncTime;                                   // [msec] when was the log file last synced to the SD
+static const TickType_t LogSyncPeriod = 30000;                    // [msec] how often to sync the log file to the SD
+static const TickType_t LogFlushTime  =  2000;                    // [msec] how long bytes may wait in a partly filled sector
+static const TickType_t LogStallTime  =   100;                    // [msec] an SD write longer than this counts as a stall
 
 const size_t FIFOsize = 16384;
-static FIFO<char, FIFOsize> Log_FIFO;                             // 16K buffer for SD-log
+static SPSC_FIFO<char, FIFOsize> Log_FIFO;                            // 16K buffer for SD-log: filled by the producers while the SD task writes out LogSector
        SemaphoreHandle_t Log_Mutex;                               // Mutex for the FIFO to prevent mixing between threads
 
-void Log_Write(char Byte)                                         // write a byte into the log file buffer (FIFO)
-{ if(Log_FIFO.Write(Byte)>0) return;                              // if byte written into FIFO return
-  while(Log_FIFO.Write(Byte)<=0) vTaskDelay(1); }                 // wait while the FIFO is full - we have to use vTaskDelay not TaskYIELD
+const size_t LogSectorSize = 4096;                                // the SD gets whole 4KB writes aligned to 4KB in the file
+static char       LogSector[LogSectorSize] __attribute__((aligned(4))); // bytes taken from Log_FIFO, waiting for the write
+static size_t     LogStaged = 0;                                  // [bytes] in LogSector
+static TickType_t LogStageTime;                                   // [msec] when the first byte came into LogSector
+static uint32_t   LogFilePos = 0;                                 // [bytes] log file size: where the next write goes
+
+uint32_t Log_Dropped = 0;                                         // [bytes] refused because the FIFO was full
+uint32_t Log_Stalls  = 0;                                         // number of SD writes longer than LogStallTime
+uint16_t Log_MaxWrite = 0;                                        // [msec] longest SD write
+
+void Log_Write(char Byte)                                         // write a byte into the log file buffer (FIFO): under Log_Mutex
+{ if(Log_FIFO.Write(Byte)==0) Log_Dropped++; }                    // never wait for the SD: drop and count when full
+
+int Log_Append(const char *Data, int Len, bool CRNL)              // write a whole line or nothing, never wait for the SD
+{ int Total = CRNL ? Len+2:Len;
+  int Done = 0;
+  xSemaphoreTake(Log_Mutex, portMAX_DELAY);
+  if(Log_FIFO.Free()>=(size_t)Total)
+  { Done=Log_FIFO.Write(Data, Len);
+    if(CRNL) { Log_FIFO.Write('\r'); Log_FIFO.Write('\n'); Done+=2; }
+  } else Log_Dropped+=Total;
+  xSemaphoreGive(Log_Mutex);
+  return Done; }
 
 int Log_Free(void) { return Log_FIFO.Free(); }                    // how much space left in the buffer
 
-static int Log_Open(void)
+size_t Log_Full(void)      { return Log_FIFO.Full(); }
+size_t Log_HighWater(void) { return Log_FIFO.HighWater.load(std::memory_order_relaxed); }
+
+static void Log_FileName(char *Name)                              // log file name for today: TRyymmdd.LOG
 { int32_t Day   =  GPS_DateTime.Day;                                 // get day, month, year
   int32_t Month =  GPS_DateTime.Month;
   int32_t Year  =  GPS_DateTime.Year;
   uint32_t Date = 0;
   if(Year>=20 && Year<70) Date = Year*10000 + Month*100 + Day;    // create YYMMDD number for easy printout and sort
-  strcpy(LogFileName, "/sdcard/CONS/TR000000.LOG");
-  Format_UnsDec(LogFileName+15, Date, 6);                         // format the date into the log file name
+  strcpy(Name, "/sdcard/CONS/TR000000.LOG");
+  Format_UnsDec(Name+15, Date, 6); }                              // format the date into the log file name
+
+static int Log_Open(void)
+{ Log_FileName(LogFileName);
 #ifdef DEBUG_PRINT
   xSemaphoreTake(CONS_Mutex, portMAX_DELAY);
   Format_String(CONS_UART_Write, "Log_Open() ");
   Format_String(CONS_UART_Write, LogFileName);
-  Format_String(CONS_UART_Write, " Year:");
-  Format_SignDec(CONS_UART_Write, Year);
   Format_String(CONS_UART_Write, "\n");
   xSemaphoreGive(CONS_Mutex);
 #endif
@@ -55,18 +80,25 @@ static int Log_Open(void)
   if(LogFile==0)                                                  // if this fails
   { if(mkdir("/sdcard/CONS", 0777)<0) return -1;                  // try to create the sub-directory
     LogFile = fopen(LogFileName, "at"); if(LogFile==0) return -1; } // and again attempt to open the log file
-  LogOpenTime=xTaskGetTickCount();
+  setvbuf(LogFile, 0, _IONBF, 0);                                 // no stdio buffer: LogSector goes to the SD in one piece
+  fseek(LogFile, 0, SEEK_END); LogFilePos=ftell(LogFile);         // where the appended data starts: to align the writes
+  LogSyncTime=xTaskGetTickCount();
   return 0; }
 
-                                                                  // TaskYIELD would not give time to lower priority task like log-writer
-static void Log_Check(void)                                       // time check:
-{ if(!LogFile) return;                                            // if last operation in error then don't do anything
-  TickType_t TimeSinceOpen = xTaskGetTickCount()-LogOpenTime;     // when did we (re)open the log file last time
-  if(LogDate)
-  { if(TimeSinceOpen<LogReopen) return; }                         // if fresh (less than 30 seconds) then nothing to do
-  else
-  { if(TimeSinceOpen<(LogReopen/4)) return; }
-  fclose(LogFile); LogFile=0;                                     // close and reopen the log file when older than 10 seconds
+static int Log_Flush(void)                                        // write the staged bytes to the SD
+{ if(LogStaged==0) return 0;
+  TickType_t Start=xTaskGetTickCount();
+  size_t Write=fwrite(LogSector, 1, LogStaged, LogFile);
+  TickType_t Time=xTaskGetTickCount()-Start;                      // how long did the SD keep us
+  if(Time>Log_MaxWrite) Log_MaxWrite=Time;
+  if(Time>=LogStallTime) Log_Stalls++;
+  size_t Len=LogStaged; LogStaged=0;
+  if(Write!=Len) { fclose(LogFile); LogFile=0; return -1; }
+  LogFilePos+=Write; return Write; }
+
+static void Log_Close(void)                                       // write what is staged, close and time-stamp the log file
+{ Log_Flush(); if(!LogFile) return;
+  fclose(LogFile); LogFile=0;
   uint32_t Time = TimeSync_Time();
   struct stat LogStat;
   struct utimbuf LogTime;
@@ -76,15 +108,31 @@ static void Log_Check(void)                                       // time check:
     utime(LogFileName, &LogTime); }
 }
 
-static int WriteLog(size_t MaxBlock=FIFOsize/2)                    // process the queue of lines to be written to the log
+static void Log_Check(void)                                       // time check:
+{ if(!LogFile) return;                                            // if last operation in error then don't do anything
+  char Name[32]; Log_FileName(Name);
+  if(strcmp(Name, LogFileName)) { Log_Close(); return; }          // date known or changed: the main loop opens the new file
+  TickType_t Now=xTaskGetTickCount();
+  if(Now-LogSyncTime<LogSyncPeriod) return;                       // if synced less than 30 seconds ago then nothing to do
+  if(Log_Flush()<0) return;
+  fflush(LogFile); fsync(fileno(LogFile));                        // commit data and directory entry without a close/reopen
+  LogSyncTime=Now; }
+
+static int WriteLog(void)                                         // move the queue of lines to be written to the log into sectors
 { if(!LogFile) return 0;
   int Count=0;
   for( ; ; )
   { char *Block; size_t Len=Log_FIFO.getReadBlock(Block); if(Len==0) break;
-    if(Len>MaxBlock) Len/=2;
-    int Write=fwrite(Block, 1, Len, LogFile);
-    Log_FIFO.flushReadBlock(Len);
-    if(Write!=Len) { fclose(LogFile); LogFile=0; return -1; }
+    size_t Target = LogSectorSize - LogFilePos%LogSectorSize;     // stage up to the next sector boundary in the file
+    if(LogStaged==0) LogStageTime=xTaskGetTickCount();
+    if(Len>Target-LogStaged) Len=Target-LogStaged;
+    memcpy(LogSector+LogStaged, Block, Len);
+    Log_FIFO.flushReadBlock(Len); LogStaged+=Len;
+    if(LogStaged<Target) continue;
+    int Write=Log_Flush(); if(Write<0) return -1;                 // full sector: write it
+    Count+=Write; }
+  if(LogStaged && xTaskGetTickCount()-LogStageTime>=LogFlushTime) // a partial sector waits at most LogFlushTime
+  { int Write=Log_Flush(); if(Write<0) return -1;
     Count+=Write; }
   return Count; }
 
@@ -107,7 +155,7 @@ static SHA256 IGC_SHA256, IGC_SHA256_bck;                         //
 const int IGC_Digest_Size = 32;
 static uint8_t IGC_Digest[IGC_Digest_Size];                       //
 
-FIFO<OGN_RxPacket<OGN_Packet>, 32> IGClog_FIFO;
+SPSC_FIFO<OGN_RxPacket<OGN_Packet>, 32> IGClog_FIFO;
 
 static void IGC_TimeStamp(void)
 { struct stat FileStat;
@@ -512,9 +560,8 @@ extern "C"
       if(!LogFile) { IGC_CheckGPS(); SD_Unmount(); vTaskDelay(1000); continue; }  // if can't be open then unmount the SD and retry at a delay of 1sec
     }
 
-    if(Log_FIFO.Full()<FIFOsize/4) { IGC_CheckGPS(); vTaskDelay(50); }  // if little data to copy, then wait 0.1sec for more data
-    int Write;
-    do { Write=WriteLog(); } while(Write>0);                         // write the console output to the log file
+    if(Log_FIFO.Full()<LogSectorSize) { IGC_CheckGPS(); vTaskDelay(50); } // if less than a sector to copy, then wait 0.05sec for more data
+    int Write=WriteLog();                                            // write the console output to the log file
     if(Write<0) { SD_Unmount(); vTaskDelay(1000); continue; }        // if write fails then unmount the SD card and (re)try after a delay of 1sec
     // if(Write==0) vTaskDelay(100);
     IGC_CheckGPS();
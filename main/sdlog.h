@@ -7,11 +7,18 @@
 
 #include "igc-key.h"
 
-void Log_Write(char Byte);
-int  Log_Free(void);
+void   Log_Write(char Byte);                                     // single byte, caller holds Log_Mutex: for Format_...() and WritePFLA()
+int    Log_Append(const char *Data, int Len, bool CRNL=0);        // whole line or nothing, takes Log_Mutex, never waits for the SD
+int    Log_Free(void);
+size_t Log_Full(void);
+size_t Log_HighWater(void);                                       // [bytes] most ever waiting in the FIFO
 extern SemaphoreHandle_t Log_Mutex;
 
-extern FIFO<OGN_RxPacket<OGN_Packet>, 32> IGClog_FIFO;
+extern uint32_t Log_Dropped;                                      // [bytes] refused because the FIFO was full
+extern uint32_t Log_Stalls;                                       // number of SD writes longer than 100ms
+extern uint16_t Log_MaxWrite;                                     // [msec] longest SD write
+
+extern SPSC_FIFO<OGN_RxPacket<OGN_Packet>, 32> IGClog_FIFO;
 
 extern IGC_Key IGC_SignKey;
 
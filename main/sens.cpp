@@ -38,11 +38,15 @@
 #endif
 
 #include "atmosphere.h"
+#include "vertical.h"
+#include "decimate.h"
 #include "slope.h"
 #include "lowpass2.h"
 #include "intmath.h"
 
-#include "fifo.h"
+#ifdef WITH_BMX055
+#include "imu.h"
+#endif
 
 // static const uint8_t  VarioVolume     =    2; // [0..3]
 static const uint16_t VarioBasePeriod = 800;  // [ms]
@@ -87,26 +91,97 @@ void VarioSound(int32_t ClimbRate)
        MS5611   Baro;                       // MS5611 barometer sensor
 #endif
 
-static uint32_t AverPress;                  // [ Pa] summed Pressure over several readouts
-static uint8_t  AverCount;                  // [int] number of summed Pressure readouts
+static VerticalKalman Vario;                // altitude, climb rate and accelerometer bias from every baro reading
+static TickType_t     VarioTick;            // [ms] time of the last reading
+
+static void VarioInput(int32_t Pressure, TickType_t Tick) // [0.25 Pa] one baro reading taken at Tick
+{ float Altitude = 0.001f*Atmosphere::StdAltitude_mm(Pressure<<2);  // [m] standard pressure altitude
+  TickType_t Time = Tick-VarioTick; VarioTick=Tick;                  // [ms] since the previous reading
+  if(!Vario.Valid || Time>5000) { Vario.Clear(Altitude); return; }  // (re)start after a gap
+#ifdef WITH_BMX055
+  float Acc;
+  if(IMU_getVertAcc(Acc)) Vario.Predict(0.001f*Time, Acc);          // with the mean vertical acceleration since the previous reading
+                     else Vario.Predict(0.001f*Time);
+#else
+  Vario.Predict(0.001f*Time);
+#endif
+  Vario.BaroUpdate(Altitude); }
+
+static char Line[96];                       // line to prepare the barometer NMEA sentence
 
-static SlopePipe<int32_t>        BaroPipe;  // 4-point slope-fit pipe for pressure
+static const uint16_t SamplePeriod = 40;    // [ms] continuous sampling: one conversion per period, 25Hz
+static LineDecimator<int32_t, 32> BaroRing; // [0.25 Pa] readings of the last second with their [ms] times
+static SlopePipe<int32_t>        BaroPipe;  // 4-point slope-fit pipe for the 2Hz pressures: the $POGNB noise
 static LowPass2<int32_t,6,4,8>   BaroNoise; // low pass (average) filter for pressure noise
+static uint8_t    BaroConv;                 // conversion started in the previous period: 0=none, 1=pressure, 2=temperature
+static uint8_t    BaroCount;                // counts the periods: temperature once a second
+static TickType_t BaroTrigTick;             // [ms] when that conversion started
 
-static LowPass2<int64_t,10,9,12> PressAver, // low pass (average) filter for pressure
-                                 AltAver;   // low pass (average) filter for GPS altitude
+#ifdef WITH_BMP180
+static const uint8_t BaroConvTime = 26;     // [ms] pressure conversion at OSS=3
+
+static int8_t BaroSample(int32_t &Pressure, TickType_t &Tick) // read the conversion started in the previous period and start the next one
+{ int8_t Ret=0;                                                 // 1 = new reading: Pressure [0.25 Pa] taken at Tick, -1 = I2C error
+  if(BaroConv==1)
+  { if(Baro.ReadRawPressure()) return -1;
+    Baro.CalcPressure(); Pressure=Baro.Pressure<<2; Tick=BaroTrigTick+BaroConvTime/2; Ret=1; }
+  else if(BaroConv==2)
+  { if(Baro.ReadRawTemperature()) return -1;
+    Baro.CalcTemperature(); }
+  BaroCount++; if(BaroCount>=1000/SamplePeriod) BaroCount=0;
+  uint8_t Err = BaroCount ? Baro.TrigRawPressure():Baro.TriggRawTemperature();
+  if(Err) return -1;
+  BaroConv = BaroCount ? 1:2; BaroTrigTick=xTaskGetTickCount();
+  return Ret; }
+#endif
 
-static Delay<int32_t, 8>        PressDelay; // 4-second delay for long-term climb rate
+#if defined(WITH_MS5607) || defined(WITH_MS5611)
+static const uint8_t BaroConvTime = 9;      // [ms] conversion at OSR=4096
+
+static int8_t BaroSample(int32_t &Pressure, TickType_t &Tick)
+{ int8_t Ret=0;
+  if(BaroConv==1)
+  { if(Baro.ReadADC(Baro.RawPress)) return -1;
+    Baro.Calculate(); Pressure=Baro.Pressure; Tick=BaroTrigTick+BaroConvTime/2; Ret=1; } // with the last temperature
+  else if(BaroConv==2)
+  { if(Baro.ReadADC(Baro.RawTemp)) return -1; }
+  BaroCount++; if(BaroCount>=1000/SamplePeriod) BaroCount=0;
+  uint8_t Err = BaroCount ? Baro.TrigRawPress():Baro.TrigRawTemp();
+  if(Err) return -1;
+  BaroConv = BaroCount ? 1:2; BaroTrigTick=xTaskGetTickCount();
+  return Ret; }
+#endif
 
-static char Line[96];                       // line to prepare the barometer NMEA sentence
+#if defined(WITH_BMP280) || defined(WITH_BME280)
+static const uint8_t BaroConvTime = 23;     // [ms] temperature and pressure at BMP280::CTRL_FAST
+
+static int8_t BaroSample(int32_t &Pressure, TickType_t &Tick)
+{ static uint8_t Busy=0;                                         // periods the conversion has not been done
+  int8_t Ret=0;
+  if(BaroConv)
+  { bool Ready=0; if(Baro.ReadStatus(Ready)) return -1;
+    if(!Ready)                                                    // not done yet: read it in the next period
+    { if(++Busy<3) return 0;
+      Busy=0; return -1; }                                        // but a sensor stuck busy is an error like the I2C ones
+    Busy=0;
+    if(Baro.ReadRawTemp() || Baro.ReadRawPress()) return -1;
+#ifdef WITH_BME280
+    if(Baro.hasHumidity() && Baro.ReadRawHum()) return -1;
+#endif
+    Baro.Calculate(); Pressure=Baro.Pressure; Tick=BaroTrigTick+BaroConvTime/2; Ret=1; }
+  if(Baro.Trigger(BMP280::CTRL_FAST)) return -1;                  // temperature comes with every conversion
+  BaroConv=1; BaroTrigTick=xTaskGetTickCount();
+  return Ret; }
+#endif
 
 static uint8_t InitBaro(void)
 { Baro.Bus=BARO_I2C;
+  BaroConv=0; BaroCount=0; BaroRing.Clear();
   uint8_t Err=Baro.CheckID();
   if(Err==0) Err=Baro.ReadCalib();
 #ifdef WITH_BMP180
   if(Err==0) Err=Baro.AcquireRawTemperature();
-  if(Err==0) { Baro.CalcTemperature(); AverPress=0; AverCount=0; }
+  if(Err==0) { Baro.CalcTemperature(); }
 #endif
 #if defined(WITH_BMP280) || defined(WITH_MS5607) || defined(WITH_BME280) || defined(WITH_MS5611)
   if(Err==0) Err=Baro.Acquire();
@@ -115,91 +190,72 @@ static uint8_t InitBaro(void)
   // if(Err) LED_BAT_On();
   return Err==0 ? Baro.ADDR:0; }
 
-static void ProcBaro(void)
+static void ProcBaro(void)                                           // one sampling period, the outputs every half second
 {
-    static uint8_t PipeCount=0;
-
-    int16_t Sec  = 10*(TimeSync_Time()%60);                               // [0.1sec]
-    uint16_t Phase = TimeSync_msTime();                                   // sync to the GPS PPS
-    if(Phase>=500) { Sec+=10; vTaskDelay(1000-Phase); }                   // wait till start of the measuring period
-              else { Sec+= 5; vTaskDelay( 500-Phase); }
-    if(Sec>=600) Sec-=600;                                                // [0.1sec] pressure measurement time
-
-#ifdef WITH_BMP180
-    TickType_t Start=xTaskGetTickCount();
-    uint8_t Err=Baro.AcquireRawTemperature();                             // measure temperature
-    if(Err==0) { Baro.CalcTemperature(); AverPress=0; AverCount=0; }      // clear the average
-          else { PipeCount=0;
-	         I2C_Restart(Baro.Bus);
-                 vTaskDelay(20);
-                 InitBaro(); // try to recover I2C bus and baro
-		 return; }
-
-    TickType_t End=Start;
-    for(uint8_t Idx=0; Idx<16; Idx++)
-    { uint8_t Err=Baro.AcquireRawPressure();                              // take pressure measurement
-      if(Err==0) { Baro.CalcPressure(); AverPress+=Baro.Pressure; AverCount++; } // sum-up average pressure
-      End=xTaskGetTickCount();
-      TickType_t Time = End-Start; if(Time>=200) break; }                   // but no longer than 250ms to fit into 0.5 second slot
-    TickType_t MeasTick = Start + (End-Start)/2;
-    if(AverCount==0) { PipeCount=0; return ; }                              // and we summed-up some measurements
-    AverPress = ( (AverPress<<2) + (AverCount>>1) )/AverCount;              // [0.25Pa]] make the average
+    static TickType_t Next=0;                                         // [ms] start of the next period
+    static uint8_t    Half=0xFF;                                      // the half of the second processed last
+
+    TickType_t Now=xTaskGetTickCount();
+    TickType_t Wait=Next-Now;
+    if(Wait>0 && Wait<=SamplePeriod) { vTaskDelay(Wait); Now=Next; } // sleep till the period starts, no busy-wait
+    Next=Now+SamplePeriod;                                            // or start again after a stall
+
+    int32_t Pressure=0; TickType_t Tick=Now;
+    static uint8_t    PipeCount=0;                                    // 2Hz pressures in BaroPipe since the last gap
+
+    int8_t Ret=BaroSample(Pressure, Tick);
+    if(Ret<0)                                                         // I2C error, whichever the sensor: start the sampling again
+    { BaroConv=0; BaroRing.Clear(); Vario.Valid=0; PipeCount=0;
+      I2C_Restart(Baro.Bus);
+      vTaskDelay(20);
+      if(InitBaro()==0) vTaskDelay(1000);                             // try to recover I2C bus and baro, retry once a second if gone
+      Next=xTaskGetTickCount()+SamplePeriod;
+      return; }
+    if(Ret>0)
+    { BaroRing.Input(Pressure, Tick);                                 // for the decimated pressure
+      VarioInput(Pressure, Tick); }                                   // every reading into the filter at its own time
+
+    uint32_t Time; TickType_t msTime;
+    TimeSync_Time(Time, msTime, Now);
+    uint8_t ThisHalf = msTime>=500;
+    if(ThisHalf==Half) return;                                        // the 2Hz outputs when a half second starts
+    Half=ThisHalf;
+    BaroRing.Fit(1000);                                               // FIR decimation: line over the last second at the newest reading
+    if(BaroRing.Used==0) return;
+    TickType_t MeasTick=BaroRing.getTime();
+    if(Now-MeasTick>=500) { PipeCount=0; return; }                    // no fresh readings
 #ifdef DEBUG_PRINT
     xSemaphoreTake(CONS_Mutex, portMAX_DELAY);
-    Format_String(CONS_UART_Write, "BMP180: ");
-    Format_UnsDec(CONS_UART_Write, (AverPress+2)/4, 3, 2);
-    Format_String(CONS_UART_Write, "hPa/");
-    Format_UnsDec(CONS_UART_Write, (uint16_t)AverCount);
-    Format_String(CONS_UART_Write, "\n");
+    Format_String(CONS_UART_Write, "ProcBaro: ");
+    Format_UnsDec(CONS_UART_Write, (uint16_t)BaroRing.Used);
+    Format_String(CONS_UART_Write, " readings, ");
+    Format_UnsDec(CONS_UART_Write, (uint32_t)(2.5f*BaroRing.OutNoise+0.5f), 2, 1);
+    Format_String(CONS_UART_Write, "Pa noise of the decimated pressure\n");
     xSemaphoreGive(CONS_Mutex);
 #endif
-#endif
-#if defined(WITH_BMP280) || defined(WITH_MS5607) || defined(WITH_BME280) || defined(WITH_MS5611)
-    TickType_t Start=xTaskGetTickCount();
-    uint8_t Err=Baro.Acquire();
-    TickType_t End=xTaskGetTickCount();
-    TickType_t MeasTick = Start + (End-Start)/2;
-    if(Err==0) { Baro.Calculate(); }
-          else { PipeCount=0; return; }
-    AverPress = Baro.Pressure;
-            Err=Baro.Acquire();
-    if(Err==0) { Baro.Calculate(); }
-          else { PipeCount=0; return; }
-    AverPress += Baro.Pressure;
-    AverPress/=2;                                                       // [0.25Pa]
-#endif
-    BaroPipe.Input(AverPress);                                          // [0.25Pa]
-    if(PipeCount<255) PipeCount++;                                      // count data going to the slope fitting pipe
-    if(PipeCount<4) return;
-
-    BaroPipe.FitSlope();                                             // fit the average and slope from the four most recent pressure points
-    int32_t PLR = Atmosphere::PressureLapseRate(((AverPress+2)>>2), Baro.Temperature); // [0.0001m/Pa]
-    int32_t ClimbRate = (BaroPipe.Slope*PLR)/800;                    // [1/16Pa/0.5sec] * [0.0001m/Pa] x 800 => [0.01m/sec]
-
-    BaroPipe.CalcNoise();                                            // calculate the noise (average square residue)
-    uint32_t Noise=BaroNoise.Process(BaroPipe.Noise);                // pass the noise through the low pass filter
-             Noise=(IntSqrt(25*Noise)+64)>>7;                        // [0.1 Pa] noise (RMS) measured on the pressure
-
-    int32_t Pressure=BaroPipe.Aver;                                  // [1/16Pa]
-    // int32_t StdAltitude = Atmosphere::StdAltitude((Pressure+8)>>4);  // [0.1 m]
-    int32_t StdAltitude = floorf(BaroAlt((1.0f/16)*Pressure)*10+0.5);
-    int32_t ClimbRate4sec = ((Pressure-PressDelay.Input(Pressure))*PLR)/3200; // [0.01m/sec] climb rate over 4 sec.
+
+    if( (ThisHalf==0) && GPS_TimeSinceLock )                          // at the full second
+      Vario.GPSUpdate(0.1f*GPS_Altitude);                            // [m] the GPS altitude: only the slow offset to the pressure altitude
+
+    int32_t StdAltitude = Vario.getStdAltitude();                    // [0.1 m]
+    int32_t Altitude    = Vario.hasGeo() ? Vario.getAltitude():StdAltitude; // [0.1 m] follows the GPS altitude in the long run
+    int32_t ClimbRate   = Vario.getClimbRate();                      // [0.01m/sec]
+            Pressure    = (int32_t)floorf(BaroRing.Out+0.5f);        // [0.25 Pa] decimated pressure
+    BaroPipe.Input(Pressure);                                        // [0.25Pa]
+    if(PipeCount<255) PipeCount++;                                   // count data going to the slope fitting pipe
+    uint32_t Noise      = BaroNoise.Out;
+    if(PipeCount>=4)
+    { BaroPipe.FitSlope();                                           // fit the average and slope from the four most recent pressure points
+      BaroPipe.CalcNoise();                                          // calculate the noise (average square residue)
+      Noise=BaroNoise.Process(BaroPipe.Noise); }                     // pass the noise through the low pass filter
+             Noise      = (IntSqrt(25*Noise)+64)>>7;                 // [0.1 Pa] noise (RMS) of the 2Hz pressures, as $POGNB always had it
 #ifdef WITH_VARIO
     VarioSound(ClimbRate);
-    // if(abs(ClimbRate4sec)>50) VarioSound(ClimbRate);
-    //                      else VarioSound(2*ClimbRate4sec);
 #endif
-    Pressure = (Pressure+2)>>2;                                      // [0.25 Pa]
-    if( (Phase>=500) && GPS_TimeSinceLock )
-    { PressAver.Process(Pressure);                                   // [0.25 Pa] pass pressure through low pass filter
-      AltAver.Process(GPS_Altitude);                                 // [0.1 m] pass GPS altitude through same low pass filter
-    }
-    int32_t PressDiff=Pressure-((PressAver.Out+2048)>>12);           // [0.25 Pa] pressure - <pressure>
-    int32_t AltDiff = (PressDiff*(PLR>>4))/250;                      // [0.1 m]
-    int32_t Altitude=((AltAver.Out+2048)>>12)+AltDiff;               // [0.1 m]
 
-    uint32_t   Time = TimeSync_Time(MeasTick);              // effective time of the pressure measurement
-    uint16_t msTime = TimeSync_msTime(MeasTick);
+    TimeSync_Time(Time, msTime, MeasTick);                           // effective time of the pressure measurement
+    int16_t Sec = 10*(Time%60) + (msTime+250)/500*5;                 // [0.1sec] to the nearest half second
+    if(Sec>=600) Sec-=600;
 
     uint8_t Frac = Sec%10;                                           // [0.1s]
     // if(Frac==0)
@@ -264,10 +320,7 @@ static void ProcBaro(void)
       Format_String(CONS_UART_Write, Line, 0, Len);                       // send NMEA sentence to the console (UART1)
       xSemaphoreGive(CONS_Mutex); }
 #ifdef WITH_SDLOG
-    if(Log_Free()>=128)
-    { xSemaphoreTake(Log_Mutex, portMAX_DELAY);
-      Format_String(Log_Write, Line, 0, Len);                             // send NMEA sentence to the log file
-      xSemaphoreGive(Log_Mutex); }
+    Log_Append(Line, Len);                                                // send NMEA sentence to the log file
 #endif
 
     Len=0;                                                           // start preparing the PGRMZ NMEA sentence
@@ -283,10 +336,7 @@ static void ProcBaro(void)
       Format_String(CONS_UART_Write, Line, 0, Len);                           // send NMEA sentence to the console (UART1)
       xSemaphoreGive(CONS_Mutex); }
 #ifdef WITH_SDLOG
-    if(Log_Free()>=128)
-    { xSemaphoreTake(Log_Mutex, portMAX_DELAY);
-      Format_String(Log_Write, Line, 0, Len);                             // send NMEA sentence to the log file
-      xSemaphoreGive(Log_Mutex); }
+    Log_Append(Line, Len);                                                // send NMEA sentence to the log file
 #endif
 
     Len=0;
@@ -307,10 +357,7 @@ static void ProcBaro(void)
       Format_String(CONS_UART_Write, Line, 0, Len);                           // send NMEA sentence to the console (UART1)
       xSemaphoreGive(CONS_Mutex); }
 #ifdef WITH_SDLOG
-    if(Log_Free()>=128)
-    { xSemaphoreTake(Log_Mutex, portMAX_DELAY);
-      Format_String(Log_Write, Line, 0, Len);                             // send NMEA sentence to the log file
-      xSemaphoreGive(Log_Mutex); }
+    Log_Append(Line, Len);                                                // send NMEA sentence to the log file
 #endif
 
 }
@@ -328,14 +375,11 @@ void vTaskSENS(void* pvParameters)
 // #endif
 
 #if defined(WITH_BMP180) || defined(WITH_BMP280) || defined(WITH_MS5607) || defined(WITH_BME280) || defined(WITH_MS5611)
+#ifdef WITH_BMP180
+  Vario.BaroVar=0.25f;                 // [m^2] single BMP180 conversions are noisier
+#endif
   BaroPipe.Clear  (4*90000);
   BaroNoise.Set(12*16);                // guess the pressure noise level
-
-                                       // initialize the GPS<->Baro correlator
-  AltAver.Set(0);                      // [m] Altitude at sea level
-  PressAver.Set(4*101300);             // [Pa] Pressure at sea level
-  PressDelay.Clear(4*101300);
-
   uint8_t Detected = InitBaro();
 #endif
 
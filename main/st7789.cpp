@@ -250,97 +250,212 @@ static void lcd_start(const uint8_t *cmd) // reset controller and send initial c
 
 // =============================================================================
 
-// const int LCD_BUFF_SIZE = 12*320;
-DRAM_ATTR static uint16_t lcd_buffer[LCD_BUFF_SIZE];
-static int      lcd_buffer_filled = 0;                 // buffer is prefilled up to this size with a fixed RGB565
+// Two DMA buffers, each with its own set of six SPI transactions: the CPU renders into one buffer
+// while the SPI sends the other one. The buffers are taken in turn, thus the one to be rendered next
+// is either free or the older of the two sets in the SPI queue, whose results come back first.
 
-static void lcd_buffer_fill(int size, uint16_t RGB565) // fill the buffer with given RGB565 up to the desired size
-{ if(lcd_buffer[0]!=RGB565) lcd_buffer_filled=0;       // if filled with a different RGB565 then assume not filled
-  if(lcd_buffer_filled>=size) return;                  // if filled up to the desired size then we are done
-  for(int x=lcd_buffer_filled; x<size; x++)            // fill up to the desired size
-  { lcd_buffer[x]=RGB565; }
-  lcd_buffer_filled=size; }                            // mark as filled till the requested size
+// const int LCD_BUFF_SIZE = 6*320;
+DRAM_ATTR static uint16_t lcd_buffer[2][LCD_BUFF_SIZE];
+static int      lcd_buffer_filled[2] = { 0, 0 };       // buffer is prefilled up to this size with a fixed RGB565
+static uint8_t  lcd_buffer_next = 0;                   // the buffer to be rendered next
 
-static spi_transaction_t lcd_trans[6];                 // six SPI transactions to transfer pixel data
-static bool lcd_transaction_active = 0;                // initially not active
+static spi_transaction_t lcd_trans[2][6];              // six SPI transactions to transfer pixel data, for each buffer
+static bool lcd_transaction_active[2] = { 0, 0 };      // initially not active
 
 static void lcd_trans_init(void)                       // initial setup of the transactions
-{ for (int x=0; x<6; x++)
-  { memset(&lcd_trans[x], 0, sizeof(spi_transaction_t));
-    if ((x&1)==0)                                      // Even transfers are commands
-    { lcd_trans[x].length = 8;                         // 8-bit = single byte command
-      lcd_trans[x].user=(void*)0; }                    // D/C = LOW for command
-    else                                               // Odd transfers are data
-    { lcd_trans[x].length = 8*4;                       // 4 byte = arguments (except for the last transaction)
-      lcd_trans[x].user=(void*)1; }                    // D/C = HIGH for data
-    lcd_trans[x].flags=SPI_TRANS_USE_TXDATA; }
-  lcd_transaction_active=0; }
-
-static void lcd_trans_wait(void)                       // wait for the six SPI transaction to complete
-{ if(!lcd_transaction_active) return;
+{ for (int b=0; b<2; b++)
+  { for (int x=0; x<6; x++)
+    { spi_transaction_t *Trans = &lcd_trans[b][x];
+      memset(Trans, 0, sizeof(spi_transaction_t));
+      if ((x&1)==0)                                    // Even transfers are commands
+      { Trans->length = 8;                             // 8-bit = single byte command
+        Trans->user=(void*)0; }                        // D/C = LOW for command
+      else                                             // Odd transfers are data
+      { Trans->length = 8*4;                           // 4 byte = arguments (except for the last transaction)
+        Trans->user=(void*)1; }                        // D/C = HIGH for data
+      Trans->flags=SPI_TRANS_USE_TXDATA; }
+    lcd_transaction_active[b]=0; lcd_buffer_filled[b]=0; }
+  lcd_buffer_next=0; }
+
+static void lcd_trans_wait(uint8_t b)                  // wait for the six SPI transaction of the given buffer to complete
+{ if(!lcd_transaction_active[b]) return;
   spi_transaction_t *rtrans;
   for (int x=0; x<6; x++)
   { esp_err_t ret=spi_device_get_trans_result(LCD_SPI, &rtrans, portMAX_DELAY); }
-  lcd_transaction_active=0; }
+  lcd_transaction_active[b]=0; }
 
-static void lcd_trans_start(void)                      // start the six SPI transactions to write data to given X/Y
-{ if(lcd_transaction_active) lcd_trans_wait();         // if previous transaction set not finished, then wait for them
+static void lcd_trans_flush(void)                      // wait for both buffers: the older set first
+{ lcd_trans_wait(lcd_buffer_next); lcd_trans_wait(lcd_buffer_next^1); }
+
+static uint16_t *lcd_buffer_get(void)                  // the buffer to render into: wait until the SPI is done with it
+{ lcd_trans_wait(lcd_buffer_next);
+  return lcd_buffer[lcd_buffer_next]; }
+
+static void lcd_buffer_fill(int size, uint16_t RGB565) // fill the next buffer with given RGB565 up to the desired size
+{ uint16_t *Buffer = lcd_buffer_get();
+  int &Filled = lcd_buffer_filled[lcd_buffer_next];
+  if(Buffer[0]!=RGB565) Filled=0;                      // if filled with a different RGB565 then assume not filled
+  if(Filled>=size) return;                             // if filled up to the desired size then we are done
+  for(int x=Filled; x<size; x++)                       // fill up to the desired size
+  { Buffer[x]=RGB565; }
+  Filled=size; }                                       // mark as filled till the requested size
+
+LCD_Stat LCD_Stats;                                    // frame time and bytes per frame
+
+static const int lcd_trans_overhead = 11;              // [bytes] commands and addresses before the pixel data
+
+static void lcd_trans_start(void)                      // start the six SPI transactions of the next buffer, swap the buffers
+{ uint8_t b = lcd_buffer_next;
   for (int x=0; x<6; x++)                              // start the six SPI transactions
-  { esp_err_t ret=spi_device_queue_trans(LCD_SPI, &lcd_trans[x], portMAX_DELAY); }
-  lcd_transaction_active=1; }                          // mark the transactions as beig active
+  { esp_err_t ret=spi_device_queue_trans(LCD_SPI, &lcd_trans[b][x], portMAX_DELAY); }
+  lcd_transaction_active[b]=1;                         // mark the transactions as beig active
+  LCD_Stats.Bytes += lcd_trans[b][5].length/8 + lcd_trans_overhead;
+  lcd_buffer_next = b^1; }                             // the other buffer is rendered while this one is sent
 
 // positions here must fit into the screen, there is no check and no correction if they don't fit
-static void lcd_trans_setup(int xpos, int ypos, int xsize, int ysize, uint16_t *data)
+static void lcd_trans_setup(int xpos, int ypos, int xsize, int ysize, uint16_t *data) // for the next buffer
 {
 #ifdef LCD_FLIP
   xpos+=LCD_XOFS;
 #endif
-  if(lcd_transaction_active) lcd_trans_wait();         // if previous transaction set not finished, then wait for them
-  lcd_trans[0].tx_data[0] = 0x2A;                      // Column Address Set
-  lcd_trans[1].tx_data[0] = xpos>>8;                   // Start Col MSB
-  lcd_trans[1].tx_data[1] = xpos&0xFF;                 // Start Col LSB
+  spi_transaction_t *Trans = lcd_trans[lcd_buffer_next];
+  lcd_trans_wait(lcd_buffer_next);                     // if previous transaction set not finished, then wait for them
+  Trans[0].tx_data[0] = 0x2A;                          // Column Address Set
+  Trans[1].tx_data[0] = xpos>>8;                       // Start Col MSB
+  Trans[1].tx_data[1] = xpos&0xFF;                     // Start Col LSB
   xpos += xsize-1;
-  lcd_trans[1].tx_data[2] = xpos>>8;                   // End Col MSB
-  lcd_trans[1].tx_data[3] = xpos&0xFF;                 // End Col LSB
-  lcd_trans[2].tx_data[0] = 0x2B;                      // Page address set
-  lcd_trans[3].tx_data[0] = ypos>>8;                   // Start page MSB
-  lcd_trans[3].tx_data[1] = ypos&0xFF;                 // start page LSB
+  Trans[1].tx_data[2] = xpos>>8;                       // End Col MSB
+  Trans[1].tx_data[3] = xpos&0xFF;                     // End Col LSB
+  Trans[2].tx_data[0] = 0x2B;                          // Page address set
+  Trans[3].tx_data[0] = ypos>>8;                       // Start page MSB
+  Trans[3].tx_data[1] = ypos&0xFF;                     // start page LSB
   ypos += ysize-1;
-  lcd_trans[3].tx_data[2] = ypos>>8;                   // end page MSB
-  lcd_trans[3].tx_data[3] = ypos&0xFF;                 // end page LSB
-  lcd_trans[4].tx_data[0] = 0x2C;                      // memory write
-  lcd_trans[5].tx_buffer = data;                       // finally send the line data
-  lcd_trans[5].length = xsize*ysize*2*8;               // Data length, in bits
-  lcd_trans[5].rxlength = 0;                           // need to set this, otherwise a previous value is taken and an error occurs
-  lcd_trans[5].flags=0; }                              // undo SPI_TRANS_USE_TXDATA flag
+  Trans[3].tx_data[2] = ypos>>8;                       // end page MSB
+  Trans[3].tx_data[3] = ypos&0xFF;                     // end page LSB
+  Trans[4].tx_data[0] = 0x2C;                          // memory write
+  Trans[5].tx_buffer = data;                           // finally send the line data
+  Trans[5].length = xsize*ysize*2*8;                   // Data length, in bits
+  Trans[5].rxlength = 0;                               // need to set this, otherwise a previous value is taken and an error occurs
+  Trans[5].flags=0; }                                  // undo SPI_TRANS_USE_TXDATA flag
 
 // ================================================================================
+// Dirty-region tracker: the screen is cut into tiles and each tile remembers one opaque rectangle
+// (a character box or a filled box) starting in it, together with a signature of what was drawn there.
+// An opaque draw of the same rectangle with the same signature changes nothing on the screen, thus is not sent.
+// Any draw invalidates the remembered rectangles it overlaps.
 
-void LCD_DrawBox(int xpos, int ypos, int xsize, int ysize, uint16_t RGB565)
-{ if(xsize==0) return;
-  if(ysize==0) return;
-  if(xpos>=LCD_WIDTH) return;
-  if(ypos>=LCD_HEIGHT) return;
-  if((xpos+xsize)<=0) return;
-  if((ypos+ysize)<=0) return;
+static const int lcd_tile_cols  = 320/LCD_TILE_W;      // tiles across and down the screen: fits 240x240, 240x320 and 320x240
+static const int lcd_tile_rows  = 320/LCD_TILE_H;
+static const int lcd_cell_maxh  = 48;                  // [pixels] higher rectangles are not remembered
+
+class lcd_cell                                         // opaque rectangle drawn last time in a tile
+{ public:
+   uint8_t  Ofs;                                       // X (low nibble) and Y (high nibble) offset within the tile
+   uint8_t  xsize, ysize;                              // [pixels] zero size: no rectangle
+   uint32_t Sign;                                      // signature of the content
+} ;
+
+static lcd_cell lcd_tiles[lcd_tile_rows*lcd_tile_cols];
+
+static uint32_t lcd_sign(uint32_t Sign, uint32_t Data) // FNV-1a style mixing of the content description
+{ for(int Byte=0; Byte<4; Byte++)
+  { Sign^=Data&0xFF; Sign*=16777619; Data>>=8; }
+  return Sign; }
+
+static void lcd_tiles_clear(void)
+{ for(int Idx=0; Idx<lcd_tile_rows*lcd_tile_cols; Idx++) lcd_tiles[Idx].xsize=0; }
+
+static void lcd_tiles_dirty(int xpos, int ypos, int xsize, int ysize) // forget rectangles overlapping the area
+{ int Row0 = (ypos-lcd_cell_maxh)/LCD_TILE_H; if(Row0<0) Row0=0;
+  int Row1 = (ypos+ysize-1)/LCD_TILE_H; if(Row1>=lcd_tile_rows) Row1=lcd_tile_rows-1;
+  int Col0 = (xpos-255)/LCD_TILE_W; if(Col0<0) Col0=0;
+  int Col1 = (xpos+xsize-1)/LCD_TILE_W; if(Col1>=lcd_tile_cols) Col1=lcd_tile_cols-1;
+  for(int Row=Row0; Row<=Row1; Row++)
+  { lcd_cell *Cell = lcd_tiles+Row*lcd_tile_cols+Col0;
+    for(int Col=Col0; Col<=Col1; Col++, Cell++)
+    { if(Cell->xsize==0) continue;
+      int X = Col*LCD_TILE_W+(Cell->Ofs&0x0F), Y = Row*LCD_TILE_H+(Cell->Ofs>>4);
+      if(X>=xpos+xsize || X+Cell->xsize<=xpos) continue;
+      if(Y>=ypos+ysize || Y+Cell->ysize<=ypos) continue;
+      Cell->xsize=0; }
+  }
+}
+
+static bool lcd_tiles_check(int xpos, int ypos, int xsize, int ysize, uint32_t Sign) // 1 = already on the screen: skip the draw
+{ bool Fits = xsize<=255 && ysize<=lcd_cell_maxh;
+  lcd_cell *Cell = lcd_tiles + (ypos/LCD_TILE_H)*lcd_tile_cols + xpos/LCD_TILE_W;
+  uint8_t Ofs = (xpos%LCD_TILE_W) | ((ypos%LCD_TILE_H)<<4);
+  if(Fits && Cell->xsize==xsize && Cell->ysize==ysize && Cell->Ofs==Ofs && Cell->Sign==Sign)
+  { LCD_Stats.Saved += xsize*ysize*2 + lcd_trans_overhead; return 1; }
+  lcd_tiles_dirty(xpos, ypos, xsize, ysize);           // the area is drawn anew: forget what was there
+  if(Fits) { Cell->Ofs=Ofs; Cell->xsize=xsize; Cell->ysize=ysize; Cell->Sign=Sign; } // and remember this one
+  return 0; }
+
+void LCD_FrameStart(void)
+{ LCD_Stats.Bytes=0; LCD_Stats.Saved=0;
+  LCD_Stats.usStart=HAL_usTime(); }
+
+void LCD_FrameEnd(void)                                // wait for the transfers, count the frame if anything was drawn
+{ if(LCD_Stats.Bytes==0 && LCD_Stats.Saved==0) return;
+  lcd_trans_flush();
+  LCD_Stats.usFrame = HAL_usTime()-LCD_Stats.usStart;
+  if(LCD_Stats.usFrame>LCD_Stats.usMax) LCD_Stats.usMax=LCD_Stats.usFrame;
+  LCD_Stats.Frames++; LCD_Stats.TotalBytes+=LCD_Stats.Bytes; LCD_Stats.TotalSaved+=LCD_Stats.Saved; }
+
+int LCD_Stat::Print(char *Out) const                   // frames, frame time, bytes per frame and the part saved by the tracker
+{ int Len=0;
+  Len+=Format_String(Out+Len, "LCD: ");
+  Len+=Format_UnsDec(Out+Len, Frames);
+  Len+=Format_String(Out+Len, " frames, ");
+  Len+=Format_UnsDec(Out+Len, usFrame/100, 2, 1);
+  Len+=Format_String(Out+Len, "/");
+  Len+=Format_UnsDec(Out+Len, usMax/100, 2, 1);
+  Len+=Format_String(Out+Len, "ms last/max, ");
+  Len+=Format_UnsDec(Out+Len, Frames ? (uint32_t)(TotalBytes/Frames):0);
+  Len+=Format_String(Out+Len, "B/frame, ");
+  uint64_t Total=TotalBytes+TotalSaved;
+  Len+=Format_UnsDec(Out+Len, Total ? (uint32_t)((100*TotalSaved+Total/2)/Total):0);
+  Len+=Format_String(Out+Len, "% saved\n");
+  Out[Len]=0; return Len; }
+
+// ================================================================================
+
+static bool lcd_clip(int &xpos, int &ypos, int &xsize, int &ysize) // crop the box to the screen: 0 => nothing left to draw
+{ if(xsize<=0) return 0;
+  if(ysize<=0) return 0;
+  if(xpos>=LCD_WIDTH) return 0;
+  if(ypos>=LCD_HEIGHT) return 0;
+  if((xpos+xsize)<=0) return 0;
+  if((ypos+ysize)<=0) return 0;
   if(xpos<0) { xsize+=xpos; xpos=0; }
   if(ypos<0) { ysize+=ypos; ypos=0; }
   if((xpos+xsize)>LCD_WIDTH)  { xsize=LCD_WIDTH-xpos; }
   if((ypos+ysize)>LCD_HEIGHT) { ysize=LCD_HEIGHT-ypos; }
+  return 1; }
 
-  if(lcd_transaction_active) lcd_trans_wait();
-
-  int lines_per_batch = LCD_BUFF_SIZE/xsize;             // number of lines we can do per batch given the buffer size
+static void lcd_fill_box(int xpos, int ypos, int xsize, int ysize, uint16_t RGB565) // send a cropped box, the tracker is not involved
+{ int lines_per_batch = LCD_BUFF_SIZE/xsize;             // number of lines we can do per batch given the buffer size
   if(lines_per_batch>ysize) lines_per_batch=ysize;       // if bigger than we need to do then cut it down
   int pixels_per_batch = lines_per_batch*xsize;          // number of pixels per batch
-  lcd_buffer_fill(pixels_per_batch, RGB565);             // fill the buffer with uniform color, if not filled already
   for( ; ysize; )                                        // send given number of lines: do it in batches for speed
   { if(lines_per_batch>ysize) lines_per_batch=ysize;
-    lcd_trans_setup(xpos, ypos, xsize, lines_per_batch, lcd_buffer);
-    lcd_trans_start();
+    lcd_buffer_fill(pixels_per_batch, RGB565);           // fill the buffer with uniform color, if not filled already
+    lcd_trans_setup(xpos, ypos, xsize, lines_per_batch, lcd_buffer[lcd_buffer_next]);
+    lcd_trans_start();                                   // the two buffers take turns: one batch is sent while the next is set up
     ypos+=lines_per_batch; ysize-=lines_per_batch; }
 }
 
+static void lcd_draw_box(int xpos, int ypos, int xsize, int ysize, uint16_t RGB565) // for shapes drawn piece by piece:
+{ if(lcd_clip(xpos, ypos, xsize, ysize)) lcd_fill_box(xpos, ypos, xsize, ysize, RGB565); } // their whole area is made dirty first
+
+static void lcd_draw_pixel(int xpos, int ypos, uint16_t RGB565) { lcd_draw_box(xpos, ypos, 1, 1, RGB565); }
+
+void LCD_DrawBox(int xpos, int ypos, int xsize, int ysize, uint16_t RGB565)
+{ if(!lcd_clip(xpos, ypos, xsize, ysize)) return;
+  if(xsize<LCD_TILE_W && ysize<LCD_TILE_H) lcd_tiles_dirty(xpos, ypos, xsize, ysize); // smaller than a tile: not worth remembering
+  else if(lcd_tiles_check(xpos, ypos, xsize, ysize, lcd_sign(0x811C9DC5, 0x10000|RGB565))) return; // same box there already
+  lcd_fill_box(xpos, ypos, xsize, ysize, RGB565); }
+
 // void LCD_DrawHorLine(int xpos, int ypos, int xsize, uint16_t RGB565)
 // { LCD_DrawBox(xpos, ypos, xsize, 1, RGB565); }
 
@@ -365,6 +480,7 @@ void LCD_DrawLine(int x0, int y0, int x1, int y1, uint16_t RGB565)
              else LCD_DrawHorLine(x1, y0, x0-x1+1, RGB565);
     return; }
 
+  lcd_tiles_dirty(x0<x1 ? x0:x1, y0<y1 ? y0:y1, abs(x1-x0)+1, abs(y1-y0)+1); // once for the whole line, not for every piece
   int steep = 0;
   if (abs(y1-y0) > abs(x1-x0)) steep = 1;
   if (steep)   { swap(x0, y0); swap(x1, y1); }
@@ -385,12 +501,11 @@ void LCD_DrawLine(int x0, int y0, int x1, int y1, uint16_t RGB565)
       err-=dy;
       if(err<0)
       { err+=dx;
-        if (dlen==1) LCD_DrawPixel(y0, xs, RGB565);
-                else LCD_DrawVerLine(y0, xs, dlen, RGB565);
+        lcd_draw_box(y0, xs, 1, dlen, RGB565);
         dlen=0; y0+=ystep; xs=x0+1;
       }
     }
-    if (dlen) LCD_DrawVerLine(y0, xs, dlen, RGB565);
+    if (dlen) lcd_draw_box(y0, xs, 1, dlen, RGB565);
   }
   else
   { for ( ; x0<=x1; x0++)
@@ -398,12 +513,11 @@ void LCD_DrawLine(int x0, int y0, int x1, int y1, uint16_t RGB565)
       err-=dy;
       if(err<0)
       { err+=dx;
-        if (dlen==1) LCD_DrawPixel(xs, y0, RGB565);
-                else LCD_DrawHorLine(xs, y0, dlen, RGB565);
+        lcd_draw_box(xs, y0, dlen, 1, RGB565);
         dlen=0; y0+=ystep; xs=x0+1;
       }
     }
-    if (dlen) LCD_DrawHorLine(xs, y0, dlen, RGB565);
+    if (dlen) lcd_draw_box(xs, y0, dlen, 1, RGB565);
   }
 
 }
@@ -415,10 +529,11 @@ void LCD_DrawCircle(int x, int y, int radius, uint16_t RGB565)
   int x1 = 0;
   int y1 = radius;
 
-  LCD_DrawPixel(x, y + radius, RGB565);
-  LCD_DrawPixel(x, y - radius, RGB565);
-  LCD_DrawPixel(x + radius, y, RGB565);
-  LCD_DrawPixel(x - radius, y, RGB565);
+  lcd_tiles_dirty(x-radius, y-radius, 2*radius+1, 2*radius+1); // once for the whole circle, not for every pixel
+  lcd_draw_pixel(x, y + radius, RGB565);
+  lcd_draw_pixel(x, y - radius, RGB565);
+  lcd_draw_pixel(x + radius, y, RGB565);
+  lcd_draw_pixel(x - radius, y, RGB565);
 
   while(x1<y1)
   { if (f >= 0)
@@ -428,14 +543,14 @@ void LCD_DrawCircle(int x, int y, int radius, uint16_t RGB565)
     x1++;
     ddF_x += 2;
     f += ddF_x;
-    LCD_DrawPixel(x + x1, y + y1, RGB565);
-    LCD_DrawPixel(x - x1, y + y1, RGB565);
-    LCD_DrawPixel(x + x1, y - y1, RGB565);
-    LCD_DrawPixel(x - x1, y - y1, RGB565);
-    LCD_DrawPixel(x + y1, y + x1, RGB565);
-    LCD_DrawPixel(x - y1, y + x1, RGB565);
-    LCD_DrawPixel(x + y1, y - x1, RGB565);
-    LCD_DrawPixel(x - y1, y - x1, RGB565);
+    lcd_draw_pixel(x + x1, y + y1, RGB565);
+    lcd_draw_pixel(x - x1, y + y1, RGB565);
+    lcd_draw_pixel(x + x1, y - y1, RGB565);
+    lcd_draw_pixel(x - x1, y - y1, RGB565);
+    lcd_draw_pixel(x + y1, y + x1, RGB565);
+    lcd_draw_pixel(x - y1, y + x1, RGB565);
+    lcd_draw_pixel(x + y1, y - x1, RGB565);
+    lcd_draw_pixel(x - y1, y - x1, RGB565);
   }
 }
 
@@ -475,10 +590,11 @@ int LCD_DrawTranspChar(char Char, int xpos, int ypos, uint16_t RGB565, const uin
   const uint8_t *Data = Geom->Data;
   uint8_t Byte = 0x00;
   uint8_t Mask = 0x00;
+  lcd_tiles_dirty(xpos, ypos, Geom->width, Geom->height); // once for the character, not for every pixel
   for(int dy=0; dy < Geom->height; dy++)
   { for(int dx=0; dx < Geom->width; dx++)
     { if(Mask==0) { Byte = *Data++; Mask=0x80; }
-      if(Byte&Mask) LCD_DrawPixel(xpos+dx, ypos+dy, RGB565);
+      if(Byte&Mask) lcd_draw_pixel(xpos+dx, ypos+dy, RGB565);
       Mask>>=1; }
   }
   return Geom->xDelta; }                               // return by how much move the cursor to draw the next character
@@ -496,12 +612,17 @@ int LCD_DrawChar(char Char, int xpos, int ypos, uint16_t Fore, uint16_t Back, co
   int Height = LCD_FontHeight(propFont);
   int CropLeft = 0; if(xpos<0) { CropLeft=(-xpos); xpos=0; Width -=CropLeft; }
   int CropTop  = 0; if(ypos<0) { CropTop =(-ypos); ypos=0; Height-=CropTop ; }
-  int CropRight = 0; if((xpos+Width)>LCD_WIDTH) { CropRight=xpos-LCD_WIDTH; Width-=CropRight; }
-  int CropBottom = 0; if((ypos+Height)>LCD_HEIGHT) { CropBottom=ypos-LCD_HEIGHT; Height-=CropBottom; }
+  int CropRight = 0; if((xpos+Width)>LCD_WIDTH) { CropRight=xpos+Width-LCD_WIDTH; Width-=CropRight; }
+  int CropBottom = 0; if((ypos+Height)>LCD_HEIGHT) { CropBottom=ypos+Height-LCD_HEIGHT; Height-=CropBottom; }
   if(Width<=0 || Height<=0) return Geom->xDelta;
+  if(Width*Height>LCD_BUFF_SIZE) Height=LCD_BUFF_SIZE/Width;      // does not fit the buffer: cut at the bottom
+  uint32_t Sign = lcd_sign(0x811C9DC5, (uint8_t)Char | (CropLeft<<8) | (CropTop<<16));
+  Sign = lcd_sign(lcd_sign(Sign, ((uint32_t)Back<<16) | Fore), (uint32_t)(uintptr_t)propFont);
+  if(lcd_tiles_check(xpos, ypos, Width, Height, Sign)) return Width; // same character there already
   int Pixels = Width*Height;
-  lcd_buffer_filled=0;
-  for(int Pix=0; Pix<Pixels; Pix++) lcd_buffer[Pix]=Back;
+  uint16_t *Buffer = lcd_buffer_get();      // rendered while the previous character is still being sent
+  lcd_buffer_filled[lcd_buffer_next]=0;
+  for(int Pix=0; Pix<Pixels; Pix++) Buffer[Pix]=Back;
   const uint8_t *Data = Geom->Data;
   uint8_t Byte = 0x00;
   uint8_t Mask = 0x00;
@@ -512,13 +633,12 @@ int LCD_DrawChar(char Char, int xpos, int ypos, uint16_t Fore, uint16_t Back, co
       { int X = Geom->xOffset+dx-CropLeft;
         int Y = Geom->yOffset+dy-CropTop;
         if( X>=0 && X<Width && Y>=0 && Y<Height)
-        { lcd_buffer[Y*Width+X] = Fore; }
+        { Buffer[Y*Width+X] = Fore; }
       }
       Mask>>=1; }
   }
-  lcd_trans_setup(xpos, ypos, Width, Height, lcd_buffer);
-  lcd_trans_start();
-  lcd_trans_wait();
+  lcd_trans_setup(xpos, ypos, Width, Height, Buffer);
+  lcd_trans_start();                        // do not wait: the next character goes into the other buffer
   return Width; }
 
 int LCD_CharWidth(char Char, const uint8_t *propFont)
@@ -612,7 +732,9 @@ static UINT tjd_output (
   if(Llines<=0) return 1;
   if(Lrows<=0) return 1;
 
-  uint16_t *Dst = lcd_buffer;                // buffer to form RGB565 for transfer
+  lcd_tiles_dirty(Lx0, Ly0, Lrows, Llines);  // the picture covers whatever the tracker remembered there
+  uint16_t *Buffer = lcd_buffer_get();       // buffer to form RGB565 for transfer
+  uint16_t *Dst = Buffer;
   uint8_t *Src = (uint8_t *)bitmap;          // RGB from JPEG decoder
   if(CropTop) Src += CropTop*3*Jxs;          // Advance by the nuber of lines to skip
   for(int Line=0; Line<Llines; Line++)       // Loop over line to display
@@ -620,9 +742,9 @@ static UINT tjd_output (
     for(int Row=0; Row<Lrows; Row++)         // loop over pixel in this line
     { Dst[Row] = RGB565(Ptr); Ptr+=3; }      // convert to RGB565 and store in the buffer
     Src+=3*Jxs; Dst+=Lrows; }                // advance by the number of pixels
-  lcd_buffer_filled=0;
+  lcd_buffer_filled[lcd_buffer_next]=0;
 
-  lcd_trans_setup(Lx0, Ly0, Llines, Lrows, lcd_buffer);
+  lcd_trans_setup(Lx0, Ly0, Llines, Lrows, Buffer);
   lcd_trans_start();
 
   return 1; } // continue with decompression
@@ -653,11 +775,13 @@ void LCD_DrawJPEG(const uint8_t *JPEG, int JPEGsize, int xpos, int ypos, int Sca
 // ================================================================================
 
 void LCD_Start(void)
-{ // if(LCD_TYPE==1) lcd_start(ILI9341_init);                          // reset, send initial commands
+{ lcd_trans_flush();                                               // commands go by polling: no pixel data may be in the queue
+  // if(LCD_TYPE==1) lcd_start(ILI9341_init);                          // reset, send initial commands
   //            else lcd_start(ST7789_init);                           // reset, send initial commands
   if(LCD_TYPE==1) lcd_start(ILI9341_init);                          // reset, send initial commands
              else lcd_start(ST7789_init);                           // reset, send initial commands
   lcd_trans_init();                                                 // initialize SPI transactions
+  lcd_tiles_clear();                                                // nothing known on the screen
   LCD_DrawBox(0,  0, LCD_WIDTH, LCD_HEIGHT, RGB565_WHITE);          // screen all-white
 }
 
@@ -676,7 +800,7 @@ void LCD_Init(spi_host_device_t LCD_SPI_HOST, uint8_t LCD_SPI_MODE, int LCD_SPI_
     .input_delay_ns = 0,                      // seems to help with the reliability
     .spics_io_num = LCD_PIN_CS,               // CS pin
     .flags = 0,
-    .queue_size = 8,                          // We want to be able to queue 7 transactions at a time
+    .queue_size = 12,                         // two sets of six transactions: one per DMA buffer
     .pre_cb = lcd_spi_pre_transfer_callback,  // Specify pre-transfer callback to handle D/C line
     .post_cb = 0 // lcd_spi_post_transfer_callback
   };
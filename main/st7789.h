@@ -69,7 +69,26 @@ extern int LCD_TYPE;        // 0 = ST7789
 extern int LCD_WIDTH;       // [pixels]
 extern int LCD_HEIGHT;      // [pixels]
 
-const int LCD_BUFF_SIZE = 12*320;
+const int LCD_BUFF_SIZE = 6*320;   // [pixels] each of the two DMA buffers: one is rendered while the other is sent
+const int LCD_TILE_W    =  8;      // [pixels] tile width of the dirty-region tracker: no narrower than a space
+const int LCD_TILE_H    = 16;      // [pixels] tile height
+
+class LCD_Stat                     // drawing between LCD_FrameStart() and LCD_FrameEnd()
+{ public:
+   uint32_t Frames;                // frames which drew anything
+   uint32_t Bytes;                 // [bytes] sent to the LCD in the current/last frame
+   uint32_t Saved;                 // [bytes] not sent: the tracker found them on the screen already
+   uint64_t TotalBytes, TotalSaved;
+   int64_t  usStart;               // [us] when the current frame started
+   uint32_t usFrame, usMax;        // [us] time of the last and of the longest frame: drawing and the transfers
+  public:
+   int Print(char *Out) const;     // one line for the console
+} ;
+
+extern LCD_Stat LCD_Stats;
+
+void LCD_FrameStart(void);         // open a frame: counters to zero, start the time
+void LCD_FrameEnd(void);           // wait for the transfers, update the counters
 
 void LCD_Init(spi_host_device_t LCD_SPI_HOST, uint8_t LCD_SPI_MODE, int LCD_SPI_SPEED=10000000 /*, int LCD_TYPE=0 */ );
 void LCD_Start(void);
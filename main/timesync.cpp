@@ -44,6 +44,32 @@ void TimeSync_SoftPPS(TickType_t Tick, uint32_t Time, int32_t msOfs)       // [m
 void TimeSync_CorrRef(int16_t Corr)
 { TimeSync_RefTick += Corr; }
 
+#ifdef WITH_PPS_IRQ
+PPS_Clock TimeSync_Clock;
+
+void TimeSync_HardPPS_us(int64_t usEdge)                                   // [us] hardware PPS captured on the local timer
+{ int64_t Age = HAL_usTime()-usEdge;                                       // [us] since the edge
+  TimeSync_HardPPS(xTaskGetTickCount()-(TickType_t)((Age+500)/1000));      // the tick reference at the edge, not when the task saw it
+  TimeSync_Clock.Update(usEdge, TimeSync_RefTime); }                       // the edge starts the second TimeSync_RefTime
+
+bool TimeSync_usTime(uint32_t &Time, uint32_t &usTime, uint32_t &usUncert, int64_t usLocal)
+{ return TimeSync_Clock.getTime(usLocal, Time, usTime, usUncert); }
+
+bool TimeSync_usTime(uint32_t &Time, uint32_t &usTime, uint32_t &usUncert)
+{ return TimeSync_Clock.getTime(HAL_usTime(), Time, usTime, usUncert); }
+
+int32_t TimeSync_Drift(void)
+{ int32_t Drift; return TimeSync_Clock.getDrift(Drift) ? Drift:0; }
+#endif
+
+TickType_t TimeSync_msPPS(void)                                            // [ms] fractional time now: from the PPS clock when locked
+{
+#ifdef WITH_PPS_IRQ
+  uint32_t Time, usTime, usUncert;
+  if(TimeSync_usTime(Time, usTime, usUncert) && usUncert<1000) return usTime/1000;
+#endif
+  return TimeSync_msTime(); }                                              // else from the tick reference
+
 TickType_t TimeSync_msTime(TickType_t Tick)                                // [ms] get fractional time which corresponds to given system tick
 { TickType_t msTime = Tick+1000-TimeSync_RefTick;
   if(msTime<1000) return msTime;
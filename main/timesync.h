@@ -12,6 +12,7 @@ void TimeSync_SoftPPS(TickType_t Tick, uint32_t Time, int32_t msOfs=100);   // s
 
 TickType_t TimeSync_msTime(TickType_t Tick);                                // [ms] get fractional time which corresponds to given system tick
 TickType_t TimeSync_msTime(void);
+TickType_t TimeSync_msPPS(void);                                            // [ms] as above, from the PPS clock when it is locked: for RF slots and RX stamps
 
 uint32_t TimeSync_Time(TickType_t Tick);                                    // [sec] get Time which  corresponds to given system tick
 uint32_t TimeSync_Time(void);
@@ -21,4 +22,17 @@ void TimeSync_Time(uint32_t &Time, TickType_t &msTime);
 
 void TimeSync_CorrRef(int16_t Corr);                                        // [ms] correct the time reference [RTOS tick]
 
+#ifdef WITH_PPS_IRQ
+#include "ppsclock.h"
+
+extern PPS_Clock TimeSync_Clock;                                            // microsecond time base disciplined by the PPS edges
+
+void TimeSync_HardPPS_us(int64_t usEdge);                                   // [us] hardware PPS captured on the local timer
+
+bool TimeSync_usTime(uint32_t &Time, uint32_t &usTime, uint32_t &usUncert, int64_t usLocal); // [sec], [us], [us] UTC at given local timer
+bool TimeSync_usTime(uint32_t &Time, uint32_t &usTime, uint32_t &usUncert);                  // UTC now, 0: no PPS lock
+
+int32_t TimeSync_Drift(void);                                               // [ppb] local oscillator against GPS
+#endif
+
 #endif // __TIMESYNC_H__
@@ -0,0 +1,89 @@
+#ifndef __VERTICAL_H__
+#define __VERTICAL_H__
+
+#include <stdint.h>
+#include <math.h>
+
+// Vertical state estimator: Kalman filter over the pressure altitude, the climb rate and the accelerometer bias.
+// Every baro reading is an update, at whatever rate the sensor delivers, Predict() covers the time in between:
+// either with the vertical acceleration from the IMU, or, without one, with the climb rate changing at random.
+// A separate scalar filter tracks the GPS altitude minus the pressure altitude, which changes only with the weather,
+// thus the GPS noise does not reach the climb rate while the altitude still follows the GPS in the long run.
+
+class VerticalKalman
+{ public:
+   float Alt;                                             // [m] standard pressure altitude
+   float Climb;                                           // [m/s]
+   float Bias;                                            // [m/s^2] accelerometer bias
+   float P[3][3];                                         // state covariance
+
+   float GeoOfs;                                          // [m] GPS altitude minus pressure altitude
+   float GeoVar;                                          // [m^2] its variance
+   float InnoVar;                                         // [m^2] average squared baro innovation: the noise seen
+
+   float BaroVar;                                         // [m^2] noise of one baro reading
+   float ManQ;                                            // [m^2/s^3] climb rate change without an accelerometer
+   float AccQ;                                            // [m^2/s^3] accelerometer noise
+   float BiasQ;                                           // [m^2/s^5] accelerometer bias drift
+   float GPSVar;                                          // [m^2] GPS altitude noise
+   float GeoQ;                                            // [m^2/s] change of the GPS-pressure altitude offset: weather
+
+   bool  Valid;
+
+  public:
+   VerticalKalman()
+   { BaroVar=0.06f; ManQ=0.5f; AccQ=0.02f; BiasQ=1e-4f; GPSVar=16.0f; GeoQ=2e-4f;
+     Valid=0; GeoOfs=0; GeoVar=1e6f; }
+
+   void Clear(float Altitude)                             // start from a baro reading [m]
+   { Alt=Altitude; Climb=0; Bias=0;
+     for(int Row=0; Row<3; Row++)
+       for(int Col=0; Col<3; Col++) P[Row][Col]=0;
+     P[0][0]=BaroVar; P[1][1]=4.0f; P[2][2]=0.25f;
+     InnoVar=BaroVar; Valid=1; }
+
+   void Predict(float dt) { Predict(dt, 0, 0); }          // [s] time since the last update, no accelerometer
+
+   void Predict(float dt, float Acc, bool hasAcc=1)       // [s], [m/s^2] vertical acceleration, gravity removed
+   { float Q = hasAcc ? AccQ:ManQ;
+     float K = hasAcc ? 1.0f:0.0f;                        // the bias acts only through the accelerometer
+     float Accel = K*(Acc-Bias);
+     Alt   += Climb*dt + 0.5f*Accel*dt*dt;
+     Climb += Accel*dt;
+     float F[3][3] = { { 1, dt, -0.5f*K*dt*dt }, { 0, 1, -K*dt }, { 0, 0, 1 } };
+     float FP[3][3];
+     for(int Row=0; Row<3; Row++)
+       for(int Col=0; Col<3; Col++)
+         FP[Row][Col] = F[Row][0]*P[0][Col] + F[Row][1]*P[1][Col] + F[Row][2]*P[2][Col];
+     for(int Row=0; Row<3; Row++)
+       for(int Col=0; Col<3; Col++)
+         P[Row][Col] = FP[Row][0]*F[Col][0] + FP[Row][1]*F[Col][1] + FP[Row][2]*F[Col][2];
+     float dt2=dt*dt;
+     P[0][0] += Q*dt2*dt/3; P[0][1] += Q*dt2/2; P[1][0] += Q*dt2/2; P[1][1] += Q*dt;
+     if(hasAcc) P[2][2] += BiasQ*dt;
+     GeoVar += GeoQ*dt; }
+
+   void BaroUpdate(float Altitude)                        // [m] standard pressure altitude from one baro reading
+   { float Inno = Altitude-Alt;
+     float S = P[0][0]+BaroVar;
+     float K0=P[0][0]/S, K1=P[1][0]/S, K2=P[2][0]/S;
+     Alt+=K0*Inno; Climb+=K1*Inno; Bias+=K2*Inno;
+     float P0[3] = { P[0][0], P[0][1], P[0][2] };
+     for(int Col=0; Col<3; Col++)
+     { P[0][Col]-=K0*P0[Col]; P[1][Col]-=K1*P0[Col]; P[2][Col]-=K2*P0[Col]; }
+     InnoVar += (Inno*Inno-InnoVar)*(1.0f/32); }
+
+   void GPSUpdate(float GPSAlt)                           // [m] GPS altitude above MSL
+   { float Inno = GPSAlt-Alt-GeoOfs;
+     float K = GeoVar/(GeoVar+GPSVar);
+     GeoOfs += K*Inno; GeoVar -= K*GeoVar; }
+
+   bool hasGeo(void) const { return GeoVar<GPSVar; }      // GPS altitude seen
+
+   int32_t getStdAltitude(void) const { return (int32_t)floorf(10*Alt+0.5f); }          // [0.1 m]
+   int32_t getAltitude(void)    const { return (int32_t)floorf(10*(Alt+GeoOfs)+0.5f); } // [0.1 m] above MSL, follows the GPS
+   int32_t getClimbRate(void)   const { return (int32_t)floorf(100*Climb+0.5f); }       // [0.01 m/s]
+
+} ;
+
+#endif // __VERTICAL_H__
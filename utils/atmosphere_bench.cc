@@ -0,0 +1,187 @@
+// Standard atmosphere benchmark: the table based Atmosphere::StdAltitude() and StdPressure() against the ICAO formulas
+// in double precision, and against the former iterative StdAltitude() in 100Pa steps and the float BaroAlt()
+// which ProcBaro() used. Reports the maximum and RMS errors over the whole range in the sensor resolution
+// and the time per call. With -t it prints the tables for main/atmosphere.cpp, generated from the same formulas.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "../main/atmosphere.h"                                       // the firmware headers, not the copies here
+#include "../main/ognconv.h"
+
+static double getTime(void)                                           // read the system time at this very moment
+{ struct timespec now; clock_gettime(CLOCK_MONOTONIC, &now); return now.tv_sec + 1e-9*now.tv_nsec; }
+
+static int    Repeat  = 5;                                            // timing passes
+static int    Table   = 0;                                            // print the tables
+static int    Help    = 0;
+
+// ----------------------------------------------------------------------------------------------------------------
+
+// ICAO standard atmosphere in geopotential altitude, the same constants as BaroAlt() in ognconv.cpp
+static const double g0 = 9.80665, M = 0.0289644, R = 8.3144598;
+
+struct Layer { double hb, Pb, Tb, Lb; } ;                            // [m], [Pa], [K], [K/m]
+static Layer Layers[3] = { { 0, 101325.0, 288.15, 0.0065 }, { 11000, 22632.10, 216.65, 0 }, { 20000, 5474.89, 216.65, -0.0010 } } ;
+
+static double LayerAltitude(const Layer &L, double P)                 // [Pa] => [m] within the layer
+{ if(L.Lb==0) return L.hb - log(P/L.Pb)*(R*L.Tb)/(g0*M);
+  return L.hb + L.Tb/L.Lb*(1-pow(P/L.Pb, (R*L.Lb)/(g0*M))); }
+
+static double LayerPressure(const Layer &L, double h)                 // [m] => [Pa] within the layer
+{ if(L.Lb==0) return L.Pb*exp(-(g0*M/R)*(h-L.hb)/L.Tb);
+  return L.Pb*pow((L.Tb-(h-L.hb)*L.Lb)/L.Tb, (g0*M)/(R*L.Lb)); }
+
+static void ChainLayers(void)                                         // base pressures from the layer below: the published ones are rounded
+{ for(int Idx=1; Idx<3; Idx++)                                        // and the altitude would jump by 15cm at 11km and at 20km
+    Layers[Idx].Pb=LayerPressure(Layers[Idx-1], Layers[Idx].hb); }
+
+static double RefAltitude(double P)                                   // [Pa] => [m]
+{ int Idx=0; for( ; Idx<2; Idx++) { if(P>Layers[Idx+1].Pb) break; }
+  return LayerAltitude(Layers[Idx], P); }
+
+static double RefPressure(double h)                                   // [m] => [Pa]
+{ int Idx=0; for( ; Idx<2; Idx++) { if(h<Layers[Idx+1].hb) break; }
+  return LayerPressure(Layers[Idx], h); }
+
+static const int32_t OldAltTable[10] = { 117764, 91652, 71864, 55752, 42070, 30126, 19493, 9886, 1109, -6984 } ; // [0.1 m]
+
+static int32_t OldStdAltitude(int32_t Pressure, int32_t PressStep=100) // the former iterative StdAltitude(): [Pa] => [0.1m]
+{ int32_t Idx=(Pressure+5000)/10000; Idx-=2;
+  if(Idx<0) Idx=0; else if(Idx>9) Idx=9;
+  int32_t Press    = 10000*(Idx+2);
+  int32_t Altitude = 10*OldAltTable[Idx];
+  for( ; ; )
+  { int32_t Temp=Atmosphere::StdTemperature(Altitude/10);
+    int32_t Delta=Pressure-Press; if(Delta==0) break;
+    if(Delta>PressStep) Delta=PressStep;
+    else if(Delta<(-PressStep)) Delta=(-PressStep);
+    Altitude+=Atmosphere::AltitudeDelta(Delta, Press, Temp);
+    Press+=Delta; }
+  return Altitude/10; }
+
+// ----------------------------------------------------------------------------------------------------------------
+
+static void PrintTable(const char *Type, const char *Name, const double *Value, int Size, int PerLine)
+{ printf("const %-8s Atmosphere::%s[%d] = {", Type, Name, Size);
+  for(int Idx=0; Idx<Size; Idx++)
+  { if(Idx%PerLine==0) printf("\n  ");
+    printf("%8.0f%s", Value[Idx], Idx<Size-1 ? ",":""); }
+  printf(" } ;\n\n"); }
+
+static void PrintTables(void)                                         // knots and bows from the double precision formulas
+{ const int Segs = Atmosphere::TableSegs;
+  static double Press[256], AltBow[256], PressBow[256];
+  for(int Seg=0; Seg<=Segs; Seg++)
+  { double h0 = 0.1*(Atmosphere::TableMinAlt + Seg*Atmosphere::TableStep); // [m] segment start
+    double h1 = h0 + 0.1*Atmosphere::TableStep;                       // [m] segment end
+    Press[Seg] = floor(16*RefPressure(h0)+0.5);                       // [1/16 Pa]
+    if(Seg==Segs) break;
+    double P0 = RefPressure(h0), P1 = RefPressure(h1);
+    AltBow[Seg]   = floor(1000*(RefAltitude(0.5*(P0+P1)) - 0.5*(h0+h1))+0.5);            // [mm]
+    PressBow[Seg] = floor(16*(RefPressure(0.5*(h0+h1)) - 0.5*(P0+P1))+0.5); }           // [1/16 Pa]
+  printf("// generated by utils/atmosphere_bench -t\n\n");
+  PrintTable("uint32_t", "TablePress",    Press,    Segs+1, 10);
+  PrintTable("int16_t",  "TableAltBow",   AltBow,   Segs,   10);
+  PrintTable("int16_t",  "TablePressBow", PressBow, Segs,   10); }
+
+// ----------------------------------------------------------------------------------------------------------------
+
+struct ErrStat
+{ double Sum2, Max; int Count;
+  void Clear(void) { Sum2=0; Max=0; Count=0; }
+  void Add(double Err) { Sum2+=Err*Err; if(fabs(Err)>Max) Max=fabs(Err); Count++; }
+  double RMS(void) const { return sqrt(Sum2/(Count?Count:1)); }
+} ;
+
+static volatile int32_t Sink;                                         // keeps the timed calls from being optimized away
+
+int main(int argc, char *argv[])
+{ for(int arg=1; arg<argc; arg++)
+  { const char *Val = argv[arg];
+    if(Val[0]!='-') { Help=1; continue; }
+    switch(Val[1])
+    { case 'h': Help=1; break;
+      case 't': Table=1; break;
+      case 'r': Repeat=atoi(Val+2); break;
+      default: Help=1; break;
+    }
+  }
+  if(Repeat<1) Help=1;
+
+  if(Help)
+  { printf("Usage: %s [options]\n\
+Options: -h          this help\n\
+         -t          print the tables for main/atmosphere.cpp\n\
+         -r<passes>  timing passes [%d]\n\
+", argv[0], Repeat);
+    return 0; }
+
+  ChainLayers();
+  if(Table) { PrintTables(); return 0; }
+
+  const int32_t MinPress = 4100*16, MaxPress = 125000*16;            // [1/16 Pa] about 22km down to -1.8km
+  ErrStat AltErr, AltErr16, OldErr, FloatErr;
+  AltErr.Clear(); AltErr16.Clear(); OldErr.Clear(); FloatErr.Clear();
+  double WorstPress=0, WorstRel=0;
+  for(int32_t Press=MinPress; Press<=MaxPress; Press++)              // every step of the sensor resolution
+  { double Ref = RefAltitude(Press/16.0);                             // [m]
+    double Err = Atmosphere::StdAltitude_mm(Press)*0.001 - Ref;
+    if(fabs(Err)>AltErr.Max) WorstPress=Press/16.0;
+    double Rel = fabs(Err)/(Ref-RefAltitude((Press+1)/16.0));         // relative to the altitude step of one 1/16Pa
+    if(Rel>WorstRel) WorstRel=Rel;
+    AltErr.Add(Err);
+    AltErr16.Add(Atmosphere::StdAltitude16(Press)*0.1 - Ref);
+    FloatErr.Add(floorf(BaroAlt((1.0f/16)*Press)*10+0.5)*0.1 - Ref);
+    if((Press&15)==0)                                                 // the former one takes whole [Pa]
+      OldErr.Add(OldStdAltitude(Press>>4)*0.1 - Ref); }
+
+  ErrStat PressErr, RoundErr; PressErr.Clear(); RoundErr.Clear();
+  for(int32_t Alt=-20000; Alt<=220000; Alt++)                         // [0.1 m] every step
+  { double Ref = RefPressure(0.1*Alt);                                // [Pa]
+    int32_t Press = Atmosphere::StdPressure16(Alt);                   // [1/16 Pa]
+    PressErr.Add(Press/16.0 - Ref);
+    RoundErr.Add(Atmosphere::StdAltitude16(Press) - Alt); }           // [0.1 m] there and back
+
+  printf("StdAltitude_mm  : %6.3fm max, %6.3fm RMS (worst at %7.1fPa), %4.2f of the 1/16Pa step max\n", AltErr.Max, AltErr.RMS(), WorstPress, WorstRel);
+  printf("StdAltitude16   : %6.3fm max, %6.3fm RMS, 0.1m output\n", AltErr16.Max, AltErr16.RMS());
+  printf("former iterative: %6.3fm max, %6.3fm RMS, 1Pa input\n", OldErr.Max, OldErr.RMS());
+  printf("float BaroAlt   : %6.3fm max, %6.3fm RMS, 0.1m output\n", FloatErr.Max, FloatErr.RMS());
+  printf("StdPressure16   : %6.3fPa max, %6.3fPa RMS\n", PressErr.Max, PressErr.RMS());
+  printf("Round trip      : %3.0f x 0.1m max, %5.3f x 0.1m RMS\n", RoundErr.Max, RoundErr.RMS());
+
+  const int Calls = 1000000;                                          // pressures spread over the range
+  static int32_t Input[Calls];
+  uint32_t Rand=0x12345678;
+  for(int Idx=0; Idx<Calls; Idx++)
+  { Rand^=Rand<<13; Rand^=Rand>>17; Rand^=Rand<<5;
+    Input[Idx] = MinPress + Rand%(MaxPress-MinPress); }
+  double Best[4] = { 1e9, 1e9, 1e9, 1e9 };
+  for(int Pass=0; Pass<Repeat; Pass++)
+  { double Start=getTime(); int32_t Sum=0;
+    for(int Idx=0; Idx<Calls; Idx++) Sum+=Atmosphere::StdAltitude16(Input[Idx]);
+    double Time=getTime()-Start; if(Time<Best[0]) Best[0]=Time;
+    Start=getTime();
+    for(int Idx=0; Idx<Calls; Idx++) Sum+=OldStdAltitude(Input[Idx]>>4);
+    Time=getTime()-Start; if(Time<Best[1]) Best[1]=Time;
+    Start=getTime();
+    for(int Idx=0; Idx<Calls; Idx++) Sum+=floorf(BaroAlt((1.0f/16)*Input[Idx])*10+0.5);
+    Time=getTime()-Start; if(Time<Best[2]) Best[2]=Time;
+    Start=getTime();
+    for(int Idx=0; Idx<Calls; Idx++) Sum+=Atmosphere::StdPressure16((Input[Idx]>>3)-20000);
+    Time=getTime()-Start; if(Time<Best[3]) Best[3]=Time;
+    Sink=Sum; }
+  printf("Time per call: table %5.1fns, former iterative %6.1fns, float BaroAlt %5.1fns, table StdPressure16 %5.1fns\n",
+         1e9*Best[0]/Calls, 1e9*Best[1]/Calls, 1e9*Best[2]/Calls, 1e9*Best[3]/Calls);
+
+  int Fail=0;
+  if(WorstRel>1.0)      { printf("Altitude table off by more than the sensor resolution\n"); Fail++; }
+  if(AltErr16.Max>AltErr.Max+0.051) { printf("Altitude in 0.1m off by more than the rounding\n"); Fail++; }
+  if(PressErr.Max>0.15) { printf("Pressure table off by more than two 1/16Pa steps\n"); Fail++; }
+  if(RoundErr.Max>1)    { printf("Round trip off by more than 0.1m\n"); Fail++; }
+  printf("%s\n", Fail ? "FAILED":"PASSED");
+  return Fail ? 1:0; }
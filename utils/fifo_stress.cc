@@ -0,0 +1,132 @@
+// SPSC_FIFO stress test: one thread writes numbered, check-summed packets, another thread reads and verifies them,
+// through every write/read style used in the tracker (single, getWrite/getRead, blocks and batches).
+// Any lost, duplicated, reordered or torn element is counted as an error.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+
+#include <thread>
+
+#include "fifo.h"                                                      // from ../main: the firmware header
+
+static double getTime(void)                                           // read the system time at this very moment
+{ struct timespec now; clock_gettime(CLOCK_MONOTONIC, &now); return now.tv_sec + 1e-9*now.tv_nsec; }
+
+static uint32_t Count = 4000000;                                      // number of packets per test
+static int      Batch =      5;                                       // number of packets per block write/read
+static int      Help  =      0;
+
+class TestPacket                                                      // about the size of a received packet
+{ public:
+   uint32_t Seq;
+   uint32_t Word[7];
+
+  public:
+   static uint32_t Hash(uint32_t Seq, int Idx) { return (Seq*2654435761u) ^ (Idx*0x9E3779B9u) ^ (Seq>>7); }
+   void Set(uint32_t Seq) { this->Seq=Seq; for(int Idx=0; Idx<7; Idx++) Word[Idx]=Hash(Seq, Idx); }
+   bool Check(void) const { for(int Idx=0; Idx<7; Idx++) if(Word[Idx]!=Hash(Seq, Idx)) return 0; return 1; }
+} ;
+
+static int Verify(const TestPacket &Packet, uint32_t &Expect)         // count an error when not the next or not intact
+{ int Err = Packet.Seq!=Expect || !Packet.Check();
+  Expect=Packet.Seq+1; return Err; }
+
+template <size_t Size>
+ static void Writer(SPSC_FIFO<TestPacket, Size> *Queue, int Mode, uint32_t *Retries)
+{ TestPacket Block[64];
+  uint32_t Retry=0;
+  for(uint32_t Seq=0; Seq<Count; )
+  { size_t Done=0;
+    if(Mode==0)                                                      // single element
+    { TestPacket Packet; Packet.Set(Seq); Done=Queue->Write(Packet); }
+    else if(Mode==1)                                                 // in place, like RF_RxFIFO in vTaskRF
+    { if(!Queue->isFull()) { Queue->getWrite()->Set(Seq); Done=Queue->Write(); } }
+    else if(Mode==2)                                                 // a batch copied in
+    { size_t Len=Batch; if(Len>Count-Seq) Len=Count-Seq;
+      if(Queue->Free()>=Len)
+      { for(size_t Idx=0; Idx<Len; Idx++) Block[Idx].Set(Seq+Idx);
+        Done=Queue->Write(Block, Len); }
+    }
+    else                                                             // in place, a contiguous block
+    { TestPacket *Ptr; size_t Len=Queue->getWriteBlock(Ptr);
+      if(Len>(size_t)Batch) Len=Batch;
+      if(Len>Count-Seq) Len=Count-Seq;
+      for(size_t Idx=0; Idx<Len; Idx++) Ptr[Idx].Set(Seq+Idx);
+      if(Len) Done=Queue->flushWriteBlock(Len); }
+    if(Done==0) { Retry++; sched_yield(); continue; }                // full: let the reader run
+    Seq+=Done; }
+  *Retries=Retry; }
+
+template <size_t Size>
+ static void Reader(SPSC_FIFO<TestPacket, Size> *Queue, int Mode, uint32_t *Errors)
+{ TestPacket Block[64];
+  uint32_t Expect=0, Err=0;
+  while(Expect<Count)
+  { size_t Done=0;
+    if(Mode==0)                                                      // single element
+    { TestPacket Packet;
+      if(Queue->Read(Packet)) { Err+=Verify(Packet, Expect); Done=1; } }
+    else if(Mode==1)                                                 // in place, like RF_RxFIFO in vTaskPROC
+    { TestPacket *Packet=Queue->getRead();
+      if(Packet) { Err+=Verify(*Packet, Expect); Queue->Read(); Done=1; } }
+    else if(Mode==2)                                                 // a batch copied out
+    { Done=Queue->Read(Block, Batch);
+      for(size_t Idx=0; Idx<Done; Idx++) Err+=Verify(Block[Idx], Expect); }
+    else                                                             // in place, a contiguous block, like Log_FIFO in vTaskSDLOG
+    { TestPacket *Ptr; Done=Queue->getReadBlock(Ptr);
+      for(size_t Idx=0; Idx<Done; Idx++) Err+=Verify(Ptr[Idx], Expect);
+      Queue->flushReadBlock(Done); }
+    if(Done==0) sched_yield(); }                                     // empty: let the writer run
+  *Errors=Err; }
+
+template <size_t Size>
+ static int Test(int Mode)
+{ static const char *ModeName[4] = { "single", "in place", "batch", "block" };
+  static SPSC_FIFO<TestPacket, Size> Queue;
+  Queue.Clear();
+  uint32_t Retries=0, Errors=0;
+  double Start=getTime();
+  std::thread Write(Writer<Size>, &Queue, Mode, &Retries);
+  std::thread Read (Reader<Size>, &Queue, Mode, &Errors);
+  Write.join(); Read.join();
+  double Time=getTime()-Start;
+  printf("%4lu %-9s %8.2f Mpkt/s %6u errors %3lu high-water %8lu full %8u retries %s\n",
+         (unsigned long)Size, ModeName[Mode], 1e-6*Count/Time, Errors,
+         (unsigned long)Queue.HighWater.load(), (unsigned long)Queue.Overflows.load(), Retries,
+         Errors || !Queue.isEmpty() ? "FAIL":"ok");
+  return Errors || !Queue.isEmpty(); }
+
+int main(int argc, char *argv[])
+{
+  for(int arg=1; arg<argc; arg++)
+  { const char *Val = argv[arg]; if(Val[0]!='-') { Help=1; break; }
+    switch(Val[1])
+    { case 'h': Help=1; break;
+      case 'n': Count=atoi(Val+2); break;
+      case 'b': Batch=atoi(Val+2); break;
+      default: Help=1; break;
+    }
+  }
+  if(Count==0 || Batch<1 || Batch>64) Help=1;
+
+  if(Help)
+  { printf("Usage: %s [options]\n\
+Options: -h          this help\n\
+         -n<count>   number of packets per test [%u]\n\
+         -b<count>   packets per batch/block write and read, up to 64 [%d]\n\
+", argv[0], Count, Batch);
+    return 0; }
+
+  unsigned Threads=std::thread::hardware_concurrency();
+  printf("%u hardware threads\n", Threads);
+  if(Threads<2) printf("Single core: the threads only interleave at preemption, there is no real contention\n");
+  int Fail=0;
+  for(int Mode=0; Mode<4; Mode++)
+  { Fail+=Test<16>(Mode);                                            // small queue: mostly full, like RF_RxFIFO
+    Fail+=Test<256>(Mode); }                                         // large queue: mostly empty
+  printf("%s\n", Fail ? "FAILED":"PASSED");
+  return Fail!=0; }
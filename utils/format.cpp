@@ -288,10 +288,12 @@ int16_t Read_Dec3(const char *Inp)             // convert three digit decimal nu
   int8_t Low=Read_Dec1(Inp[2]);  if(Low<0) return -1;
   return (int16_t)Low + (int16_t)10*(int16_t)Mid + (int16_t)100*(int16_t)High; }
 
-int16_t Read_Dec4(const char *Inp)             // convert four digit decimal number into an integer
-{ int16_t High=Read_Dec2(Inp  ); if(High<0) return -1;
-  int16_t Low =Read_Dec2(Inp+2); if(Low<0) return -1;
-  return Low + (int16_t)100*(int16_t)High; }
+int16_t Read_Dec4(const char *Inp)             // convert four digit decimal number into an integer: all four chars are read
+{ uint32_t Word = (uint8_t)Inp[0] | (uint32_t)(uint8_t)Inp[1]<<8 | (uint32_t)(uint8_t)Inp[2]<<16 | (uint32_t)(uint8_t)Inp[3]<<24;
+  if( ((Word&0xF0F0F0F0) | (((Word+0x06060606)&0xF0F0F0F0)>>4)) != 0x33333333 ) return -1; // all four must be '0'..'9'
+  Word-=0x30303030;                            // four digits, the first one in the lowest byte
+  Word=(Word*10+(Word>>8))&0x00FF00FF;         // two two-digit numbers in the lower and upper half
+  return (int16_t)(Word&0xFF)*100 + (int16_t)(Word>>16); }
 
 int32_t Read_Dec5(const char *Inp)             // convert four digit decimal number into an integer
 { int16_t High=Read_Dec2(Inp  ); if(High<0) return -1;
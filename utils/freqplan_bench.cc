@@ -0,0 +1,133 @@
+// FreqPlan hopping schedule benchmark: the channel for a slot start from FreqPlan::getChannel(), the hash,
+// against a 16-second ring of precomputed channels tagged by UTC second, refilled ahead as vTaskRF would do it
+// in the listen-only window. The ring must be bit-identical to the hash for all plans, consecutive seconds,
+// the 32-bit wrap-around and random time jumps. Then the time per slot start is reported for both:
+// this is why the firmware keeps the hash and has no schedule.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "../main/freqplan.h"                                         // the firmware headers, not the copies here
+
+static double getTime(void)                                           // read the system time at this very moment
+{ struct timespec now; clock_gettime(CLOCK_MONOTONIC, &now); return now.tv_sec + 1e-9*now.tv_nsec; }
+
+static uint32_t RandState = 0x12345678;                               // simple xorshift generator: reproducible between runs and platforms
+
+static uint32_t Random(void)
+{ uint32_t X=RandState; X^=X<<13; X^=X>>17; X^=X<<5; return RandState=X; }
+
+static uint32_t Count = 1000000;                                      // [sec] seconds checked and timed per plan
+static int      Help  =       0;
+
+class FreqSched                                                       // the schedule as it was tried in FreqPlan
+{ public:
+   static const uint8_t SchedLen=16;                                  // [sec] precomputed ahead: must be a power of 2
+   const FreqPlan *Plan;
+   uint32_t SchedTime[SchedLen];                                      // [sec] UTC time for which every entry was computed
+   uint8_t  SchedChan[SchedLen][4];                                   // channels for [Slot*2+OGN]
+
+  public:
+   void setPlan(const FreqPlan *Plan)
+   { this->Plan=Plan;
+     for(uint8_t Idx=0; Idx<SchedLen; Idx++) SchedTime[Idx]=Idx+1; } // cannot match: entry Idx is only for times with same lower bits
+
+   uint8_t getChannel(uint32_t Time, uint8_t Slot=0, uint8_t OGN=1)
+   { uint8_t Idx = Time&(SchedLen-1);
+     if(SchedTime[Idx]!=Time) Prepare(Time);                          // time jump: recompute the schedule from now on
+     return SchedChan[Idx][(Slot<<1)|OGN]; }
+
+   void Prepare(uint32_t Time)                                        // fill the schedule for the next SchedLen seconds: only the stale entries
+   { for(uint8_t Sec=0; Sec<SchedLen; Sec++, Time++)
+     { uint8_t Idx = Time&(SchedLen-1);
+       if(SchedTime[Idx]==Time) continue;
+       for(uint8_t Slot=0; Slot<2; Slot++)
+         for(uint8_t OGN=0; OGN<2; OGN++)
+           SchedChan[Idx][(Slot<<1)|OGN] = Plan->getChannel(Time, Slot, OGN);
+       SchedTime[Idx]=Time; }
+   }
+
+} ;
+
+static FreqPlan  Plan;
+static FreqSched Sched;
+
+static uint32_t Check(uint32_t Time)                                  // compare one second, both slots, OGN and FLARM
+{ uint32_t Err=0;
+  for(uint8_t Slot=0; Slot<2; Slot++)
+    for(uint8_t OGN=0; OGN<2; OGN++)
+      if(Sched.getChannel(Time, Slot, OGN)!=Plan.getChannel(Time, Slot, OGN)) Err++;
+  return Err; }
+
+static uint32_t TestPlan(uint8_t PlanNo)
+{ Plan.setPlan(PlanNo); Sched.setPlan(&Plan);
+  uint32_t Err=0;
+  uint32_t Time=1700000000;                                          // consecutive seconds, with Prepare() ahead
+  for(uint32_t Sec=0; Sec<Count; Sec++, Time++)
+  { Err+=Check(Time); Sched.Prepare(Time+1); }
+  Time=0xFFFFFFFF-Count/2;                                           // across the 32-bit wrap-around, without Prepare()
+  for(uint32_t Sec=0; Sec<Count; Sec++, Time++) Err+=Check(Time);
+  for(uint32_t Jump=0; Jump<Count/16; Jump++)                        // random time jumps: forward, backward, small and large
+  { Time = (Random()&1) ? Random() : Time+(Random()%64)-32;
+    Err+=Check(Time); Err+=Check(Time+1); }
+  return Err; }
+
+static volatile uint32_t Sink;                                        // keeps the benchmark loops from being optimized out
+
+static void BenchSched(uint8_t PlanNo)                                // [ns] per slot start: two channels from the schedule
+{ Plan.setPlan(PlanNo); Sched.setPlan(&Plan);
+  uint32_t Time=1700000000, Sum=0;
+  double Start=getTime();
+  for(uint32_t Sec=0; Sec<Count; Sec++, Time++)
+  { Sum+=Sched.getChannel(Time, 0, 1)+Sched.getChannel(Time, 1, 1);
+    Sched.Prepare(Time+1); }
+  double Total=getTime()-Start;
+  Sched.Prepare(Time);                                               // time the lookups alone, the schedule is ready
+  Start=getTime();
+  for(uint32_t Sec=0; Sec<Count; Sec++) Sum+=Sched.getChannel(Time+(Sec&7), 0, 1)+Sched.getChannel(Time+(Sec&7), 1, 1);
+  double Lookup=getTime()-Start;
+  Sink=Sum;
+  printf(" %7.1f %7.1f", 1e9*Lookup/Count, 1e9*Total/Count); }
+
+static void BenchHash(uint8_t PlanNo)                                 // [ns] per slot start: two channels from the hash
+{ Plan.setPlan(PlanNo);
+  uint32_t Time=1700000000, Sum=0;
+  double Start=getTime();
+  for(uint32_t Sec=0; Sec<Count; Sec++, Time++)
+    Sum+=Plan.getChannel(Time, 0, 1)+Plan.getChannel(Time, 1, 1);
+  double Hash=getTime()-Start;
+  Sink=Sum;
+  printf(" %7.1f", 1e9*Hash/Count); }
+
+int main(int argc, char *argv[])
+{
+  for(int arg=1; arg<argc; arg++)
+  { const char *Val = argv[arg]; if(Val[0]!='-') { Help=1; break; }
+    switch(Val[1])
+    { case 'h': Help=1; break;
+      case 'n': Count=atoi(Val+2); break;
+      case 's': RandState=strtoul(Val+2, 0, 0); break;
+      default: Help=1; break;
+    }
+  }
+  if(Count<16 || RandState==0) Help=1;
+
+  if(Help)
+  { printf("Usage: %s [options]\n\
+Options: -h          this help\n\
+         -n<count>   seconds checked and timed per plan [%u]\n\
+         -s<seed>    random generator seed (non-zero)\n\
+", argv[0], Count);
+    return 0; }
+
+  uint32_t Fail=0;
+  printf("Plan                 errors  lookup +prepare   hash [ns/slot start]\n");
+  for(uint8_t PlanNo=0; PlanNo<7; PlanNo++)
+  { uint32_t Err=TestPlan(PlanNo); Fail+=Err;
+    printf("%d %-18s %6u", PlanNo, FreqPlan::getPlanName(PlanNo), Err);
+    BenchSched(PlanNo); BenchHash(PlanNo);
+    printf("\n"); }
+  printf("Schedule: %d bytes, %s\n", (int)sizeof(FreqSched)-(int)sizeof(const FreqPlan *), Fail ? "FAILED":"PASSED");
+  return Fail!=0; }
@@ -0,0 +1,324 @@
+// GPS pipeline replay: recorded GPS output, raw bytes or serial_dump lines, goes through NMEA_RxMsg/UBX_RxMsg
+// and GPS_Position (ReadNMEA, ReadGSV, ReadUBX, calcDifferentials) and the position pipe as vTaskGPS does.
+// Reports the parser throughput, the cost per sentence type and the simulated 1ms-tick latency from the start
+// of every GPS burst till the position is ready, for one frame per tick and for draining the UART per tick.
+// Builds from the firmware sources in ../main, thus measures the parser which goes into the tracker.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <stdarg.h>
+
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include "../main/ogn.h"                                              // the firmware headers, not the copies here
+
+static double getTime(void)                                           // read the system time at this very moment
+{ struct timespec now; clock_gettime(CLOCK_MONOTONIC, &now); return now.tv_sec + 1e-9*now.tv_nsec; }
+
+static uint32_t RandState = 0x12345678;                               // simple xorshift generator: reproducible between runs and platforms
+
+static uint32_t Random(void)
+{ uint32_t X=RandState; X^=X<<13; X^=X>>17; X^=X<<5; return RandState=X; }
+
+static int    BaudRate =  115200;                                     // [bps] GPS serial port speed: byte arrival times
+static int    Repeat   =      20;                                     // number of parser throughput passes
+static int    GenSecs  =       0;                                     // [sec] generate a synthetic NMEA stream instead of reading files
+static int    Jitter   =       0;                                     // [ms] random extra wait of the GPS task per tick
+static int    Verbose  =       0;                                     // print every position when ready
+static int    Help     =       0;
+
+class RxChunk                                                         // bytes sent back-to-back by the GPS from the given time
+{ public:
+   double      Time;                                                 // [ms]
+   std::string Data;
+} ;
+
+static std::vector<RxChunk> Input;
+
+// ----------------------------------------------------------------------------------------------------------------
+
+static int ReadDump(FILE *File)                                       // serial_dump output: "SS.sss [len] [err] line<0D>"
+{ char Line[512]; double Prev=0, Base=0; int Lines=0;
+  while(fgets(Line, sizeof(Line), File))
+  { double Sec; int Len, Err, Pos=0;
+    if(sscanf(Line, "%lf [%d] [%d] %n", &Sec, &Len, &Err, &Pos)<3 || Pos==0) continue;
+    if(Sec+Base<Prev-30) Base+=60;                                   // seconds wrap around every minute
+    Prev=Sec+Base;
+    char *Data=Line+Pos; char *End=strchr(Data, '<'); if(End) *End=0;
+    RxChunk Chunk; Chunk.Time=1000*Prev; Chunk.Data=Data; Chunk.Data+="\r\n";
+    Input.push_back(Chunk); Lines++; }
+  return Lines; }
+
+static int ReadRaw(FILE *File)                                        // raw bytes: taken as sent continuously at the baud rate
+{ RxChunk Chunk; Chunk.Time = Input.empty() ? 0 : Input.back().Time+1000;
+  char Block[4096]; size_t Len;
+  while((Len=fread(Block, 1, sizeof(Block), File))>0) Chunk.Data.append(Block, Len);
+  if(Chunk.Data.empty()) return 0;
+  Input.push_back(Chunk); return Chunk.Data.size(); }
+
+static int ReadFile(const char *Name)
+{ FILE *File=fopen(Name, "rb"); if(File==0) { printf("Cannot open %s for read\n", Name); return 0; }
+  char Head[32]; size_t Len=fread(Head, 1, sizeof(Head)-1, File); Head[Len]=0; rewind(File);
+  double Sec; int LineLen, Err;
+  int Count = sscanf(Head, "%lf [%d] [%d]", &Sec, &LineLen, &Err)==3 ? ReadDump(File):ReadRaw(File);
+  fclose(File); return Count; }
+
+static void AddNMEA(RxChunk &Chunk, const char *Format, ...)          // append a sentence with its checksum
+{ char Line[120]; va_list Args; va_start(Args, Format);
+  int Len=vsnprintf(Line+1, sizeof(Line)-8, Format, Args); va_end(Args);
+  Line[0]='$'; Len++;
+  uint8_t Check=0; for(int Idx=1; Idx<Len; Idx++) Check^=Line[Idx];
+  Len+=sprintf(Line+Len, "*%02X\r\n", Check);
+  Chunk.Data.append(Line, Len); }
+
+static void Generate(int Secs)                                        // GGA+RMC+GSA+4xGSV every second, a slow turn with a climb
+{ double Lat=46.0, Lon=6.0, Alt=1500, Hdg=0;
+  for(int Sec=0; Sec<Secs; Sec++)
+  { RxChunk Chunk; Chunk.Time=1000.0*Sec+50;                         // bursts start 50ms after the PPS
+    int Hour=(12+Sec/3600)%24, Min=(Sec/60)%60, S=Sec%60;
+    double LatMin=(Lat-floor(Lat))*60, LonMin=(Lon-floor(Lon))*60;
+    AddNMEA(Chunk, "GPGGA,%02d%02d%02d.00,%02d%08.5f,N,%03d%08.5f,E,1,09,0.9,%.1f,M,48.0,M,,",
+            Hour, Min, S, (int)Lat, LatMin, (int)Lon, LonMin, Alt);
+    AddNMEA(Chunk, "GPGSA,A,3,01,03,06,09,12,17,19,22,28,,,,1.6,0.9,1.3");
+    for(int Msg=1; Msg<=4; Msg++)
+      AddNMEA(Chunk, "GPGSV,4,%d,14,%02d,45,120,%02d,%02d,30,200,%02d,%02d,60,300,%02d,%02d,10,050,%02d",
+              Msg, Msg*4, 30+Msg, Msg*4+1, 35, Msg*4+2, 40, Msg*4+3, 25+Msg);
+    AddNMEA(Chunk, "GPRMC,%02d%02d%02d.00,A,%02d%08.5f,N,%03d%08.5f,E,%.1f,%.1f,150624,,,A",
+            Hour, Min, S, (int)Lat, LatMin, (int)Lon, LonMin, 50.0, Hdg);
+    Input.push_back(Chunk);
+    Lat+=25.0/111e3*cos(Hdg*M_PI/180); Lon+=25.0/111e3/cos(Lat*M_PI/180)*sin(Hdg*M_PI/180);
+    Alt+=1.5; Hdg=fmod(Hdg+3, 360); }
+}
+
+// ----------------------------------------------------------------------------------------------------------------
+
+class ParseCost                                                       // per-sentence parse time for one sentence type
+{ public:
+   const char *Name;
+   uint32_t    Count;
+   double      Time;                                                 // [sec]
+   void Add(double Sec) { Count++; Time+=Sec; }
+   void Print(void) const
+   { if(Count) printf("  %-6s %8u sentences %7.1f ns/sentence\n", Name, Count, 1e9*Time/Count); }
+} ;
+
+class GPS_Replay                                                      // the data path of vTaskGPS without the RTOS and the hardware
+{ public:
+   static const uint8_t PipeSize = 4;                                // as GPS_PosPipeSize
+   NMEA_RxMsg   NMEA;
+   UBX_RxMsg    UBX;
+   GPS_Time     DateTime;
+   GPS_Position Pos[PipeSize];
+   uint8_t      PosIdx;
+   uint16_t     PosPeriod;                                           // [ms]
+   uint32_t     TimeSinceLock;
+   bool         GGA, RMC, GSA, Active, Complete;                     // burst flags
+   double       BurstStart;                                          // [ms] arrival of the first byte of the burst
+   std::vector<float> Latency;                                       // [ms] burst start to position ready
+   uint32_t     Sentences, Frames, BadCheck, Ready, Valid;
+   ParseCost    Cost[6];
+   bool         Timed;                                               // time every ReadNMEA/ReadUBX call
+
+  public:
+   GPS_Replay() { Clear(); }
+
+   void Clear(void)
+   { NMEA.Clear(); UBX.Clear(); DateTime.setDefaultDate(); DateTime.setDefaultTime();
+     for(uint8_t Idx=0; Idx<PipeSize; Idx++) Pos[Idx].Clear();
+     PosIdx=0; PosPeriod=0; TimeSinceLock=0;
+     GGA=RMC=GSA=Active=Complete=0; BurstStart=0;
+     Latency.clear(); Sentences=Frames=BadCheck=Ready=Valid=0;
+     const char *Name[6] = { "GGA", "RMC", "GSA", "GSV", "other", "UBX" };
+     for(int Idx=0; Idx<6; Idx++) { Cost[Idx].Name=Name[Idx]; Cost[Idx].Count=0; Cost[Idx].Time=0; }
+     Timed=0; }
+
+   void Start(double Time) { Active=1; BurstStart=Time; }
+   void End(void)          { Active=Complete=GGA=RMC=GSA=0; }
+
+   void BurstComplete(double Time)                                   // as GPS_BurstComplete(): the position becomes ready
+   { Complete=1;
+     Latency.push_back(Time-BurstStart);
+     GPS_Position &Cur=Pos[PosIdx];
+     if(Cur.hasGPS) { Cur.isReady=1; Ready++; }
+     if(Cur.isValid())
+     { Valid++; Cur.calcLatitudeCosine(); TimeSinceLock++;
+       if(TimeSinceLock>1)                                           // differentials with the position at least 0.95sec back
+       { uint8_t Prev=(PosIdx+PipeSize-1)%PipeSize;
+         int16_t TimeDiff=Cur.calcTimeDiff(Pos[Prev]);
+         for( ; ; )
+         { if(TimeDiff>=950) break;
+           uint8_t Prev2=(Prev+PipeSize-1)%PipeSize;
+           if(Prev2==PosIdx || !Pos[Prev2].isValid()) break;
+           TimeDiff=Cur.calcTimeDiff(Pos[Prev2]); Prev=Prev2; }
+         Cur.calcDifferentials(Pos[Prev]); }
+       if(Verbose)
+       { char Line[128]; Cur.PrintLine(Line); printf("%9.3fs %s", 1e-3*Time, Line); }
+     }
+     else TimeSinceLock=0;
+     uint8_t Next=(PosIdx+1)%PipeSize;
+     if(Cur.isTimeValid() && Pos[Next].isTimeValid())
+     { int32_t Period=Cur.calcTimeDiff(Pos[Next]);
+       if(Period>0) PosPeriod=(Period+PipeSize/2)/(PipeSize-1); }
+     Pos[Next].Clear(); Pos[Next].copyTime(Cur); Pos[Next].incrTimeFrac(PosPeriod);
+     Pos[Next].copyBaro(Cur, (int16_t)PosPeriod);
+     PosIdx=Next; }
+
+   void CheckComplete(double Time)
+   { if(Active && !Complete && GGA && RMC && GSA) BurstComplete(Time); }
+
+   void ProcessNMEA(double Time)                                     // as GPS_NMEA()
+   { int Type=4;
+     if(NMEA.isGxGSV()) Type=3;
+     else if(NMEA.isGxRMC())
+     { int8_t SameTime=DateTime.ReadTime((const char *)NMEA.ParmPtr(0));
+       if(SameTime==0 && GGA) { if(!Complete) BurstComplete(Time); End(); Start(Time); }
+       DateTime.ReadDate((const char *)NMEA.ParmPtr(8));
+       RMC=1; Type=1; }
+     else if(NMEA.isGxGGA())
+     { int8_t SameTime=DateTime.ReadTime((const char *)NMEA.ParmPtr(0));
+       if(SameTime==0 && RMC) { if(!Complete) BurstComplete(Time); End(); Start(Time); }
+       GGA=1; Type=0; }
+     else if(NMEA.isGxGSA()) { GSA=1; Type=2; }
+     double Start = Timed ? getTime():0;
+     GPS_Position &Cur=Pos[PosIdx];
+     if(Type==3) Cur.ReadGSV(NMEA);
+            else Cur.ReadNMEA(NMEA);
+     if(Timed) Cost[Type].Add(getTime()-Start);
+     Sentences++; }
+
+   void ProcessUBX(void)
+   { double Start = Timed ? getTime():0;
+     Pos[PosIdx].ReadUBX(UBX);
+     if(Timed) Cost[5].Add(getTime()-Start); }
+
+   bool Frame(double Time)                                           // check for a complete frame after a byte, process it
+   { bool Done=0;
+     if(NMEA.isComplete())
+     { if(NMEA.isChecked()) { ProcessNMEA(Time); Done=1; } else BadCheck++;
+       NMEA.Clear(); }
+     if(UBX.isComplete()) { ProcessUBX(); UBX.Clear(); Done=1; }
+     if(Done) Frames++;
+     return Done; }
+
+   int Process(const uint8_t *Data, int Bytes, double Time, bool OneFrame) // bytes read in one tick: return the number taken
+   { int Idx=0;
+     while(Idx<Bytes)
+     { if(!OneFrame && !UBX.isLoading())                                   // drain: printable NMEA body in one scan, as vTaskGPS
+       { Idx+=NMEA.ProcessBlock(Data+Idx, Bytes-Idx); if(Idx>=Bytes) break; }
+       uint8_t Byte=Data[Idx++];
+       NMEA.ProcessByte(Byte); UBX.ProcessByte(Byte);
+       if(Frame(Time))
+       { if(OneFrame) break;                                         // the old vTaskGPS: one frame per tick
+         CheckComplete(Time); }
+     }
+     return Idx; }
+} ;
+
+static GPS_Replay Replay;
+
+// ----------------------------------------------------------------------------------------------------------------
+
+static std::string Stream;                                            // all input bytes
+static std::vector<double> Arrival;                                   // [ms] arrival time of every byte
+
+static void Serialize(void)                                           // bytes with their arrival time at the baud rate
+{ double ByteTime = 10000.0/BaudRate;                                // [ms] per byte: start + 8 data + stop bits
+  double Free=0;                                                     // [ms] when the serial line is free again
+  for(size_t Idx=0; Idx<Input.size(); Idx++)
+  { const RxChunk &Chunk=Input[Idx];
+    double Time = Chunk.Time>Free ? Chunk.Time:Free;
+    for(size_t Byte=0; Byte<Chunk.Data.size(); Byte++)
+    { Time+=ByteTime; Stream+=Chunk.Data[Byte]; Arrival.push_back(Time); }
+    Free=Time; }
+}
+
+static void Throughput(void)                                          // parse everything as fast as possible
+{ double Best=1e9;
+  for(int Rep=0; Rep<Repeat; Rep++)
+  { Replay.Clear();
+    double Start=getTime();
+    Replay.Process((const uint8_t *)Stream.data(), Stream.size(), 0, 0);
+    double Time=getTime()-Start; if(Time<Best) Best=Time; }
+  printf("Parser: %lu bytes %u sentences %u frames %u bad checksums in %5.3f ms => %5.1f MB/s %6.0f ksentences/s\n",
+         (unsigned long)Stream.size(), Replay.Sentences, Replay.Frames, Replay.BadCheck, 1e3*Best,
+         1e-6*Stream.size()/Best, 1e-3*Replay.Frames/Best);
+  printf("Positions: %u ready, %u valid\n", Replay.Ready, Replay.Valid);
+  Replay.Clear(); Replay.Timed=1;                                    // per-sentence cost, including the timer overhead
+  Replay.Process((const uint8_t *)Stream.data(), Stream.size(), 0, 0);
+  for(int Idx=0; Idx<6; Idx++) Replay.Cost[Idx].Print(); }
+
+static void Ticks(bool OneFrame)                                      // vTaskGPS at 1ms ticks: latency from the burst start to position ready
+{ const int BurstTimeout = 100;                                      // [ms] as GPS_BurstTimeout
+  Replay.Clear(); RandState=0x12345678;                              // same tick jitter for both ways
+  size_t Next=0; int Idle=0; size_t MaxQueue=0;
+  double Tick = Arrival.empty() ? 0 : floor(Arrival[0]);
+  while(Next<Stream.size())
+  { int Wait = 1 + (Jitter ? Random()%(Jitter+1) : 0);                // vTaskDelay(1) can wait more than one tick
+    Tick+=Wait;
+    size_t Avail=Next; while(Avail<Stream.size() && Arrival[Avail]<=Tick) Avail++;
+    if(Avail-Next>MaxQueue) MaxQueue=Avail-Next;
+    if(Avail==Next) { Idle+=Wait; }
+    else
+    { if(!Replay.Active) Replay.Start(Arrival[Next]);
+      Next+=Replay.Process((const uint8_t *)Stream.data()+Next, Avail-Next, Tick, OneFrame);
+      Idle=0; }
+    if(Idle==0) Replay.CheckComplete(Tick);                          // as vTaskGPS after reading the UART
+    else if(Idle>=BurstTimeout && Replay.Active)
+    { if(!Replay.Complete && Replay.GGA && Replay.RMC) Replay.BurstComplete(Tick);
+      Replay.End(); }
+  }
+  std::vector<float> &Lat=Replay.Latency;
+  if(Lat.empty()) { printf("%-16s no complete bursts\n", OneFrame ? "frame per tick":"drain per tick"); return; }
+  std::sort(Lat.begin(), Lat.end());
+  double Sum=0; for(size_t Idx=0; Idx<Lat.size(); Idx++) Sum+=Lat[Idx];
+  printf("%-16s %5lu bursts: %6.1f mean %6.1f med %6.1f 99%% %6.1f max [ms] burst start to position, UART queue up to %lu bytes\n",
+         OneFrame ? "frame per tick":"drain per tick", (unsigned long)Lat.size(), Sum/Lat.size(), Lat[Lat.size()/2],
+         Lat[(Lat.size()*99)/100], Lat.back(), (unsigned long)MaxQueue); }
+
+int main(int argc, char *argv[])
+{ std::vector<const char *> Inputs;
+  for(int arg=1; arg<argc; arg++)
+  { const char *Val = argv[arg];
+    if(Val[0]!='-') { Inputs.push_back(Val); continue; }
+    switch(Val[1])
+    { case 'h': Help=1; break;
+      case 'b': BaudRate=atoi(Val+2); break;
+      case 'n': Repeat=atoi(Val+2); break;
+      case 'g': GenSecs=atoi(Val+2); break;
+      case 'j': Jitter=atoi(Val+2); break;
+      case 'v': Verbose=1; break;
+      default: Help=1; break;
+    }
+  }
+  if((Inputs.empty() && GenSecs<=0) || BaudRate<1200 || Repeat<=0 || Jitter<0) Help=1;
+
+  if(Help)
+  { printf("Usage: %s [options] <gps.dump|gps.raw> ...\n\
+Options: -h          this help\n\
+         -b<bps>     GPS serial port baud rate: byte arrival times [%d]\n\
+         -n<count>   number of parser throughput passes [%d]\n\
+         -g<sec>     generate that many seconds of GGA+RMC+GSA+4xGSV instead of reading files\n\
+         -j<ms>      random extra wait of the GPS task per tick, up to that [%d]\n\
+         -v          print every valid position\n\
+Input:   serial_dump output lines (with their times) or raw bytes captured from the GPS port\n\
+", argv[0], BaudRate, Repeat, Jitter);
+    return 0; }
+
+  if(GenSecs>0) Generate(GenSecs);
+  for(size_t Idx=0; Idx<Inputs.size(); Idx++)
+    printf("%d lines/bytes from %s\n", ReadFile(Inputs[Idx]), Inputs[Idx]);
+  Serialize();
+  if(Stream.empty()) return 0;
+
+  Throughput();
+  int Print=Verbose; Verbose=0;
+  Ticks(1);
+  Verbose=Print;
+  Ticks(0);
+  return 0; }
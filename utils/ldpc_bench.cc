@@ -0,0 +1,258 @@
+// LDPC decoder benchmark: feed synthetic codewords with controlled bit errors and erasures
+// through LDPC_Decoder (n208k160) and LDPC_FloatDecoder (n208k160 and n354k160)
+// and report frames/s, mean number of iterations and the frame error rate against the number of errors.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+#include "ldpc.h"
+
+static double getTime(void)                                           // read the system time at this very moment
+{ struct timespec now; clock_gettime(CLOCK_MONOTONIC, &now); return now.tv_sec + 1e-9*now.tv_nsec; }
+
+static uint32_t RandState = 0x12345678;                               // simple xorshift generator: reproducible between runs and platforms
+
+static uint32_t Random(void)
+{ uint32_t X=RandState; X^=X<<13; X^=X>>17; X^=X<<5; return RandState=X; }
+
+static int   Frames     = 2000;                                       // number of frames per point
+static int   MaxErrors  =   16;                                       // scan number of bit errors from zero up to this
+static int   Erasures   =    0;                                       // number of bits marked as Manchester errors (erased)
+static int   MaxIter    =   32;                                       // max. number of decoder iterations (same as RFM_FSK_RxPktData::Decode())
+static int   WithPPM    =    0;                                       // also benchmark the n354k160 code
+static int   WithBatch  =    0;                                       // also benchmark the bit-sliced LDPC_BatchDecoder
+static int   Stall      =    0;                                       // stop LDPC_Decoder when failed checks do not drop for that many iterations
+static int   ChaseFlips =    0;                                       // Chase search over that many least reliable bits after LDPC_Decoder fails
+static int   Help       =    0;
+
+const int MaxCodeWords = 12;                                          // enough for 354 bits
+
+class TestFrame                                                       // a codeword with the error pattern applied to it
+{ public:
+   int      CodeBits;
+   uint32_t Orig[MaxCodeWords];                                       // codeword as transmitted
+   uint32_t Data[MaxCodeWords];                                       // codeword as received
+   uint32_t Err [MaxCodeWords];                                       // bits marked as erased like RFM_FSK_RxPktData::Err[]
+
+  public:
+   void Generate(int CodeBits, int Errors, int Erasures)
+   { this->CodeBits=CodeBits;
+     for(int Idx=0; Idx<MaxCodeWords; Idx++) { Orig[Idx]=0; Err[Idx]=0; }
+     for(int Idx=0; Idx<5; Idx++) Orig[Idx]=Random();                 // 160 random user bits
+#ifdef WITH_PPM
+     if(CodeBits==354) LDPC_Encode_n354k160(Orig); else
+#endif
+     LDPC_Encode(Orig);                                               // append the parity bits
+     for(int Idx=0; Idx<MaxCodeWords; Idx++) Data[Idx]=Orig[Idx];
+     uint32_t Used[MaxCodeWords];
+     for(int Idx=0; Idx<MaxCodeWords; Idx++) Used[Idx]=0;
+     for(int Count=0; Count<Errors+Erasures; )                         // pick distinct bit positions
+     { int Bit=Random()%CodeBits;
+       uint32_t Mask=(uint32_t)1<<(Bit&31); int Idx=Bit>>5;
+       if(Used[Idx]&Mask) continue;
+       Used[Idx]|=Mask;
+       if(Count<Errors) Data[Idx]^=Mask;                              // a plain bit error: the receiver does not know about it
+       else                                                           // an erasure: the Manchester decoder flags it and the bit is random
+       { Err[Idx]|=Mask; if(Random()&1) Data[Idx]^=Mask; }
+       Count++; }
+   }
+
+   bool isCorrect(const uint32_t *Out) const                          // compare decoder output with the transmitted codeword
+   { int Words=CodeBits>>5; int Bits=CodeBits&31;
+     for(int Idx=0; Idx<Words; Idx++)
+       if(Out[Idx]!=Orig[Idx]) return 0;
+     if(Bits==0) return 1;
+     uint32_t Mask=((uint32_t)1<<Bits)-1;
+     return ((Out[Words]^Orig[Words])&Mask)==0; }
+
+} ;
+
+class BenchPoint                                                      // statistics for a single number of errors
+{ public:
+   int    Frames;                                                     // number of frames processed
+   int    Failed;                                                     // number of frames where parity checks did not converge
+   int    Wrong;                                                      // number of frames converged to a wrong codeword (undetected errors)
+   int    IterSum;                                                    // sum of iterations
+   double Time;                                                       // [sec] total decoding time
+
+  public:
+   void Clear(void) { Frames=0; Failed=0; Wrong=0; IterSum=0; Time=0; }
+
+   void Print(int Errors) const
+   { double FER = (double)(Failed+Wrong)/Frames;
+     printf(" %3d %3d  %8.5f %8.5f %6.2f %10.0f\n",
+            Errors, Erasures, FER, (double)Wrong/Frames, (double)IterSum/Frames, Time>0 ? Frames/Time:0.0); }
+} ;
+
+static LDPC_Decoder             HardDecoder;
+static LDPC_FloatDecoder<float> FloatDecoder;
+
+static void BenchHard(BenchPoint &Point, const TestFrame &Frame)      // integer decoder, as used by RFM_FSK_RxPktData::Decode()
+{ uint32_t Out[MaxCodeWords];
+  double Start=getTime();
+  HardDecoder.Input((const uint8_t *)Frame.Data, (const uint8_t *)Frame.Err);
+  int Check=HardDecoder.Process(ChaseFlips ? MaxIter-HardDecoder.ChaseIter:MaxIter, Stall); // as in RFM_FSK_RxPktData::Decode()
+  int Iter=HardDecoder.Iterations;
+  HardDecoder.Output(Out);
+  if(Check && ChaseFlips) Check=HardDecoder.Chase((uint8_t *)Out, ChaseFlips); // in place of the last ChaseIter iterations
+  Point.Time+=getTime()-Start;
+  Point.Frames++; Point.IterSum+=Iter;
+  if(Check) Point.Failed++;
+  else if(!Frame.isCorrect(Out)) Point.Wrong++; }
+
+static void BenchFloat(BenchPoint &Point, const TestFrame &Frame)     // floating point decoder for any code
+{ uint32_t Out[MaxCodeWords];
+  double Start=getTime();
+  FloatDecoder.Input((const uint8_t *)Frame.Data, (const uint8_t *)Frame.Err);
+  int Check=0; int Iter;
+  for(Iter=0; Iter<MaxIter; )
+  { Check=FloatDecoder.ProcessChecks(); Iter++;
+    if(Check==0) break; }
+  FloatDecoder.Output(Out);
+  Point.Time+=getTime()-Start;
+  Point.Frames++; Point.IterSum+=Iter;
+  if(Check) Point.Failed++;
+  else if(!Frame.isCorrect(Out)) Point.Wrong++; }
+
+static void ChaseTime(void)                                           // Chase() against the iterations it replaces, on frames that fail
+{ TestFrame Frame; uint8_t Out[LDPC_Decoder::CodeBytes];
+  double ChaseSum=0, IterSum=0; int Count=0;
+  for(int Idx=0; Idx<Frames; Idx++)
+  { Frame.Generate(208, 10, Erasures);
+    HardDecoder.Input((const uint8_t *)Frame.Data, (const uint8_t *)Frame.Err);
+    if(HardDecoder.Process(MaxIter-HardDecoder.ChaseIter)==0) continue;
+    HardDecoder.Output(Out);
+    double Start=getTime();
+    HardDecoder.Chase(Out, ChaseFlips);
+    double Mid=getTime();
+    HardDecoder.Process(HardDecoder.ChaseIter);
+    IterSum+=getTime()-Mid; ChaseSum+=Mid-Start; Count++; }
+  printf("Chase(%d flips): %5.2fus, %d iterations: %5.2fus per failed frame\n\n",
+         ChaseFlips, 1e6*ChaseSum/Count, HardDecoder.ChaseIter, 1e6*IterSum/Count); }
+
+static void Bench(const char *Name, int CodeBits, void (*Decode)(BenchPoint &, const TestFrame &))
+{ printf("%s: %d frames/point, %d erasures, max. %d iterations\n", Name, Frames, Erasures, MaxIter);
+  printf(" Err Ers       FER  Undet.  Iter.   Frames/s\n");
+  BenchPoint Total; Total.Clear();
+  TestFrame Frame;
+  for(int Errors=0; Errors<=MaxErrors; Errors++)
+  { BenchPoint Point; Point.Clear();
+    for(int Idx=0; Idx<Frames; Idx++)
+    { Frame.Generate(CodeBits, Errors, Erasures);
+      (*Decode)(Point, Frame); }
+    Point.Print(Errors);
+    Total.Frames+=Point.Frames; Total.Time+=Point.Time; Total.IterSum+=Point.IterSum; }
+  printf("Total: %d frames, %6.2f iterations/frame, %8.0f frames/s\n\n",
+         Total.Frames, (double)Total.IterSum/Total.Frames, Total.Frames/Total.Time); }
+
+template <class Word>
+ static void BenchBatch(const char *Name)                             // bit-sliced batch: bulk validation and bit-flip decoding
+{ const int Lanes = LDPC_BatchDecoder<Word>::Lanes;
+  const int CodeWords = LDPC_BatchDecoder<Word>::CodeWords;
+  LDPC_BatchDecoder<Word> *Batch = new LDPC_BatchDecoder<Word>;
+  uint32_t Data[Lanes*CodeWords];
+  uint32_t Out [Lanes*CodeWords];
+  uint8_t  Errors[Lanes];
+  TestFrame Frame[Lanes];
+
+  int Mismatch=0; double CheckTime=0; double BatchTime=0; int Checked=0;  // validation: compare with LDPC_Check() frame-by-frame
+  for(int Count=0; Count<Frames; Count+=Lanes)
+  { for(int Lane=0; Lane<Lanes; Lane++)
+    { Frame[Lane].Generate(208, Lane%4, 0);
+      for(int Idx=0; Idx<CodeWords; Idx++) Data[Lane*CodeWords+Idx]=Frame[Lane].Data[Idx]; }
+    uint8_t Ref[Lanes];
+    double Start=getTime();
+    for(int Lane=0; Lane<Lanes; Lane++)
+      Ref[Lane]=LDPC_Check(Data+Lane*CodeWords);
+    double Mid=getTime();
+    Batch->Input(Data, Lanes);
+    Batch->Check(Errors);
+    double Stop=getTime();
+    CheckTime+=Mid-Start; BatchTime+=Stop-Mid; Checked+=Lanes;
+    for(int Lane=0; Lane<Lanes; Lane++)
+      if(Errors[Lane]!=Ref[Lane]) Mismatch++; }
+  printf("%s: %d lanes\n", Name, Lanes);
+  printf("Check: %d frames, LDPC_Check() %8.0f frames/s, batch %8.0f frames/s, x%4.1f, %d mismatches\n",
+         Checked, Checked/CheckTime, Checked/BatchTime, CheckTime/BatchTime, Mismatch);
+
+  printf(" Err Ers       FER  Undet.   Frames/s\n");                     // decoding: Gallager-B bit-flipping on all lanes at once
+  for(int Errs=0; Errs<=MaxErrors; Errs++)
+  { BenchPoint Point; Point.Clear();
+    for(int Count=0; Count<Frames; Count+=Lanes)
+    { for(int Lane=0; Lane<Lanes; Lane++)
+      { Frame[Lane].Generate(208, Errs, 0);
+        for(int Idx=0; Idx<CodeWords; Idx++) Data[Lane*CodeWords+Idx]=Frame[Lane].Data[Idx]; }
+      double Start=getTime();
+      Batch->Input(Data, Lanes);
+      Word Fail=Batch->Process(MaxIter);
+      Batch->Output(Out, Lanes);
+      Point.Time+=getTime()-Start;
+      for(int Lane=0; Lane<Lanes; Lane++)
+      { Point.Frames++;
+        if((Fail>>Lane)&1) Point.Failed++;
+        else if(!Frame[Lane].isCorrect(Out+Lane*CodeWords)) Point.Wrong++; }
+    }
+    printf(" %3d %3d  %8.5f %8.5f %10.0f\n", Errs, 0,
+           (double)(Point.Failed+Point.Wrong)/Point.Frames, (double)Point.Wrong/Point.Frames, Point.Frames/Point.Time); }
+  printf("\n");
+  delete Batch; }
+
+int main(int argc, char *argv[])
+{
+  for(int arg=1; arg<argc; arg++)
+  { const char *Val = argv[arg]; if(Val[0]!='-') { Help=1; break; }
+    switch(Val[1])
+    { case 'h': Help=1; break;
+      case 'n': Frames=atoi(Val+2); break;
+      case 'e': MaxErrors=atoi(Val+2); break;
+      case 'x': Erasures=atoi(Val+2); break;
+      case 'i': MaxIter=atoi(Val+2); break;
+      case 's': RandState=strtoul(Val+2, 0, 0); break;
+      case 'p': WithPPM=1; break;
+      case 'b': WithBatch=1; break;
+      case 't': Stall=atoi(Val+2); break;
+      case 'c': ChaseFlips=atoi(Val+2); break;
+      default: Help=1; break;
+    }
+  }
+  if(Frames<=0 || MaxIter<=0 || RandState==0) Help=1;
+
+  if(Help)
+  { printf("Usage: %s [options]\n\
+Options: -h          this help\n\
+         -n<frames>  number of frames per point [%d]\n\
+         -e<errors>  scan number of bit errors up to this value [%d]\n\
+         -x<bits>    number of erased (Manchester error) bits per frame [%d]\n\
+         -i<iter>    max. number of decoder iterations [%d]\n\
+         -s<seed>    random generator seed (non-zero)\n\
+         -p          benchmark the n354k160 code as well\n\
+         -b          benchmark the bit-sliced batch decoder as well\n\
+         -t<iter>    stop LDPC_Decoder when failed checks stall for that many iterations [%d]\n\
+         -c<flips>   Chase search over the least reliable bits when LDPC_Decoder fails, up to 8 [%d]\n\
+", argv[0], Frames, MaxErrors, Erasures, MaxIter, Stall, ChaseFlips);
+    return 0; }
+
+  Bench(ChaseFlips ? "LDPC_Decoder+Chase n208k160":"LDPC_Decoder n208k160", 208, BenchHard);
+  if(ChaseFlips) ChaseTime();
+
+  FloatDecoder.Configure(208, 48, (const uint32_t *)LDPC_ParityCheck_n208k160);
+  Bench("LDPC_FloatDecoder n208k160", 208, BenchFloat);
+
+  if(WithBatch)
+  { BenchBatch<uint32_t>("LDPC_BatchDecoder n208k160");
+    BenchBatch<uint64_t>("LDPC_BatchDecoder n208k160"); }
+
+#ifdef WITH_PPM
+  if(WithPPM)
+  { FloatDecoder.Configure(354, 194, (const uint32_t *)LDPC_ParityCheck_n354k160);
+    Bench("LDPC_FloatDecoder n354k160", 354, BenchFloat); }
+#else
+  if(WithPPM) printf("n354k160 code not compiled in: build with -DWITH_PPM\n");
+#endif
+
+  return 0; }
+
@@ -0,0 +1,252 @@
+// Log export benchmark: OGN_LogExport, which streams APRS, IGC and TLG out of a log file in large chunks,
+// against the former HTTP export loops: a read per record, an 800-byte line buffer and a task delay per packet
+// (APRS) or per chunk (IGC, TLG). Both must give the same bytes, from the plain and from the compact log.
+// Reports MB/s on this host and the number of task delays, which on the tracker cost a tick each.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+#include <vector>
+
+#include "../main/logexport.h"                                        // the firmware headers, not the copies here
+
+static double getTime(void)                                           // read the system time at this very moment
+{ struct timespec now; clock_gettime(CLOCK_MONOTONIC, &now); return now.tv_sec + 1e-9*now.tv_nsec; }
+
+static uint32_t RandState = 0x12345678;                               // simple xorshift generator: reproducible between runs and platforms
+
+static uint32_t Random(void)
+{ uint32_t X=RandState; X^=X<<13; X^=X>>17; X^=X<<5; return RandState=X; }
+
+static double RandomFloat(void) { return (Random()&0xFFFFFF)/16777216.0; } // 0..1
+
+static int         Aircrafts =   20;                                  // number of simulated aircraft
+static int         SimTime   = 3600;                                  // [sec] simulated time
+static int         Repeat    =    5;                                  // number of timing passes
+static int         BuffSize  = 4096;                                  // [char] output buffer of the new export
+static double      Tick      =  1.0;                                  // [ms] FreeRTOS tick: CONFIG_FREERTOS_HZ=1000
+static int         Help      =    0;
+
+typedef OGN_LogPacket<OGN1_Packet> LogPacket;
+
+static std::vector<LogPacket> Record;
+static uint32_t FileTime;                                             // [sec] start time of the log
+static uint32_t OwnAddr;                                              // aircraft for the IGC B-records
+static uint8_t  OwnType;
+
+// ----------------------------------------------------------------------------------------------------------------
+
+static int ReadFile(const char *Name)                                 // any .TLG file: plain or compact
+{ OGN_LogReader<OGN1_Packet> *Reader = new OGN_LogReader<OGN1_Packet>;
+  if(Reader->Open(Name)<0) { printf("Cannot open %s for read\n", Name); delete Reader; return 0; }
+  LogPacket Rec; int Count=0;
+  while(Reader->Read(Rec)) { Record.push_back(Rec); Count++; }
+  delete Reader;
+  printf("%d records from %s\n", Count, Name);
+  return Count; }
+
+static void Simulate(void)                                            // gliders circling and cruising, now and then a status
+{ uint32_t Start=1718445600;                                         // [sec] 15.06.2024 10:00 UTC
+  std::vector<double> Lat(Aircrafts), Lon(Aircrafts), Alt(Aircrafts), Head(Aircrafts), RxProb(Aircrafts);
+  std::vector<uint32_t> Addr(Aircrafts);
+  for(int Idx=0; Idx<Aircrafts; Idx++)
+  { Addr[Idx]=0x100000+Random()%0xEFFFFF; Lat[Idx]=46.0+0.2*RandomFloat(); Lon[Idx]=6.0+0.3*RandomFloat();
+    Alt[Idx]=800+1500*RandomFloat(); Head[Idx]=360*RandomFloat(); RxProb[Idx]=Idx ? 0.4+0.6*RandomFloat():1.0; }
+  for(int Sec=0; Sec<SimTime; Sec++)
+  { for(int Idx=0; Idx<Aircrafts; Idx++)
+    { bool Thermal = (Sec/60+Idx)%3!=0;
+      double Turn = Thermal ? 18+2*RandomFloat():2*(RandomFloat()-0.5);
+      double Climb = Thermal ? 1.5+RandomFloat():-1.2+0.4*RandomFloat();
+      Head[Idx]=fmod(Head[Idx]+Turn+360, 360);
+      Lat[Idx]+=25*cos(Head[Idx]*M_PI/180)/111132.0;
+      Lon[Idx]+=25*sin(Head[Idx]*M_PI/180)/(111132.0*cos(Lat[Idx]*M_PI/180));
+      Alt[Idx]+=Climb;
+      if(RandomFloat()>RxProb[Idx]) continue;                        // not received this second
+      LogPacket Rec; OGN1_Packet &Pkt=Rec.Packet;
+      memset(&Pkt, 0, sizeof(Pkt));
+      Pkt.Header.Address=Addr[Idx]; Pkt.Header.AddrType=2;
+      if((Sec+Idx*7)%60==0)
+      { Pkt.Header.NonPos=1; Pkt.Status.Time=(Start+Sec)%60; Pkt.Status.FixQuality=1; Pkt.Status.Satellites=9;
+        Pkt.Status.Pressure=Random()&0x3FFF; Pkt.Status.Voltage=200+Random()%20; Pkt.Status.RadioNoise=Random()&0xFF; }
+      else
+      { Pkt.Position.Time=(Start+Sec)%60; Pkt.Position.FixQuality=1; Pkt.Position.FixMode=1; Pkt.EncodeDOP(6+Random()%3);
+        Pkt.EncodeLatitude(lround(Lat[Idx]*600000)); Pkt.EncodeLongitude(lround(Lon[Idx]*600000));
+        Pkt.EncodeAltitude(lround(Alt[Idx])); Pkt.EncodeSpeed(250); Pkt.EncodeHeading(lround(Head[Idx]*10));
+        Pkt.EncodeTurnRate(lround(Turn*10)); Pkt.EncodeClimbRate(lround(Climb*10)); Pkt.Position.AcftType=1; }
+      Pkt.calcAddrParity();
+      Rec.Flags=0; Rec.Rx=Idx!=0; if(Idx) Rec.SNR=6+Random()%20;
+      Rec.setTime(Start+Sec); Rec.setCheck();
+      Record.push_back(Rec); }
+  }
+  printf("%lu records simulated: %d aircraft for %d sec\n", (unsigned long)Record.size(), Aircrafts, SimTime); }
+
+static int WriteLogs(const char *Plain, const char *Compact)          // both formats, the compact one with its index
+{ FILE *File=fopen(Plain, "wb"); if(File==0) return -1;
+  fwrite(Record.data(), LogPacket::Bytes, Record.size(), File); fclose(File);
+  static OGN_LogZip<OGN1_Packet> Zip; Zip.Clear();
+  static OGN_LogIndex Index; Index.Clear(FileTime);
+  uint8_t Block[OGN_LogZip<OGN1_Packet>::MaxBlockBytes];
+  File=fopen(Compact, "wb"); if(File==0) return -1;
+  fwrite(Zip.Magic(), 1, Zip.MagicLen, File);
+  for(size_t Idx=0; Idx<Record.size(); Idx+=8)                       // batches of 8, as vTaskLOG
+  { int Len=Record.size()-Idx; if(Len>8) Len=8;
+    if(Index.needMark(Record[Idx].getTime(FileTime))) { Index.addMark(ftell(File)); Zip.Clear(); }
+    for(int Rec=0; Rec<Len; Rec++) Index.Add(Record[Idx+Rec]);
+    fwrite(Block, 1, Zip.EncodeBlock(Block, Record.data()+Idx, Len), File); }
+  Index.End=ftell(File); fclose(File);
+  char IndexName[64]; OGN_LogIndex::FileName(IndexName, Compact);
+  return Index.Write(IndexName); }
+
+// ----------------------------------------------------------------------------------------------------------------
+
+class MemSink                                                         // the HTTP response: bytes and chunks
+{ public:
+   std::vector<char> Data;
+   int Chunks, Delays;
+
+  public:
+   void Clear(void) { Data.clear(); Chunks=0; Delays=0; }
+   void Send(const char *Chunk, int Len) { Data.insert(Data.end(), Chunk, Chunk+Len); Chunks++; }
+   static int Send(void *Ctx, const char *Chunk, int Len) { ((MemSink *)Ctx)->Send(Chunk, Len); return Len; }
+} ;
+
+class RefReader                                                       // the former reader: a fread() per plain record
+{ public:
+   OGN_LogReader<OGN1_Packet> Reader;
+   FILE *File; bool Zip;
+
+  public:
+   bool Open(const char *Name)
+   { Zip=Reader.Open(Name)>0; Reader.Close(); File=0;
+     if(Zip) return Reader.Open(Name)>0;
+     File=fopen(Name, "rb"); return File!=0; }
+   bool Read(LogPacket &Rec) { return Zip ? Reader.Read(Rec) : fread(&Rec, Rec.Bytes, 1, File)==1; }
+   void Close(void) { if(File) fclose(File); File=0; Reader.Close(); }
+} ;
+
+static void RefAPRS(const char *Name, MemSink &Sink)                  // the former SendLog_APRS() loop
+{ static RefReader File; File.Open(Name);
+  char Line[1000]; int Len=0; LogPacket Packet;
+  for( ; ; )
+  { if(!File.Read(Packet)) break;
+    if(!Packet.isCorrect()) continue;
+    uint32_t Time = Packet.getTime(FileTime);
+    Len+=Packet.Packet.WriteAPRS(Line+Len, Time);
+    Line[Len++]='\n'; Line[Len]=0;
+    if(Len>850) { Sink.Send(Line, Len); Len=0; }
+    Sink.Delays++; }                                                 // vTaskDelay(1) after every packet
+  File.Close();
+  if(Len) Sink.Send(Line, Len); }
+
+static void RefIGC(const char *Name, MemSink &Sink)                   // the former SendLog_IGC() loop, without the header
+{ static RefReader File; File.Open(Name);
+  char Line[1000]; int Len=0; LogPacket Packet;
+  for( ; ; )
+  { if(!File.Read(Packet)) break;
+    if(!Packet.isCorrect()) continue;
+    uint32_t Time = Packet.getTime(FileTime);
+    Len+=Format_String(Line+Len, "LGNE ");
+    char *APRS=Line+Len;
+    Len+=Packet.Packet.WriteAPRS(Line+Len, Time);
+    Line[Len++]='\n'; Line[Len]=0;
+    bool Own = Packet.Packet.Header.Address==OwnAddr && Packet.Packet.Header.AddrType==OwnType;
+    if(Own && !Packet.Packet.Header.NonPos && !Packet.Packet.Header.Encrypted)
+      Len+=APRS2IGC(Line+Len, APRS, 0);
+    if(Len>=800) { Sink.Send(Line, Len); Len=0; Sink.Delays++; }
+  }
+  File.Close();
+  if(Len) Sink.Send(Line, Len); }
+
+static void RefTLG(const char *Name, MemSink &Sink)                   // the former SendLog_TLG() loop
+{ static OGN_LogReader<OGN1_Packet> File; File.Open(Name);
+  char Line[512] __attribute__((aligned(4)));
+  LogPacket *Packet = (LogPacket *)Line;
+  const int MaxPackets = sizeof(Line)/sizeof(LogPacket);
+  for( ; ; )
+  { int Packets=0;
+    while(Packets<MaxPackets && File.Read(Packet[Packets])) Packets++;
+    if(Packets==0) break;
+    Sink.Send(Line, Packets*Packet->Bytes); Sink.Delays++; }
+  File.Close(); }
+
+static void NewExport(const char *Name, uint8_t Format, MemSink &Sink)
+{ static OGN_LogExport<OGN1_Packet> Export;
+  static std::vector<char> Buff; Buff.resize(BuffSize);
+  Export.Buff=Buff.data(); Export.Size=BuffSize; Export.Format=Format;
+  Export.TrackAddr=OwnAddr; Export.TrackType=OwnType; Export.GeoidSepar=0;
+  Export.Open(Name, FileTime);
+  Export.Run(MemSink::Send, &Sink);
+  Export.Close(); }
+
+static int Compare(const char *Label, const char *Name, uint8_t Format)  // time both, check they give the same bytes
+{ static MemSink Ref, New;
+  double RefTime=1e9, NewTime=1e9;
+  for(int Rep=0; Rep<Repeat; Rep++)
+  { Ref.Clear(); double Start=getTime();
+    if(Format==OGN_LogExport<OGN1_Packet>::FormatAPRS) RefAPRS(Name, Ref);
+    else if(Format==OGN_LogExport<OGN1_Packet>::FormatIGC) RefIGC(Name, Ref);
+    else RefTLG(Name, Ref);
+    double Time=getTime()-Start; if(Time<RefTime) RefTime=Time;
+    New.Clear(); Start=getTime();
+    NewExport(Name, Format, New);
+    Time=getTime()-Start; if(Time<NewTime) NewTime=Time; }
+  bool Same = Ref.Data==New.Data;
+  double MB=1e-6*New.Data.size();
+  printf("%-12s %7.2f MB  former %6.1f MB/s %6d chunks %6d delays (+%5.1f s)   new %6.1f MB/s %5d chunks  x%4.2f  %s\n",
+         Label, MB, MB/RefTime, Ref.Chunks, Ref.Delays, 1e-3*Tick*Ref.Delays, MB/NewTime, New.Chunks, RefTime/NewTime,
+         Same ? "same":"DIFFERENT");
+  return !Same; }
+
+int main(int argc, char *argv[])
+{ std::vector<const char *> Inputs;
+  for(int arg=1; arg<argc; arg++)
+  { const char *Val = argv[arg];
+    if(Val[0]!='-') { Inputs.push_back(Val); continue; }
+    switch(Val[1])
+    { case 'h': Help=1; break;
+      case 'a': Aircrafts=atoi(Val+2); break;
+      case 't': SimTime=atoi(Val+2); break;
+      case 'n': Repeat=atoi(Val+2); break;
+      case 'b': BuffSize=atoi(Val+2); break;
+      case 'T': Tick=atof(Val+2); break;
+      default: Help=1; break;
+    }
+  }
+  if(Aircrafts<1 || SimTime<1 || Repeat<1 || BuffSize<2*OGN_LogExport<OGN1_Packet>::MaxRecordLen || Tick<0) Help=1;
+
+  if(Help)
+  { printf("Usage: %s [options] [log.TLG ...]\n\
+Options: -h          this help\n\
+         -a<count>   simulated aircraft, without input files [%d]\n\
+         -t<sec>     simulated time [%d]\n\
+         -n<count>   number of timing passes [%d]\n\
+         -b<bytes>   output buffer of the new export [%d]\n\
+         -T<ms>      tick period: the cost of a task delay on the tracker [%3.1f]\n\
+", argv[0], Aircrafts, SimTime, Repeat, BuffSize, Tick);
+    return 0; }
+
+  for(size_t Idx=0; Idx<Inputs.size(); Idx++) ReadFile(Inputs[Idx]);
+  if(Inputs.empty()) Simulate();
+  if(Record.empty()) return 0;
+  FileTime=Record[0].getTime(Record[0].Time<<4)&0xFFFFFFF0;
+  OwnAddr=Record[0].Packet.Header.Address; OwnType=Record[0].Packet.Header.AddrType;
+
+  const char *PlainName="logexport_plain.tmp", *ZipName="logexport_zip.tmp";
+  if(WriteLogs(PlainName, ZipName)<0) { printf("Cannot write the test logs\n"); return 1; }
+
+  int Fail=0;
+  Fail+=Compare("APRS plain"  , PlainName, OGN_LogExport<OGN1_Packet>::FormatAPRS);
+  Fail+=Compare("APRS compact", ZipName  , OGN_LogExport<OGN1_Packet>::FormatAPRS);
+  Fail+=Compare("IGC plain"   , PlainName, OGN_LogExport<OGN1_Packet>::FormatIGC);
+  Fail+=Compare("IGC compact" , ZipName  , OGN_LogExport<OGN1_Packet>::FormatIGC);
+  Fail+=Compare("TLG plain"   , PlainName, OGN_LogExport<OGN1_Packet>::FormatTLG);
+  Fail+=Compare("TLG compact" , ZipName  , OGN_LogExport<OGN1_Packet>::FormatTLG);
+
+  char IndexName[64]; OGN_LogIndex::FileName(IndexName, ZipName);
+  remove(PlainName); remove(ZipName); remove(IndexName);
+  printf("%s\n", Fail ? "FAILED":"PASSED");
+  return Fail!=0; }
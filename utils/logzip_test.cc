@@ -0,0 +1,254 @@
+// Compact track log test: OGN_LogPacket records from .TLG files (plain or compact) or from simulated traffic
+// go through OGN_LogZip in FlashLog_Record() batches, are read back with OGN_LogReader and compared.
+// Reports the size against the plain 24-byte records, the bits per record and the coding speed.
+// The sidecar index is built as FlashLog_Record() does: OGN_LogQuery extracts of random time windows and aircraft
+// must give the same records as a scan of the whole file, while reading only the segments which have them.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+#include <vector>
+
+#include "../main/logzip.h"                                           // the firmware headers, not the copies here
+#include "../main/logidx.h"
+
+static double getTime(void)                                           // read the system time at this very moment
+{ struct timespec now; clock_gettime(CLOCK_MONOTONIC, &now); return now.tv_sec + 1e-9*now.tv_nsec; }
+
+static uint32_t RandState = 0x12345678;                               // simple xorshift generator: reproducible between runs and platforms
+
+static uint32_t Random(void)
+{ uint32_t X=RandState; X^=X<<13; X^=X>>17; X^=X<<5; return RandState=X; }
+
+static double RandomFloat(void) { return (Random()&0xFFFFFF)/16777216.0; } // 0..1
+
+static int         Aircrafts =   20;                                  // number of simulated aircraft
+static int         SimTime   = 3600;                                  // [sec] simulated time
+static int         Batch     =    8;                                  // records per FlashLog_Record() call, as vTaskLOG
+static int         Repeat    =   10;                                  // number of timing passes
+static int         Queries   =  200;                                  // number of index queries to check
+static const char *OutName   =    0;                                  // write the compact file
+static int         Help      =    0;
+
+typedef OGN_LogPacket<OGN1_Packet> LogPacket;
+
+static std::vector<LogPacket> Record;
+
+// ----------------------------------------------------------------------------------------------------------------
+
+static int ReadFile(const char *Name)                                 // any .TLG file: plain or compact
+{ OGN_LogReader<OGN1_Packet> *Reader = new OGN_LogReader<OGN1_Packet>;
+  int Format=Reader->Open(Name);
+  if(Format<0) { printf("Cannot open %s for read\n", Name); delete Reader; return 0; }
+  LogPacket Rec; int Count=0;
+  while(Reader->Read(Rec)) { if(!Rec.isCorrect()) continue; Record.push_back(Rec); Count++; }
+  delete Reader;
+  printf("%d records from %s (%s)\n", Count, Name, Format ? "compact":"plain");
+  return Count; }
+
+class SimAcft                                                         // one aircraft: thermalling or cruising
+{ public:
+   uint32_t Address;
+   uint8_t  AcftType;
+   double   Lat, Lon, Alt;                                           // [deg] [deg] [m]
+   double   Speed, Heading, Turn, Climb;                             // [m/s] [deg] [deg/s] [m/s]
+   double   RxProb;                                                  // probability to receive a packet
+   int      SNR;                                                     // [dB] average
+   bool     Own;                                                     // our own transmitted packets
+
+  public:
+   void Init(int Idx)
+   { Address=0x100000+Random()%0xEFFFFF; AcftType=Idx%4==3 ? 2:1;   // gliders and some tow planes
+     Lat=46.0+0.2*RandomFloat(); Lon=6.0+0.3*RandomFloat(); Alt=800+1500*RandomFloat();
+     Speed=AcftType==2 ? 40:22+8*RandomFloat(); Heading=360*RandomFloat();
+     Turn=0; Climb=0; RxProb=0.4+0.6*RandomFloat(); SNR=6+Random()%20; Own=Idx==0; if(Own) RxProb=1; }
+
+   void Step(int Sec)                                                // one second: thermal for 2 minutes, cruise for 1 minute
+   { if(AcftType==1)
+     { bool Thermal = (Sec/60+Address)%3!=0;
+       Turn  = Thermal ? 18+2*RandomFloat():2*(RandomFloat()-0.5);
+       Climb = Thermal ? 1.5+RandomFloat():-1.2+0.4*RandomFloat(); }
+     else { Turn=0.5*(RandomFloat()-0.5); Climb=3.0; }
+     Heading=fmod(Heading+Turn+360, 360);
+     double Dist=Speed;                                              // [m] in one second
+     Lat+=Dist*cos(Heading*M_PI/180)/111132.0;
+     Lon+=Dist*sin(Heading*M_PI/180)/(111132.0*cos(Lat*M_PI/180));
+     Alt+=Climb; }
+
+   void Packet(LogPacket &Rec, int Sec, uint32_t Start) const        // position packet as logged by proc.cpp
+   { OGN1_Packet &Pkt=Rec.Packet;
+     memset(&Pkt, 0, sizeof(Pkt));
+     Pkt.Header.Address=Address; Pkt.Header.AddrType=2; Pkt.Header.Relay=Own ? 0:(Random()%16==0);
+     Pkt.calcAddrParity();
+     Pkt.Position.Time=(Start+Sec)%60; Pkt.Position.FixQuality=1; Pkt.Position.FixMode=1;
+     Pkt.EncodeDOP(6+Random()%3);
+     Pkt.EncodeLatitude(lround(Lat*600000)); Pkt.EncodeLongitude(lround(Lon*600000));
+     Pkt.EncodeAltitude(lround(Alt)); Pkt.setBaroAltDiff(-40+(int)(Alt/100)%3);
+     Pkt.EncodeSpeed(lround(Speed*10)); Pkt.EncodeHeading(lround(Heading*10));
+     Pkt.EncodeTurnRate(lround(Turn*10)); Pkt.EncodeClimbRate(lround(Climb*10));
+     Pkt.Position.AcftType=AcftType;
+     Rec.Flags=0; Rec.Rx=!Own; if(!Own) Rec.SNR=SNR-3+Random()%7;
+     Rec.setTime(Start+Sec); Rec.setCheck(); }
+
+   void Status(LogPacket &Rec, int Sec, uint32_t Start) const        // a status packet every now and then
+   { OGN1_Packet &Pkt=Rec.Packet;
+     memset(&Pkt, 0, sizeof(Pkt));
+     Pkt.Header.Address=Address; Pkt.Header.AddrType=2; Pkt.Header.NonPos=1; Pkt.calcAddrParity();
+     Pkt.Status.Time=(Start+Sec)%60; Pkt.Status.FixQuality=1; Pkt.Status.Satellites=9;
+     Pkt.Status.Pressure=Random()&0x3FFF; Pkt.Status.Voltage=200+Random()%20; Pkt.Status.RadioNoise=Random()&0xFF;
+     Rec.Flags=0; Rec.Rx=!Own; if(!Own) Rec.SNR=SNR;
+     Rec.setTime(Start+Sec); Rec.setCheck(); }
+} ;
+
+static void Simulate(void)
+{ uint32_t Start=1718445600;                                         // [sec] 15.06.2024 10:00 UTC
+  std::vector<SimAcft> Acft(Aircrafts);
+  for(int Idx=0; Idx<Aircrafts; Idx++) Acft[Idx].Init(Idx);
+  for(int Sec=0; Sec<SimTime; Sec++)
+  { for(int Idx=0; Idx<Aircrafts; Idx++)
+    { SimAcft &A=Acft[Idx]; A.Step(Sec);
+      if(RandomFloat()>A.RxProb) continue;                           // not received this second
+      LogPacket Rec;
+      if((Sec+Idx*7)%60==0) A.Status(Rec, Sec, Start); else A.Packet(Rec, Sec, Start);
+      Record.push_back(Rec); }
+  }
+  printf("%lu records simulated: %d aircraft for %d sec\n", (unsigned long)Record.size(), Aircrafts, SimTime); }
+
+// ----------------------------------------------------------------------------------------------------------------
+
+static std::vector<uint8_t> File;                                     // the compact file as FlashLog_Record() writes it
+static OGN_LogIndex Index;                                            // and its index
+static uint32_t FileTime;                                             // [sec] start time of the file
+
+static void Encode(void)
+{ static OGN_LogZip<OGN1_Packet> Zip; Zip.Clear();
+  uint8_t Block[OGN_LogZip<OGN1_Packet>::MaxBlockBytes];
+  File.assign(OGN_LogZip<OGN1_Packet>::Magic(), OGN_LogZip<OGN1_Packet>::Magic()+OGN_LogZip<OGN1_Packet>::MagicLen);
+  Index.Clear(FileTime);
+  for(size_t Idx=0; Idx<Record.size(); Idx+=Batch)
+  { int Len=Record.size()-Idx; if(Len>Batch) Len=Batch;
+    if(Index.needMark(Record[Idx].getTime(FileTime)))                  // new segment: the table starts empty
+    { Index.addMark(File.size()); Zip.Clear(); }
+    for(int Rec=0; Rec<Len; Rec++) Index.Add(Record[Idx+Rec]);
+    int Bytes=Zip.EncodeBlock(Block, Record.data()+Idx, Len);
+    File.insert(File.end(), Block, Block+Bytes); }
+  Index.End=File.size(); }
+
+static int Verify(const char *Name)                                   // read back through the file reader, compare
+{ OGN_LogReader<OGN1_Packet> *Reader = new OGN_LogReader<OGN1_Packet>;
+  Reader->Open(Name);
+  LogPacket Rec; size_t Idx=0; int Errors=0;
+  while(Reader->Read(Rec))
+  { if(Idx>=Record.size() || memcmp(&Rec, &Record[Idx], Rec.Bytes)!=0)
+    { if(Errors<5) printf("Mismatch at record %lu\n", (unsigned long)Idx);
+      Errors++; }
+    Idx++; }
+  delete Reader;
+  if(Idx!=Record.size()) { printf("%lu records read back, %lu written\n", (unsigned long)Idx, (unsigned long)Record.size()); Errors++; }
+  return Errors; }
+
+static int CheckQueries(const char *Name)                              // extracts through the index against a filtered scan
+{ OGN_LogQuery<OGN1_Packet> *Query = new OGN_LogQuery<OGN1_Packet>;
+  int Errors=0; uint64_t Segments=0, Selected=0;
+  for(int Test=0; Test<Queries; Test++)
+  { uint32_t From=0, To=0xFFFFFFFF, Address=0xFFFFFFFF;
+    if(Test%3!=1)                                                    // a time window
+    { From=Index.First+Random()%(Index.Last-Index.First+1);
+      To=From+Random()%900; }
+    if(Test%3!=0)                                                    // one aircraft, now and then one not in the file
+    { Address = Test%17==5 ? 0x00ABCDEF : Index.AcftKey[Random()%Index.Acfts]&0x00FFFFFF; }
+    std::vector<size_t> Expect;
+    for(size_t Idx=0; Idx<Record.size(); Idx++)
+    { const LogPacket &Rec=Record[Idx];
+      if(!Rec.isCorrect()) continue;
+      if(Address!=0xFFFFFFFF && Rec.Packet.Header.Address!=Address) continue;
+      uint32_t Time=Rec.getTime(FileTime); if(Time<From || Time>To) continue;
+      Expect.push_back(Idx); }
+    if(Query->Open(Name, FileTime, From, To, Address)<0 || !Query->Indexed) { printf("Cannot open %s with its index\n", Name); delete Query; return 1; }
+    LogPacket Rec; size_t Count=0;
+    while(Query->Read(Rec))
+    { if(Count>=Expect.size() || memcmp(&Rec, &Record[Expect[Count]], Rec.Bytes)!=0)
+      { if(Errors<5) printf("Query %d: mismatch at record %lu\n", Test, (unsigned long)Count);
+        Errors++; break; }
+      Count++; }
+    if(Count<Expect.size())
+    { if(Errors<5) printf("Query %d: %lu records, expected %lu\n", Test, (unsigned long)Count, (unsigned long)Expect.size());
+      Errors++; }
+    for(int Seg=0; Seg<Index.Marks; Seg++) if(Query->Select(Seg)) Selected++;
+    Segments+=Index.Marks;
+    Query->Close(); }
+  delete Query;
+  printf("Index: %u records, %u aircraft, %u segments; %d queries read %4.1f%% of the segments\n",
+         Index.Packets, Index.Acfts, Index.Marks, Queries, Segments ? 100.0*Selected/Segments:0.0);
+  return Errors; }
+
+static int Decode(void)                                               // decode from memory: the speed of the model alone
+{ static OGN_LogZip<OGN1_Packet> Zip; Zip.Clear();
+  LogZip_BitReader Inp; LogPacket Rec; int Count=0;
+  for(size_t Ptr=OGN_LogZip<OGN1_Packet>::MagicLen; Ptr+4<=File.size(); )
+  { int Len=File[Ptr] | (File[Ptr+1]<<8); int Records=File[Ptr+2];
+    Inp.Start(File.data()+Ptr+4, Len);
+    for(int Idx=0; Idx<Records; Idx++) Count+=Zip.Decode(Inp, Rec);
+    Ptr+=4+Len; }
+  return Count; }
+
+int main(int argc, char *argv[])
+{ std::vector<const char *> Inputs;
+  for(int arg=1; arg<argc; arg++)
+  { const char *Val = argv[arg];
+    if(Val[0]!='-') { Inputs.push_back(Val); continue; }
+    switch(Val[1])
+    { case 'h': Help=1; break;
+      case 'a': Aircrafts=atoi(Val+2); break;
+      case 't': SimTime=atoi(Val+2); break;
+      case 'b': Batch=atoi(Val+2); break;
+      case 'n': Repeat=atoi(Val+2); break;
+      case 'q': Queries=atoi(Val+2); break;
+      case 'o': OutName=Val+2; break;
+      default: Help=1; break;
+    }
+  }
+  if(Aircrafts<1 || SimTime<1 || Batch<1 || Batch>OGN_LogZip<OGN1_Packet>::MaxBlockRecords || Repeat<1 || Queries<0) Help=1;
+
+  if(Help)
+  { printf("Usage: %s [options] [log.TLG ...]\n\
+Options: -h          this help\n\
+         -a<count>   simulated aircraft, without input files [%d]\n\
+         -t<sec>     simulated time [%d]\n\
+         -b<count>   records per block, as per FlashLog_Record() call, up to 32 [%d]\n\
+         -n<count>   number of timing passes [%d]\n\
+         -q<count>   number of index queries to check [%d]\n\
+         -o<file>    write the compact log file and its .TLI index\n\
+", argv[0], Aircrafts, SimTime, Batch, Repeat, Queries);
+    return 0; }
+
+  for(size_t Idx=0; Idx<Inputs.size(); Idx++) ReadFile(Inputs[Idx]);
+  if(Inputs.empty()) Simulate();
+  if(Record.empty()) return 0;
+  FileTime=Record[0].getTime(Record[0].Time<<4)&0xFFFFFFF0;          // the writer names the file after the first batch
+
+  double EncTime=1e9, DecTime=1e9;
+  for(int Rep=0; Rep<Repeat; Rep++)
+  { double Start=getTime(); Encode(); double Time=getTime()-Start; if(Time<EncTime) EncTime=Time;
+    Start=getTime(); Decode(); Time=getTime()-Start; if(Time<DecTime) DecTime=Time; }
+
+  const char *Name = OutName ? OutName:"logzip_test.tmp";
+  FILE *Out=fopen(Name, "wb"); if(Out==0) { printf("Cannot open %s for write\n", Name); return 1; }
+  fwrite(File.data(), 1, File.size(), Out); fclose(Out);
+  char IndexName[64]; OGN_LogIndex::FileName(IndexName, Name);
+  if(Index.Write(IndexName)<0) { printf("Cannot write %s\n", IndexName); return 1; }
+  int Errors=Verify(Name);
+  Errors+=CheckQueries(Name);
+  if(OutName==0) { remove(Name); remove(IndexName); }
+
+  size_t Plain=Record.size()*LogPacket::Bytes;
+  printf("%lu records: %lu bytes plain, %lu bytes compact => %4.2fx, %4.1f bits/record\n",
+         (unsigned long)Record.size(), (unsigned long)Plain, (unsigned long)File.size(),
+         (double)Plain/File.size(), 8.0*File.size()/Record.size());
+  printf("Encode %5.1f ns/record, decode %5.1f ns/record\n", 1e9*EncTime/Record.size(), 1e9*DecTime/Record.size());
+  printf("%s\n", Errors ? "FAILED":"PASSED");
+  return Errors!=0; }
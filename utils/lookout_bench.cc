@@ -0,0 +1,257 @@
+// LookOut trajectory prediction benchmark: random targets around own aircraft are predicted
+// by the scalar Acft_RelPos code, as in LookOut::calcTarget(), one target at a time
+// and by LookOut_Batch, all targets together, and the targets per millisecond are reported for 32/128/512 targets.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+#include "../main/lookout.h"                                         // the firmware headers, not the copies here
+
+// Trajectories of many targets predicted together: positions, direction vectors and speeds are kept
+// in separate arrays (structure-of-arrays) and every step goes over all targets in loops
+// without branches or table lookups, which the compiler can vectorize.
+// Plays the role of StepTillMinSepar() from calcTarget(): finds the time when the separation to own position
+// falls below the given minimum, but on the fixed 2sec step grid of StepFwd2secs()
+
+template <const uint16_t MaxTgts=32>
+ class LookOut_Batch
+{ public:
+   const static uint16_t MaxTargets = MaxTgts;
+   const static int16_t  StepTime   = 4;         // [0.5s] prediction step, like StepFwd2secs()
+
+   uint16_t Targets;                             // number of targets loaded
+    int16_t T;                                   // [0.5s] own position time: targets are aligned to it when loaded
+
+   int32_t X[MaxTgts], Y[MaxTgts], Z[MaxTgts];   // [0.5m]   predicted target positions
+   int32_t Dx[MaxTgts], Dy[MaxTgts];             // [2^-14]  direction vector
+   int32_t Speed[MaxTgts];                       // [0.5m/s] horizontal speed
+   int32_t Climb[MaxTgts];                       // [0.5m/s] zero when not known
+   int32_t RotC[MaxTgts], RotS[MaxTgts];         // [2^-14]  cos/sin of the heading change over one step
+   int32_t MinSepar[MaxTgts];                    // [0.5m]   separation below which the target is a threat
+   int32_t TimeMargin[MaxTgts];                  // [0.5s]   when separation falls below MinSepar, MaxTime+StepTime if never
+   int32_t MissDist[MaxTgts];                    // [0.5m]   closest approach found on the prediction steps
+   int32_t MissTime[MaxTgts];                    // [0.5s]   and when
+  uint16_t Slot[MaxTgts];                        // index of the target in the caller's array
+
+  public:
+   void Clear(int16_t Time=0) { Targets=0; T=Time; }
+
+   static int32_t Sine(uint16_t Angle) { return ((IntSine(Angle)>>16)+1)>>1; } // [2^-14]
+
+   int16_t Add(const Acft_RelPos &Tgt, uint16_t Separ, uint16_t Idx) // add target with given min. separation [0.5m]
+   { if(Targets>=MaxTargets) return -1;
+     uint16_t Lane=Targets++;
+     int32_t dT = T-Tgt.T;                                              // [0.5s] bring the target to own time
+     int32_t Turn = Tgt.hasTurn ? Tgt.Turn:0;
+     uint16_t Heading = Tgt.Heading + ((dT*Turn)>>2);                   // along the mean heading over dT
+     Speed[Lane] = Tgt.Speed;
+     Climb[Lane] = Tgt.hasClimb ? Tgt.Climb:0;
+     X[Lane] = Tgt.X + ((dT*((Icos(Heading)*Speed[Lane]+0x800)>>12))>>1);
+     Y[Lane] = Tgt.Y + ((dT*((Isin(Heading)*Speed[Lane]+0x800)>>12))>>1);
+     Z[Lane] = Tgt.Z + ((dT*Climb[Lane])>>1);
+     Heading = Tgt.Heading + ((dT*Turn)>>1);
+     Dx[Lane] = Icos(Heading)<<2;                                       // [2^-14] direction vector
+     Dy[Lane] = Isin(Heading)<<2;
+     RotC[Lane] = Sine(2*Turn+0x4000);                                  // heading change over one step: must be precise
+     RotS[Lane] = Sine(2*Turn);                                         // as its errors add up over the steps
+     MinSepar[Lane] = Separ;
+     Slot[Lane] = Idx;
+     return Lane; }
+
+   void Step(void)                                   // all targets two seconds forward, as StepFwd2secs()
+   { for(uint16_t Lane=0; Lane<Targets; Lane++)
+     { int32_t dx=Dx[Lane], dy=Dy[Lane], V=Speed[Lane];
+       int32_t x = X[Lane] + ((dx*V+0x2000)>>14);    // first second along the current direction
+       int32_t y = Y[Lane] + ((dy*V+0x2000)>>14);
+       int32_t C=RotC[Lane], S=RotS[Lane];
+       int32_t ndx = (dx*C - dy*S + 0x2000)>>14;     // rotate the direction vector by the turn
+       int32_t ndy = (dy*C + dx*S + 0x2000)>>14;
+       X[Lane] = x + ((ndx*V+0x2000)>>14);           // second second along the new direction
+       Y[Lane] = y + ((ndy*V+0x2000)>>14);
+       Z[Lane] += 2*Climb[Lane];
+       Dx[Lane]=ndx; Dy[Lane]=ndy; }
+   }
+
+   void Check(int32_t OwnX, int32_t OwnY, int32_t OwnZ, int32_t Time) // distances to own position at given time
+   { for(uint16_t Lane=0; Lane<Targets; Lane++)
+     { int32_t dX = abs(X[Lane]-OwnX);
+       int32_t dY = abs(Y[Lane]-OwnY);
+       int32_t dZ = abs(Z[Lane]-OwnZ);
+       int32_t Hor  = dX>dY ? dX+(dY>>1) : dY+(dX>>1);  // same as Acft_RelPos::FastDistance()
+       int32_t Dist = Hor>dZ ? Hor+(dZ>>1) : dZ+(Hor>>1);
+       bool Closer = Dist<MissDist[Lane];
+       MissDist[Lane] = Closer ? Dist:MissDist[Lane];
+       MissTime[Lane] = Closer ? Time:MissTime[Lane];
+       bool Below = (Dist<=MinSepar[Lane]) && (Time<TimeMargin[Lane]);
+       TimeMargin[Lane] = Below ? Time:TimeMargin[Lane]; }
+   }
+
+   void Predict(const Acft_RelPos &Own, int16_t MaxTime) // [0.5s] predict own and all targets up to MaxTime
+   { for(uint16_t Lane=0; Lane<Targets; Lane++)
+     { TimeMargin[Lane]=MaxTime+StepTime; MissDist[Lane]=0x7FFFFFFF; MissTime[Lane]=0; }
+     Acft_RelPos Me=Own;                              // own position predicted by the same code as in calcTarget()
+     for(int16_t Time=0; ; )
+     { Check(Me.X, Me.Y, Me.Z, Time);
+       if(Time>=MaxTime) break;
+       Step(); Me.StepFwd2secs(); Time+=StepTime; }
+   }
+
+} ;
+
+static double getTime(void)                                           // read the system time at this very moment
+{ struct timespec now; clock_gettime(CLOCK_MONOTONIC, &now); return now.tv_sec + 1e-9*now.tv_nsec; }
+
+static uint32_t RandState = 0x12345678;                               // simple xorshift generator: reproducible between runs and platforms
+
+static uint32_t Random(void)
+{ uint32_t X=RandState; X^=X<<13; X^=X>>17; X^=X<<5; return RandState=X; }
+
+static int32_t Random(int32_t Min, int32_t Max) { return Min + Random()%(Max-Min+1); }
+
+static int   Repeat     =  2000;                                      // number of times every target set is predicted
+static int   Range      =  3000;                                      // [m] targets are spread over this horizontal distance
+static int   Help       =     0;
+
+const int16_t MinHorizSepar = 100;                                    // [m] as in LookOut
+const int16_t WarnTime      =  20;                                    // [sec]
+const int16_t MaxTime       = 2*(WarnTime+2);                         // [0.5s] prediction time given to StepTillMinSepar() by calcTarget()
+
+const int MaxTargets = 512;
+
+static Acft_RelPos Own;
+static Acft_RelPos Target[MaxTargets];
+static uint16_t    Separ[MaxTargets];                                 // [0.5m] min. separation per target
+static int16_t     TimeMargin[MaxTargets];                            // [0.5s] result of the scalar prediction
+static LookOut_Batch<MaxTargets> Batch;
+
+static void RandomPos(Acft_RelPos &Pos, int16_t Time)
+{ Pos.Clear(); Pos.Flags=0;
+  Pos.T = Time;
+  Pos.X = 2*Random(-Range, Range);                                   // [0.5m]
+  Pos.Y = 2*Random(-Range, Range);
+  Pos.Z = 2*Random(-150, 150);                                       // mostly within the vertical separation: prediction is needed
+  Pos.Speed = Random(2*15, 2*60);                                    // [0.5m/s]
+  Pos.Heading = Random();
+  if(Random()&3) { Pos.Climb = Random(-6, 6); Pos.hasClimb=1; }      // [0.5m/s]
+  if(Random()&3) { Pos.Turn = Random(-1100, 1100); Pos.hasTurn=1; }  // [360/0x10000 deg/s] up to 6deg/s
+  Pos.Error = 10;                                                    // [0.5m]
+  Pos.calcDir(); }
+
+static void Generate(int Targets)                                     // own aircraft at the origin and targets around
+{ Own.Clear(); Own.Flags=0;
+  Own.Speed=2*30; Own.Heading=Random(); Own.Turn=Random(-400, 400); Own.hasTurn=1;
+  Own.Climb=2; Own.hasClimb=1; Own.Error=10; Own.calcDir();
+  for(int Idx=0; Idx<Targets; Idx++)
+  { RandomPos(Target[Idx], -(int16_t)(Random()%4));                  // targets received up to 1.5sec earlier
+    if((Idx&3)==0)                                                   // every 4th target is on a collision course
+    { Acft_RelPos Meet=Own; for(int Step=Random(2, 10); Step; Step--) Meet.StepFwd2secs();
+      int16_t dX = Meet.X-Target[Idx].X, dY = Meet.Y-Target[Idx].Y;
+      int32_t Speed = 2*Acft_RelPos::FastDistance(dX, dY)/(Meet.T-Target[Idx].T); // [0.5m/s] arrive at the same time
+      if(Speed<=2*80)                                                // if not too fast for an aircraft
+      { Target[Idx].Heading = IntAtan2(dY, dX);
+        Target[Idx].Speed = Speed; Target[Idx].Turn=0; Target[Idx].calcDir(); }
+    }
+    int32_t Vx, Vy; Target[Idx].getSpeedVector(Vx, Vy);
+    int32_t oVx, oVy; Own.getSpeedVector(oVx, oVy);
+    uint16_t RelVel = Acft_RelPos::FastDistance(Vx-oVx, Vy-oVy, Target[Idx].Climb-Own.Climb);
+    Separ[Idx] = 4*RelVel + Own.Error + Target[Idx].Error + 2*MinHorizSepar; } // [0.5m] MinMissDist like calcTarget()
+}
+
+static void PredictScalar(int Targets)                                // StepTillMinSepar() as calcTarget() calls it
+{ for(int Idx=0; Idx<Targets; Idx++)
+  { Acft_RelPos PredMe=Own, PredTgt=Target[Idx];
+    TimeMargin[Idx] = PredMe.StepTillMinSepar(PredTgt, Separ[Idx], MaxTime); }
+}
+
+static void PredictScalarSteps(int Targets)                           // all the 2sec steps, one target at a time: same work as LookOut_Batch
+{ for(int Idx=0; Idx<Targets; Idx++)
+  { Acft_RelPos PredMe=Own, PredTgt=Target[Idx];
+    PredTgt.StepFwd(PredMe.T-PredTgt.T);
+    int16_t Margin=MaxTime+4;
+    for(int16_t Time=0; ; )
+    { if(PredMe.FastDistance(PredTgt)<=Separ[Idx]) { Margin=Time; break; }
+      if(Time>=MaxTime) break;
+      PredMe.StepFwd2secs(); PredTgt.StepFwd2secs(); Time+=4; }
+    TimeMargin[Idx]=Margin; }
+}
+
+static void PredictBatch(int Targets)
+{ Batch.Clear(Own.T);
+  for(int Idx=0; Idx<Targets; Idx++)
+    Batch.Add(Target[Idx], Separ[Idx], Idx);
+  Batch.Predict(Own, MaxTime); }
+
+static double Bench(void (*Predict)(int), int Targets)               // [targets/ms]
+{ double Start=getTime();
+  for(int Rep=0; Rep<Repeat; Rep++) Predict(Targets);
+  double Time=getTime()-Start;
+  return (double)Targets*Repeat/(1e3*Time); }
+
+static int WarnClass(int Margin)                                      // what calcTarget() does with the time margin
+{ if(Margin>2*WarnTime) return 0;                                    // no warning
+  if(Margin>WarnTime) return 1;                                      // first level
+  return 2; }                                                        // closest approach to be refined
+
+static void Compare(int Targets, int &Mismatch, int &Warned)         // LookOut_Batch against the scalar prediction
+{ PredictScalar(Targets);
+  PredictBatch(Targets);
+  Mismatch=0; Warned=0;
+  for(int Lane=0; Lane<Batch.Targets; Lane++)
+  { int Idx=Batch.Slot[Lane];
+    int Class=WarnClass(TimeMargin[Idx]);
+    if(Class) Warned++;
+    if(Class!=WarnClass(Batch.TimeMargin[Lane])) Mismatch++; }
+}
+
+static double MaxPosError(int Targets)                                // [m] position difference after the full prediction time
+{ double MaxErr=0;
+  Batch.Clear(Own.T);
+  for(int Idx=0; Idx<Targets; Idx++) Batch.Add(Target[Idx], Separ[Idx], Idx);
+  for(int16_t Time=0; Time<MaxTime; Time+=4) Batch.Step();
+  for(int Idx=0; Idx<Targets; Idx++)
+  { Acft_RelPos Pred=Target[Idx]; Pred.StepFwd(Own.T-Pred.T);
+    for(int16_t Time=0; Time<MaxTime; Time+=4) Pred.StepFwd2secs();
+    double Err = 0.5*hypot(Batch.X[Idx]-Pred.X, Batch.Y[Idx]-Pred.Y);
+    if(Err>MaxErr) MaxErr=Err; }
+  return MaxErr; }
+
+int main(int argc, char *argv[])
+{
+  for(int arg=1; arg<argc; arg++)
+  { const char *Val = argv[arg]; if(Val[0]!='-') { Help=1; break; }
+    switch(Val[1])
+    { case 'h': Help=1; break;
+      case 'n': Repeat=atoi(Val+2); break;
+      case 'r': Range=atoi(Val+2); break;
+      case 's': RandState=strtoul(Val+2, 0, 0); break;
+      default: Help=1; break;
+    }
+  }
+  if(Repeat<=0 || Range<=0 || Range>8000 || RandState==0) Help=1;
+
+  if(Help)
+  { printf("Usage: %s [options]\n\
+Options: -h          this help\n\
+         -n<count>   number of times every target set is predicted [%d]\n\
+         -r<meters>  targets are spread over that horizontal range [%d]\n\
+         -s<seed>    random generator seed (non-zero)\n\
+", argv[0], Repeat, Range);
+    return 0; }
+
+  printf("Targets StepTillMinSepar  all steps   LookOut_Batch [targets/ms]   warned mismatch max.pos.err\n");
+  const int Sizes[3] = { 32, 128, 512 };
+  for(int Size=0; Size<3; Size++)
+  { int Targets=Sizes[Size];
+    Generate(Targets);
+    double Scalar = Bench(PredictScalar, Targets);
+    double Steps  = Bench(PredictScalarSteps, Targets);
+    double Vector = Bench(PredictBatch, Targets);
+    int Mismatch, Warned; Compare(Targets, Mismatch, Warned);
+    printf("%5d   %12.1f %12.1f %12.1f %20d %8d %8.1fm\n",
+           Targets, Scalar, Steps, Vector, Warned, Mismatch, MaxPosError(Targets)); }
+
+  return 0; }
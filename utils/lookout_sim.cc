@@ -0,0 +1,222 @@
+// LookOut replay: feed recorded traffic from TLG or APRS logs together with an own-ship track
+// through LookOut::ProcessOwn() and ProcessTarget() as vTaskPROC does, at real or accelerated time,
+// print the warning timeline and optionally $PFLAU/$PFLAA, and report the latency of every call.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#include "../main/ogn1.h"                                           // the firmware headers, not the copies here
+#include "../main/ogn.h"
+#include "../main/lookout.h"
+#include "../main/logzip.h"                                           // reads plain and compact .TLG files
+
+static double getTime(void)                                           // read the system time at this very moment
+{ struct timespec now; clock_gettime(CLOCK_MONOTONIC, &now); return now.tv_sec + 1e-9*now.tv_nsec; }
+
+class ReplayEvent                                                     // a position from the logs, own or of another aircraft
+{ public:
+   uint32_t    Time;                                                 // [sec] position time
+   uint32_t    Order;                                                // order in the input: keeps the sort stable
+   bool        Own;                                                  // own position or a target
+   OGN1_Packet Packet;
+
+   bool operator < (const ReplayEvent &Event) const
+   { if(Time!=Event.Time) return Time<Event.Time;
+     return Order<Event.Order; }
+} ;
+
+static std::vector<ReplayEvent> Events;
+
+static double   Speedup  = 100;                                       // replay speed against real time, zero = as fast as possible
+static uint32_t OwnAddr  =   0;                                       // own aircraft picked by address from the inputs
+static int      PrintPFLA = 0;                                        // print $PFLAU/$PFLAA after every own position
+static int      Quiet    =   0;                                       // do not print the warning timeline
+static int      Help     =   0;
+
+static char Line[160];
+
+static LookOut<32> Look;                                              // same size as in proc.cpp
+
+static bool isOwn(const OGN1_Packet &Packet, bool OwnFile, bool Rx)
+{ if(OwnFile) return 1;                                              // everything from the own-ship track
+  if(OwnAddr) return Packet.Header.Address==(OwnAddr&0xFFFFFF);     // the selected aircraft
+  return !Rx; }                                                      // otherwise own transmitted packets from TLG logs
+
+static void AddEvent(const OGN1_Packet &Packet, uint32_t Time, bool Own)
+{ ReplayEvent Event;
+  Event.Time=Time; Event.Order=Events.size(); Event.Own=Own; Event.Packet=Packet;
+  Events.push_back(Event); }
+
+static uint32_t TLGfirst = 0;                                         // [sec] earliest position in the TLG logs: Unix time
+
+static int ReadTLG(const char *FileName, uint32_t FileTime, bool OwnFile) // binary log as written by the tracker
+{ static OGN_LogReader<OGN1_Packet> File;                            // plain or compact, as written with WITH_LOG_ZIP
+  if(File.Open(FileName)<0) { printf("Cannot open %s for read\n", FileName); return 0; }
+  OGN_LogPacket<OGN1_Packet> Packet;
+  int Packets=0;
+  for( ; ; )
+  { if(!File.Read(Packet)) break;                                    // read the next packet from the file
+    if(!Packet.isCorrect()) continue;
+    uint32_t Time=Packet.getTime(FileTime);                          // [sec] get exact time from short time in the packet and the file start time
+    Time=Packet.Packet.getTime(Time);                                // [sec] position time
+    if(Time==0) continue;
+    if(TLGfirst==0 || Time<TLGfirst) TLGfirst=Time;
+    AddEvent(Packet.Packet, Time, isOwn(Packet.Packet, OwnFile, Packet.Rx));
+    Packets++; }
+  File.Close(); return Packets; }
+
+static std::vector<size_t> APRSfirst, APRSlast;                      // events of every APRS file: their times are time-of-day
+
+static int ReadAPRS(const char *FileName, bool OwnFile)               // APRS text, one position per line
+{ FILE *File = fopen(FileName, "rt"); if(File==0) { printf("Cannot open %s for read\n", FileName); return 0; }
+  OGN1_Packet Packet;
+  int Packets=0;
+  uint32_t Day=0; int PrevTime=(-1);
+  APRSfirst.push_back(Events.size());
+  for( ; ; )
+  { if(fgets(Line, sizeof(Line), File)==0) break;
+    int Time=Packet.ReadAPRS(Line); if(Time<0) continue;             // [sec] time-of-day
+    if(PrevTime>=0 && Time+12*60*60<PrevTime) Day+=24*60*60;         // past midnight
+    PrevTime=Time;
+    AddEvent(Packet, Day+Time, isOwn(Packet, OwnFile, 1));
+    Packets++; }
+  APRSlast.push_back(Events.size());
+  fclose(File); return Packets; }
+
+static void DateAPRS(void)                                            // put the APRS times on the date of the TLG logs, which have full Unix time
+{ uint32_t Ref=TLGfirst;
+  if(Ref==0) return;                                                 // APRS only: time-of-day is enough
+  for(size_t File=0; File<APRSfirst.size(); File++)
+  { if(APRSfirst[File]>=APRSlast[File]) continue;
+    uint32_t Base = Ref-Ref%(24*60*60);                              // midnight before the first TLG position
+    uint32_t First = Base+Events[APRSfirst[File]].Time;
+    if(First+12*60*60<Ref) Base+=24*60*60;                           // the day which puts the file start nearest to the TLG logs
+    else if(First>Ref+12*60*60) Base-=24*60*60;
+    for(size_t Idx=APRSfirst[File]; Idx<APRSlast[File]; Idx++)
+      Events[Idx].Time+=Base; }
+}
+
+static int ReadFile(const char *FileName, bool OwnFile)               // TLG files are recognized by their hex time name
+{ const char *ShortName=FileName;
+  for( ; ; )
+  { const char *Slash=strchr(ShortName, '/'); if(Slash==0) break;
+    ShortName=Slash+1; }
+  uint32_t FileTime=0;
+  if(Read_Hex(FileTime, ShortName)==8 && strstr(ShortName, ".TLG")) return ReadTLG(FileName, FileTime, OwnFile);
+  return ReadAPRS(FileName, OwnFile); }
+
+class Latency                                                         // per-call execution time statistics
+{ public:
+   std::vector<float> Time;                                          // [us]
+
+  public:
+   void Add(double Sec) { Time.push_back(1e6*Sec); }
+   void Print(const char *Name)
+   { if(Time.empty()) { printf("%-16s    0 calls\n", Name); return; }
+     std::sort(Time.begin(), Time.end());
+     double Sum=0; for(size_t Idx=0; Idx<Time.size(); Idx++) Sum+=Time[Idx];
+     size_t Calls=Time.size();
+     printf("%-16s %6lu calls %7.2f mean %7.2f med %7.2f 99%% %7.2f max [us]\n",
+            Name, (unsigned long)Calls, Sum/Calls, Time[Calls/2], Time[(Calls*99)/100], Time[Calls-1]); }
+} ;
+
+static Latency OwnLatency, TgtLatency;
+
+static std::map<uint32_t, uint8_t> TgtWarn;                           // last warning level reported for every target ID
+
+static void PrintTime(uint32_t Time)
+{ Time%=24*60*60;
+  printf("%02d:%02d:%02d", Time/3600, (Time/60)%60, Time%60); }
+
+static void PrintWarn(uint32_t Time, const LookOut_Target *Tgt)       // report a change of the warning level
+{ uint8_t &Prev = TgtWarn[Tgt->ID];
+  if(Tgt->WarnLevel==Prev) return;
+  Prev=Tgt->WarnLevel;
+  if(Quiet) return;
+  PrintTime(Time);
+  printf(" %08X W%d %+5.1fs %6.1fm hor:%6.1fm dZ:%+6.1fm\n",
+         Tgt->ID, Tgt->WarnLevel, 0.5*Tgt->MissTime, 0.5*Tgt->MissDist, 0.5*Tgt->HorDist, 0.5*Tgt->dZ); }
+
+static void PrintChar(char Char) { putchar(Char); }
+
+int main(int argc, char *argv[])
+{ std::vector<const char *> Inputs;
+  const char *OwnFile=0;
+  for(int arg=1; arg<argc; arg++)
+  { const char *Val = argv[arg];
+    if(Val[0]!='-') { Inputs.push_back(Val); continue; }
+    switch(Val[1])
+    { case 'h': Help=1; break;
+      case 'x': Speedup=atof(Val+2); break;
+      case 'o': OwnFile=Val+2; break;
+      case 'a': OwnAddr=strtoul(Val+2, 0, 16); break;
+      case 'p': PrintPFLA=1; break;
+      case 'q': Quiet=1; break;
+      default: Help=1; break;
+    }
+  }
+  if(Inputs.empty() || Speedup<0) Help=1;
+
+  if(Help)
+  { printf("Usage: %s [options] <traffic.TLG|traffic.aprs> ...\n\
+Options: -h          this help\n\
+         -o<file>    own-ship track (TLG or APRS), otherwise own transmitted packets in TLG logs\n\
+         -a<hex>     own aircraft address: take its positions from the traffic logs\n\
+         -x<speedup> replay speed against real time, 0 = as fast as possible [%3.1f]\n\
+         -p          print $PFLAU/$PFLAA after every own position\n\
+         -q          do not print the warning timeline\n\
+", argv[0], Speedup);
+    return 0; }
+
+  if(OwnFile) printf("%d positions from %s\n", ReadFile(OwnFile, 1), OwnFile);
+  for(size_t Idx=0; Idx<Inputs.size(); Idx++)
+    printf("%d positions from %s\n", ReadFile(Inputs[Idx], 0), Inputs[Idx]);
+  DateAPRS();
+  std::sort(Events.begin(), Events.end());
+  if(Events.empty()) return 0;
+
+  Look.Clear();
+  uint32_t FirstTime=Events[0].Time;
+  int OwnPositions=0, Warnings=0, MaxWarn=0;
+  double Start=getTime();
+  for(size_t Idx=0; Idx<Events.size(); Idx++)
+  { ReplayEvent &Event=Events[Idx];
+    if(Speedup>0)                                                    // wait for the (accelerated) time of this position
+    { double Wait = Start + (Event.Time-FirstTime)/Speedup - getTime();
+      if(Wait>0) usleep((useconds_t)(1e6*Wait)); }
+    if(Event.Own)
+    { double CallStart=getTime();
+      Look.ProcessOwn(Event.Packet, Event.Time);                     // process own position: warnings are read from all targets below
+      OwnLatency.Add(getTime()-CallStart);
+      OwnPositions++;
+      for(uint8_t Slot=0; Slot<Look.MaxTargets; Slot++)             // warning level changes after all targets are recalculated
+      { const LookOut_Target *Tgt = Look.Target+Slot; if(!Tgt->Alloc) continue;
+        PrintWarn(Event.Time, Tgt); }
+      if(Look.WarnLevel) Warnings++;
+      if(Look.WarnLevel>MaxWarn) MaxWarn=Look.WarnLevel;
+      if(PrintPFLA) Look.WritePFLA(PrintChar); }
+    else
+    { if(!Look.hasPosition) continue;                                // no own position yet
+      double CallStart=getTime();
+      const LookOut_Target *Tgt=Look.ProcessTarget(Event.Packet, Event.Time); // process the received target position
+      TgtLatency.Add(getTime()-CallStart);
+      if(Tgt) PrintWarn(Event.Time, Tgt); }
+  }
+  double Time=getTime()-Start;
+
+  uint32_t Span=Events.back().Time-FirstTime;
+  printf("%lu positions (%d own) over %dsec replayed in %3.1fsec = %3.1fx real time\n",
+         (unsigned long)Events.size(), OwnPositions, Span, Time, Time>0 ? Span/Time:0);
+  printf("%d own positions with a warning, highest level %d\n", Warnings, MaxWarn);
+  OwnLatency.Print("ProcessOwn()");
+  TgtLatency.Print("ProcessTarget()");
+  return 0; }
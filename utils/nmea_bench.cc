@@ -0,0 +1,196 @@
+// NMEA indexer benchmark: GPS_Position::IndexNMEA(), which takes four chars at a time, and the SWAR Read_Dec4()
+// against the char-by-char code they replaced, on sentences from log files (serial dumps, $POGNL logs, NMEA captures)
+// or generated ones, including broken sentences. Results must be identical, for every alignment of the sentence.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <stdarg.h>
+
+#include <vector>
+#include <string>
+
+#include "../main/ogn.h"                                              // the firmware headers, not the copies here
+
+static double getTime(void)                                           // read the system time at this very moment
+{ struct timespec now; clock_gettime(CLOCK_MONOTONIC, &now); return now.tv_sec + 1e-9*now.tv_nsec; }
+
+static uint32_t RandState = 0x12345678;                               // simple xorshift generator: reproducible between runs and platforms
+
+static uint32_t Random(void)
+{ uint32_t X=RandState; X^=X<<13; X^=X>>17; X^=X<<5; return RandState=X; }
+
+static int Repeat  =  20;                                             // number of timing passes
+static int GenLines =  0;                                             // number of sentences to generate
+static int Help    =   0;
+
+static std::vector<std::string> Sentence;
+
+// ----------------------------------------------------------------------------------------------------------------
+
+static int8_t IndexNMEA_Ref(uint8_t Index[24], const char *Seq)      // the former GPS_Position::IndexNMEA(): char by char
+{ int8_t Ptr=0;
+  uint8_t Check=0;
+  if(Seq[Ptr]!='$') return -1;
+  Ptr++;
+  for( ; Ptr<=6; Ptr++)
+  { if(Seq[Ptr]==',') break;
+    Check^=Seq[Ptr]; }
+  if(Seq[Ptr]!=',') return -1;
+  Check^=Seq[Ptr++];
+  Index[0]=Ptr; int8_t Params=1;
+  for( ; ; )
+  { char ch=Seq[Ptr++]; if(ch<' ') return -1;
+    if(ch=='*') break;
+    Check^=ch;
+    if(ch==',') { Index[Params++]=Ptr; }
+  }
+  if(Seq[Ptr++]!=HexDigit(Check>>4)  ) return -2;
+  if(Seq[Ptr++]!=HexDigit(Check&0x0F)) return -2;
+  return Params; }
+
+static int16_t Read_Dec4_Ref(const char *Inp)                         // the former Read_Dec4(): two by two digits
+{ int16_t High=Read_Dec2(Inp  ); if(High<0) return -1;
+  int16_t Low =Read_Dec2(Inp+2); if(Low<0) return -1;
+  return Low + (int16_t)100*(int16_t)High; }
+
+// ----------------------------------------------------------------------------------------------------------------
+
+static int ReadFile(const char *Name)                                 // take every "$..." up to the end of the line
+{ FILE *File=fopen(Name, "rt"); if(File==0) { printf("Cannot open %s for read\n", Name); return 0; }
+  char Line[512]; int Count=0;
+  while(fgets(Line, sizeof(Line), File))
+  { char *Start=strchr(Line, '$'); if(Start==0) continue;
+    size_t Len=strcspn(Start, "\r\n<"); if(Len<8 || Len>120) continue;
+    Sentence.push_back(std::string(Start, Len)); Count++; }
+  fclose(File); return Count; }
+
+static void AddNMEA(const char *Format, ...)                          // a sentence with its checksum
+{ char Line[128]; va_list Args; va_start(Args, Format);
+  int Len=vsnprintf(Line+1, sizeof(Line)-8, Format, Args); va_end(Args);
+  Line[0]='$'; Len++;
+  uint8_t Check=0; for(int Idx=1; Idx<Len; Idx++) Check^=Line[Idx];
+  sprintf(Line+Len, "*%02X", Check);
+  Sentence.push_back(Line); }
+
+static void Generate(int Lines)                                       // typical GPS and $POGNL sentences, some broken
+{ for(int Idx=0; Idx<Lines; Idx++)
+  { int Sec=Idx/7; int Hour=12+(Sec/3600)%12, Min=(Sec/60)%60, S=Sec%60;
+    double Lat=4600+Random()%6000/100.0, Lon=600+Random()%6000/100.0;
+    switch(Idx%7)
+    { case 0: AddNMEA("GPGGA,%02d%02d%02d.00,%09.4f,N,%010.4f,E,1,%02d,0.9,%.1f,M,48.0,M,,",
+                      Hour, Min, S, Lat, Lon, Random()%13, (Random()%30000)/10.0); break;
+      case 1: AddNMEA("GNRMC,%02d%02d%02d.00,A,%09.4f,N,%010.4f,E,%.1f,%.1f,150624,,,A",
+                      Hour, Min, S, Lat, Lon, (Random()%1000)/10.0, (Random()%3600)/10.0); break;
+      case 2: AddNMEA("GPGSA,A,3,01,03,06,09,12,17,19,22,28,,,,1.6,0.9,1.3"); break;
+      case 3: case 4: AddNMEA("GPGSV,4,%d,14,%02d,45,120,31,%02d,30,200,35,%02d,60,300,40,%02d,10,050,26",
+                      Idx%4+1, Random()%32, Random()%32, Random()%32, Random()%32); break;
+      case 5: AddNMEA("POGNL,%02d%02d%02d,3,%06X,1,%.1f,%d,%d", Hour, Min, S, Random()&0xFFFFFF,
+                      (Random()%2000)/10.0, -(int)(Random()%120), Random()%10); break;
+      default: AddNMEA("PGRMZ,%d,F,3", Random()%10000); break;
+    }
+    if((Random()&15)==0)                                             // break one in 16: checksum, control or non-ASCII char
+    { std::string &Line=Sentence.back(); size_t Pos=1+Random()%(Line.size()-1);
+      static const char Bad[4] = { '\t', (char)0xB5, '*', '#' };
+      Line[Pos]=Bad[Random()&3]; }
+  }
+}
+
+// ----------------------------------------------------------------------------------------------------------------
+
+static std::vector<char> Buffer;                                      // all sentences NUL-terminated, at the given alignment
+static std::vector<uint32_t> Offset;
+
+static void Layout(int Align)
+{ Buffer.clear(); Offset.clear();
+  for(size_t Idx=0; Idx<Sentence.size(); Idx++)
+  { while((Buffer.size()&3)!=(size_t)Align) Buffer.push_back(0);
+    Offset.push_back(Buffer.size());
+    Buffer.insert(Buffer.end(), Sentence[Idx].begin(), Sentence[Idx].end()); Buffer.push_back(0); }
+  Buffer.resize(Buffer.size()+8, 0); }                               // the word reads may go past the last NUL
+
+static int Compare(void)                                              // count sentences which index differently
+{ int Mismatch=0;
+  for(int Align=0; Align<4; Align++)
+  { Layout(Align);
+    for(size_t Idx=0; Idx<Offset.size(); Idx++)
+    { const char *Seq=Buffer.data()+Offset[Idx];
+      uint8_t IndexRef[64], IndexNew[64];
+      int8_t Ref=IndexNMEA_Ref(IndexRef, Seq);
+      int8_t New=GPS_Position::IndexNMEA(IndexNew, Seq);
+      bool Same = Ref==New;
+      if(Same && New>0) Same = memcmp(IndexRef, IndexNew, New)==0;
+      if(Same && New>0)                                              // the numbers in the fields as well
+        for(int8_t Parm=0; Parm<New; Parm++)
+          if(Read_Dec4(Seq+IndexNew[Parm])!=Read_Dec4_Ref(Seq+IndexRef[Parm])) Same=0;
+      if(!Same)
+      { if(Mismatch<5) printf("Mismatch [%d] %d/%d: %s\n", Align, Ref, New, Seq);
+        Mismatch++; }
+    }
+  }
+  return Mismatch; }
+
+static volatile int Sink;                                             // keeps the benchmark loops from being optimized out
+
+template <class Func>
+ static double Bench(Func Call)                                       // [ns] per sentence, best pass
+{ double Best=1e9;
+  for(int Rep=0; Rep<Repeat; Rep++)
+  { int Sum=0;
+    double Start=getTime();
+    for(size_t Idx=0; Idx<Offset.size(); Idx++) Sum+=Call(Buffer.data()+Offset[Idx]);
+    double Time=getTime()-Start; if(Time<Best) Best=Time;
+    Sink=Sum; }
+  return 1e9*Best/Offset.size(); }
+
+int main(int argc, char *argv[])
+{ std::vector<const char *> Inputs;
+  for(int arg=1; arg<argc; arg++)
+  { const char *Val = argv[arg];
+    if(Val[0]!='-') { Inputs.push_back(Val); continue; }
+    switch(Val[1])
+    { case 'h': Help=1; break;
+      case 'n': Repeat=atoi(Val+2); break;
+      case 'g': GenLines=atoi(Val+2); break;
+      case 's': RandState=strtoul(Val+2, 0, 0); break;
+      default: Help=1; break;
+    }
+  }
+  if(Inputs.empty() && GenLines==0) GenLines=100000;
+  if(Repeat<=0 || GenLines<0 || RandState==0) Help=1;
+
+  if(Help)
+  { printf("Usage: %s [options] [log files ...]\n\
+Options: -h          this help\n\
+         -n<count>   number of timing passes [%d]\n\
+         -g<lines>   generate that many GPS and $POGNL sentences, 1 in 16 broken [100000 without files]\n\
+         -s<seed>    random generator seed (non-zero)\n\
+", argv[0], Repeat);
+    return 0; }
+
+  if(GenLines) Generate(GenLines);
+  for(size_t Idx=0; Idx<Inputs.size(); Idx++)
+    printf("%d sentences from %s\n", ReadFile(Inputs[Idx]), Inputs[Idx]);
+  if(Sentence.empty()) return 0;
+  size_t Bytes=0; for(size_t Idx=0; Idx<Sentence.size(); Idx++) Bytes+=Sentence[Idx].size();
+
+  int Mismatch=Compare();
+  printf("%lu sentences, %lu bytes, %d mismatches over 4 alignments\n", (unsigned long)Sentence.size(), (unsigned long)Bytes, Mismatch);
+
+  Layout(0);
+  uint8_t Index[64];
+  double Ref = Bench([&](const char *Seq) { return (int)IndexNMEA_Ref(Index, Seq); });
+  double New = Bench([&](const char *Seq) { return (int)GPS_Position::IndexNMEA(Index, Seq); });
+  double AvgLen = (double)Bytes/Sentence.size();
+  printf("IndexNMEA()  char-by-char %6.1f ns %6.1f MB/s   word-wise %6.1f ns %6.1f MB/s   x%4.2f\n",
+         Ref, 1e3*AvgLen/Ref, New, 1e3*AvgLen/New, Ref/New);
+  double DecRef = Bench([&](const char *Seq) { int Sum=0; for(int Pos=1; Seq[Pos+3]; Pos+=4) Sum+=Read_Dec4_Ref(Seq+Pos); return Sum; });
+  double DecNew = Bench([&](const char *Seq) { int Sum=0; for(int Pos=1; Seq[Pos+3]; Pos+=4) Sum+=Read_Dec4(Seq+Pos); return Sum; });
+  printf("Read_Dec4()  two-by-two   %6.1f ns              SWAR      %6.1f ns              x%4.2f [per sentence]\n",
+         DecRef, DecNew, DecRef/DecNew);
+  GPS_Position Pos; Pos.Clear();
+  double Parse = Bench([&](const char *Seq) { return (int)Pos.ReadNMEA(Seq); });
+  printf("ReadNMEA()   %6.1f ns per sentence: index, check and read the fields\n", Parse);
+  return Mismatch!=0; }
@@ -1816,8 +1816,11 @@ class GPS_Position: public GPS_Time
 
   public:
 
+   static uint32_t ZeroBytes(uint32_t Word)                    // 0x80 in every byte of the word which is zero, 0x00 in the others
+   { return ~(((Word&0x7F7F7F7F)+0x7F7F7F7F) | Word | 0x7F7F7F7F); }
+
    int8_t static IndexNMEA(uint8_t Index[20], const char *Seq) // index parameters and verify the NMEA checksum
-   { int8_t Ptr=0;
+   { int Ptr=0;
      uint8_t Check=0;
      if(Seq[Ptr]!='$') return -1;                              // first chat. must be dollar sign
      Ptr++;
@@ -1827,12 +1830,25 @@ class GPS_Position: public GPS_Time
      if(Seq[Ptr]!=',') return -1;                              // comma after the sentence name
      Check^=Seq[Ptr++];                                        // take comma to the checksum
      Index[0]=Ptr; int8_t Params=1;                            // first parameter
+     uint32_t CheckWord=0;                                     // checksum of the chars taken four at a time, folded at the end
      for( ; ; )
-     { char ch=Seq[Ptr++]; if(ch<' ') return -1;               // go through the chars
+     {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+       if((((uintptr_t)(Seq+Ptr))&3)==0)                       // when aligned take four chars at once: an aligned word never crosses past the string page
+       { uint32_t Word; memcpy(&Word, __builtin_assume_aligned(Seq+Ptr, 4), 4);
+         uint32_t Stop = ZeroBytes(Word^0x2A2A2A2A) | ZeroBytes(Word&0xE0E0E0E0) | (Word&0x80808080); // star, control or non-ASCII chars
+         if(Stop==0)                                           // none of them: only commas need attention
+         { for(uint32_t Comma=ZeroBytes(Word^0x2C2C2C2C); Comma; Comma&=Comma-1)
+             Index[Params++] = Ptr+(__builtin_ctz(Comma)>>3)+1; // the first char is in the lowest byte
+           CheckWord^=Word; Ptr+=4; continue; }
+       }                                                       // otherwise go char-by-char through this word
+#endif
+       char ch=Seq[Ptr++]; if(ch<' ') return -1;               // go through the chars
        if(ch=='*') break;                                      // break at star (check-sum should follow)
        Check^=ch;                                              // get chars to the checksum
        if(ch==',') { Index[Params++]=Ptr; }                    // if comma then counr next parameter
      }
+     CheckWord^=CheckWord>>16; CheckWord^=CheckWord>>8; Check^=(uint8_t)CheckWord; // XOR of the four bytes
      if(Seq[Ptr++]!=HexDigit(Check>>4)  ) return -2;           // verify checksum
      if(Seq[Ptr++]!=HexDigit(Check&0x0F)) return -2;
      // printf("%s => [%d]\n", Seq, Params);
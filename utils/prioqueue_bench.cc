@@ -0,0 +1,191 @@
+// Relay queue benchmark: OGN_PrioQueueTree with the ID hash, the Fenwick rank tree and the time lists, against
+// OGN_PrioQueueLinear which scans all slots in addNew(), getRand() and cleanTime() and re-scans for the lowest rank.
+// Both are fed the same simulated reception at several queue sizes: aircraft sending every second, some packets
+// failing the decode, some with unknown time, relay picks every second and the clean-up of old packets.
+// The tree queue is checked after every step: rank sum, lowest rank, previous packet of the same ID,
+// rank-proportional pick equal to the linear scan and no old packet left after the clean-up.
+// Shows as well which of the two OGN_PrioQueue takes at every size.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <vector>
+
+#include "../main/ogn.h"                                              // the firmware headers, not the copies here
+
+static double getTime(void)                                           // read the system time at this very moment
+{ struct timespec now; clock_gettime(CLOCK_MONOTONIC, &now); return now.tv_sec + 1e-9*now.tv_nsec; }
+
+static uint32_t RandState = 0x12345678;                               // simple xorshift generator: reproducible between runs and platforms
+
+static uint32_t Random(void)
+{ uint32_t X=RandState; X^=X<<13; X^=X>>17; X^=X<<5; return RandState=X; }
+
+static int    AcftFactor =    2;                                      // simulated aircraft per queue slot
+static int    SimTime    = 3600;                                      // [sec] simulated time
+static int    Relays     =    2;                                      // relay picks per second
+static int    Delay      =   20;                                      // [sec] packets older than this are cleaned
+static int    Repeat     =    5;                                      // number of timing passes
+static int    Help       =    0;
+
+// ----------------------------------------------------------------------------------------------------------------
+
+class RxEvent                                                         // what the queue sees: a packet, a relay pick or the clean-up
+{ public:
+   static const uint8_t Recv  = 0;                                    // decoded packet: getNew() and addNew()
+   static const uint8_t Fail  = 1;                                    // packet which failed the decode: getNew() only
+   static const uint8_t Relay = 2;                                    // getRand() and decrRank()
+   static const uint8_t Clean = 3;                                    // cleanTime()
+   uint8_t  Type;
+   uint8_t  Time;                                                     // [sec] Position.Time or the time to clean
+   uint8_t  Rank;
+   uint32_t Value;                                                    // address-and-type or the random number
+} ;
+
+static std::vector<RxEvent> Event;
+static int Packets;                                                   // decoded packets in the simulation
+
+static void Simulate(int Aircrafts)
+{ Event.clear(); Packets=0;
+  std::vector<uint32_t> Addr(Aircrafts); std::vector<uint8_t> Prob(Aircrafts);
+  for(int Idx=0; Idx<Aircrafts; Idx++)
+  { Addr[Idx]=((1+Random()%3)<<24) | (Random()&0x00FFFFFF); Prob[Idx]=64+Random()%192; }
+  for(int Sec=0; Sec<SimTime; Sec++)
+  { for(int Idx=0; Idx<Aircrafts; Idx++)
+    { if((Random()&0xFF)>=Prob[Idx]) continue;                       // not received this second
+      RxEvent Ev; Ev.Value=Addr[Idx]; Ev.Time=Sec%60; Ev.Rank=Random()%48;
+      uint32_t Dice=Random()%100;
+      Ev.Type = Dice<5 ? RxEvent::Fail:RxEvent::Recv;
+      if(Dice>=97) { Ev.Time=60+(Random()&3); Ev.Rank=0; }           // unknown time: no rank, cleaned at once
+      if(Ev.Type==RxEvent::Recv) Packets++;
+      Event.push_back(Ev); }
+    for(int Idx=0; Idx<Relays; Idx++)
+    { RxEvent Ev; Ev.Type=RxEvent::Relay; Ev.Time=0; Ev.Rank=0; Ev.Value=Random(); Event.push_back(Ev); }
+    RxEvent Ev; Ev.Type=RxEvent::Clean; Ev.Time=(Sec+60-Delay%60)%60; Ev.Rank=0; Ev.Value=0; Event.push_back(Ev); }
+}
+
+template <class Queue>
+ static uint32_t Run(Queue &RelayQueue)                               // one pass over the events: return a checksum of the picks
+{ uint32_t Check=0;
+  RelayQueue.Clear();
+  for(size_t Idx=0; Idx<Event.size(); Idx++)
+  { const RxEvent &Ev=Event[Idx];
+    if(Ev.Type<=RxEvent::Fail)
+    { uint8_t Slot=RelayQueue.getNew();
+      OGN_RxPacket<OGN1_Packet> *RxPacket=RelayQueue[Slot];
+      RxPacket->Packet.setAddressAndType(Ev.Value); RxPacket->Packet.Position.Time=Ev.Time; RxPacket->Rank=Ev.Rank;
+      if(Ev.Type==RxEvent::Recv && RelayQueue.addNew(Slot)) Check++; }
+    else if(Ev.Type==RxEvent::Relay)
+    { if(RelayQueue.Sum==0) continue;
+      uint8_t Slot=RelayQueue.getRand(Ev.Value);
+      if(RelayQueue.Packet[Slot].Rank==0) continue;
+      Check+=Slot; RelayQueue.decrRank(Slot); }
+    else RelayQueue.cleanTime(Ev.Time);
+  }
+  return Check; }
+
+template <uint8_t Size>
+ static int Verify(void)                                              // the new queue against brute force after every step
+{ OGN_PrioQueueTree<OGN1_Packet, Size> *Queue = new OGN_PrioQueueTree<OGN1_Packet, Size>;
+  OGN_PrioQueueTree<OGN1_Packet, Size> &RelayQueue = *Queue;
+  int Errors=0;
+  for(size_t Idx=0; Idx<Event.size() && Errors<10; Idx++)
+  { const RxEvent &Ev=Event[Idx];
+    if(Ev.Type<=RxEvent::Fail)
+    { uint8_t Slot=RelayQueue.getNew();
+      OGN_RxPacket<OGN1_Packet> *RxPacket=RelayQueue[Slot];
+      if(RxPacket->Alloc || RxPacket->Rank) { printf("Size %d: getNew() slot %d is not free\n", Size, Slot); Errors++; }
+      RxPacket->Packet.setAddressAndType(Ev.Value); RxPacket->Packet.Position.Time=Ev.Time; RxPacket->Rank=Ev.Rank;
+      if(Ev.Type==RxEvent::Recv)
+      { int Live=-1;                                                  // the allocated packet of this ID must be found
+        for(int Other=0; Other<Size; Other++)
+          if(Other!=Slot && RelayQueue.Packet[Other].Alloc && RelayQueue.Packet[Other].Packet.getAddressAndType()==Ev.Value) Live=Other;
+        OGN_RxPacket<OGN1_Packet> *Prev=RelayQueue.addNew(Slot);
+        if(Live>=0 && Prev!=RelayQueue.Packet+Live) { printf("Size %d: addNew() missed the previous packet in slot %d\n", Size, Live); Errors++; } }
+    }
+    else if(Ev.Type==RxEvent::Relay)
+    { if(RelayQueue.Sum==0) continue;
+      for(int Pick=0; Pick<4; Pick++)                                 // the pick is the one of the linear scan
+      { uint32_t Rand=Random(); uint16_t RankIdx=Rand%RelayQueue.Sum, RankSum=0; int Ref=-1;
+        for(int Slot=0; Slot<Size; Slot++)
+        { if(RelayQueue.Packet[Slot].Alloc==0) continue;
+          RankSum+=RelayQueue.Packet[Slot].Rank; if(RankSum>RankIdx) { Ref=Slot; break; } }
+        if(RelayQueue.getRand(Rand)!=Ref) { printf("Size %d: getRand() gives %d instead of %d\n", Size, RelayQueue.getRand(Rand), Ref); Errors++; } }
+      uint8_t Slot=RelayQueue.getRand(Ev.Value);
+      if(RelayQueue.Packet[Slot].Rank) RelayQueue.decrRank(Slot); }
+    else
+    { RelayQueue.cleanTime(Ev.Time);
+      for(int Slot=0; Slot<Size; Slot++)
+      { const OGN_RxPacket<OGN1_Packet> &Pkt=RelayQueue.Packet[Slot];
+        if(Pkt.Alloc && (Pkt.Packet.Position.Time==Ev.Time || Pkt.Packet.Position.Time>=60))
+        { printf("Size %d: cleanTime(%d) left slot %d\n", Size, Ev.Time, Slot); Errors++; } }
+    }
+    uint16_t Sum=0; uint8_t Low=0xFF; int IDs=0;
+    for(int Slot=0; Slot<Size; Slot++)
+    { const OGN_RxPacket<OGN1_Packet> &Pkt=RelayQueue.Packet[Slot];
+      uint8_t Rank = Pkt.Alloc ? Pkt.Rank:0; Sum+=Rank; if(Rank<Low) Low=Rank;
+      if(!Pkt.Alloc) continue;
+      for(int Other=Slot+1; Other<Size; Other++)
+        if(RelayQueue.Packet[Other].Alloc && RelayQueue.Packet[Other].Packet.getAddressAndType()==Pkt.Packet.getAddressAndType()) IDs++; }
+    if(Sum!=RelayQueue.Sum) { printf("Size %d: rank sum %d instead of %d\n", Size, RelayQueue.Sum, Sum); Errors++; }
+    if(Low!=RelayQueue.Low) { printf("Size %d: lowest rank %d instead of %d\n", Size, RelayQueue.Low, Low); Errors++; }
+    if(IDs) { printf("Size %d: same ID in %d allocated slots\n", Size, IDs+1); Errors++; }
+  }
+  delete Queue;
+  return Errors; }
+
+template <uint8_t Size>
+ static int Bench(void)
+{ Simulate(AcftFactor*Size);
+  int Errors=Verify<Size>();
+  OGN_PrioQueueLinear<OGN1_Packet, Size> *Ref = new OGN_PrioQueueLinear<OGN1_Packet, Size>;
+  OGN_PrioQueueTree  <OGN1_Packet, Size> *New = new OGN_PrioQueueTree  <OGN1_Packet, Size>;
+  double RefTime=1e9, NewTime=1e9; uint32_t RefCheck=0, NewCheck=0;
+  for(int Pass=0; Pass<Repeat; Pass++)
+  { double Start=getTime(); RefCheck=Run(*Ref); double Time=getTime()-Start; if(Time<RefTime) RefTime=Time;
+           Start=getTime(); NewCheck=Run(*New);        Time=getTime()-Start; if(Time<NewTime) NewTime=Time; }
+  double Scale=1e9/Event.size();
+  bool Tree = sizeof(OGN_PrioQueue<OGN1_Packet, Size>)==sizeof(OGN_PrioQueueTree<OGN1_Packet, Size>);
+  printf("Size %2d: %3d aircraft, %7d packets, %7d events: linear %6.1f ns/event %5d bytes, tree %6.1f ns/event %5d bytes, x%4.2f (%u/%u) %s, takes %s\n",
+         Size, AcftFactor*Size, Packets, (int)Event.size(), RefTime*Scale, (int)sizeof(*Ref), NewTime*Scale, (int)sizeof(*New),
+         RefTime/NewTime, RefCheck, NewCheck, Errors ? "FAILED":"OK", Tree ? "tree":"linear");
+  delete Ref; delete New;
+  return Errors; }
+
+int main(int argc, char *argv[])
+{ for(int arg=1; arg<argc; arg++)
+  { const char *Val = argv[arg];
+    if(Val[0]!='-') { Help=1; continue; }
+    switch(Val[1])
+    { case 'h': Help=1; break;
+      case 'a': AcftFactor=atoi(Val+2); break;
+      case 't': SimTime=atoi(Val+2); break;
+      case 'r': Relays=atoi(Val+2); break;
+      case 'd': Delay=atoi(Val+2); break;
+      case 'n': Repeat=atoi(Val+2); break;
+      default: Help=1; break;
+    }
+  }
+  if(AcftFactor<1 || SimTime<1 || Relays<0 || Delay<1 || Delay>59 || Repeat<1) Help=1;
+
+  if(Help)
+  { printf("Usage: %s [options]\n\
+Options: -h          this help\n\
+         -a<count>   simulated aircraft per queue slot [%d]\n\
+         -t<sec>     simulated time [%d]\n\
+         -r<count>   relay picks per second [%d]\n\
+         -d<sec>     age of the packets to clean [%d]\n\
+         -n<count>   number of timing passes [%d]\n\
+", argv[0], AcftFactor, SimTime, Relays, Delay, Repeat);
+    return 0; }
+
+  int Fail=0;
+  Fail+=Bench< 8>();
+  Fail+=Bench<16>();
+  Fail+=Bench<32>();
+  Fail+=Bench<64>();
+  printf("%s\n", Fail ? "FAILED":"PASSED");
+  return Fail ? 1:0; }
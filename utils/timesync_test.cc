@@ -0,0 +1,159 @@
+// PPS clock test: PPS_Clock fed with synthetic PPS edges as the interrupt captures them on the tracker:
+// a local oscillator off by some ppm and wandering with temperature, interrupt latency jitter, edges now and then
+// late by a busy interrupt or a flash write, missing edges and a PPS outage for holdover.
+// Queries at random moments between the edges are compared with the true time: error, uncertainty coverage,
+// drift estimate, and the former 1ms RTOS tick reference polled by the GPS task as the baseline.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "../main/ppsclock.h"                                         // the firmware headers, not the copies here
+
+static uint32_t RandState = 0x12345678;                               // simple xorshift generator: reproducible between runs and platforms
+
+static uint32_t Random(void)
+{ uint32_t X=RandState; X^=X<<13; X^=X>>17; X^=X<<5; return RandState=X; }
+
+static double RandomFloat(void) { return (Random()&0xFFFFFF)/16777216.0; } // 0..1
+
+static int    SimTime   = 3600;                                       // [sec] simulated time
+static double Drift     =   35;                                       // [ppm] local oscillator error
+static double Wander    =    2;                                       // [ppm] slow change with temperature, peak
+static double Jitter    =    6;                                       // [us] interrupt latency spread
+static double LateProb  =    2;                                       // [%] edges late by a busy interrupt
+static double MissProb  =    1;                                       // [%] edges missing
+static int    Outage    =  120;                                       // [sec] PPS outage in the middle of the run
+static int    Queries   =   10;                                       // queries per second
+static int    Help      =    0;
+
+static int LateEdge(int Late)                                         // regression: one edge Late [us] behind the line, then good edges
+{ PPS_Clock Clock;                                                    // the late edge is left out of the fit, the good ones must pass
+  uint32_t StartTime = 1718445600;
+  double   Local     = 5e6;                                           // [us]
+  int Restarts=0, Rejects=0;
+  for(int Sec=0; Sec<40; Sec++)
+  { double Capture = Local + PPS_Clock::Latency + (Sec==20 ? Late:0);
+    int Ret=Clock.Update((int64_t)floor(Capture), StartTime+Sec);
+    if(Sec>0 && Ret<0) Restarts++;
+    if(Sec!=20 && Ret==0) Rejects++;
+    Local += 1e6*(1+35e-6); }
+  uint32_t Time, usTime, usUncert;
+  bool Valid = Clock.getTime((int64_t)floor(Local), Time, usTime, usUncert);
+  double Err = Valid ? ((double)(int32_t)(Time-StartTime-40))*1e6 + usTime : 1e9; // [us]
+  printf("One edge %dus late: %d good edges rejected, %d restarts, then %4.1fus off\n", Late, Rejects, Restarts, Err);
+  return Rejects || Restarts || fabs(Err)>2; }
+
+static int MidUpdate(void)                                            // regression: a reader runs while the writer is preempted inside Fit()
+{ PPS_Clock Clock;                                                    // on one core the writer cannot go on until the reader returns
+  uint32_t StartTime = 1718445600;
+  double   Local     = 5e6;                                           // [us]
+  for(int Sec=0; Sec<10; Sec++)
+  { Clock.Update((int64_t)floor(Local+PPS_Clock::Latency), StartTime+Sec);
+    Local += 1e6*(1+35e-6); }
+  uint32_t Time, usTime, usUncert; int32_t Drift;
+  bool Before = Clock.getTime((int64_t)floor(Local), Time, usTime, usUncert);
+  Clock.Seq++;                                                        // the writer is in the middle: Seq is odd
+  Clock.RefLocal+=123456789;                                          // and half of the line is new
+  bool During  = Clock.getTime((int64_t)floor(Local), Time, usTime, usUncert); // must return, with no time
+  bool DuringD = Clock.getDrift(Drift);
+  Clock.RefLocal-=123456789; Clock.Seq++;                             // the writer finishes
+  bool After = Clock.getTime((int64_t)floor(Local), Time, usTime, usUncert);
+  printf("Reader during an update: time %d/%d/%d before/during/after, drift %d during\n", Before, During, After, DuringD);
+  return !Before || During || DuringD || !After; }
+
+int main(int argc, char *argv[])
+{ for(int arg=1; arg<argc; arg++)
+  { const char *Val = argv[arg];
+    if(Val[0]!='-') { Help=1; continue; }
+    switch(Val[1])
+    { case 'h': Help=1; break;
+      case 't': SimTime=atoi(Val+2); break;
+      case 'd': Drift=atof(Val+2); break;
+      case 'w': Wander=atof(Val+2); break;
+      case 'j': Jitter=atof(Val+2); break;
+      case 'l': LateProb=atof(Val+2); break;
+      case 'm': MissProb=atof(Val+2); break;
+      case 'o': Outage=atoi(Val+2); break;
+      case 'q': Queries=atoi(Val+2); break;
+      default: Help=1; break;
+    }
+  }
+  if(SimTime<300 || Jitter<0 || LateProb<0 || MissProb<0 || Outage<0 || Outage>SimTime/4 || Queries<1) Help=1;
+
+  if(Help)
+  { printf("Usage: %s [options]\n\
+Options: -h          this help\n\
+         -t<sec>     simulated time, at least 300 [%d]\n\
+         -d<ppm>     local oscillator error [%3.1f]\n\
+         -w<ppm>     its wander with temperature [%3.1f]\n\
+         -j<us>      interrupt latency spread [%3.1f]\n\
+         -l<%%>       edges late by 50..500us [%3.1f]\n\
+         -m<%%>       edges missing [%3.1f]\n\
+         -o<sec>     PPS outage in the middle [%d]\n\
+         -q<count>   queries per second [%d]\n\
+", argv[0], SimTime, Drift, Wander, Jitter, LateProb, MissProb, Outage, Queries);
+    return 0; }
+
+  PPS_Clock Clock;
+  uint32_t StartTime = 1718445600;                                    // [sec] UTC of the first edge
+  double   Local     = 123456789.0;                                   // [us] true local timer at the edge
+  int      Settle    = 20;                                            // [sec] before the statistics start
+  int      OutStart  = SimTime/2, OutEnd=OutStart+Outage;
+
+  int    LockTime=-1, Late=0, Missed=0;
+  double SumErr2=0, MaxErr=0, SumTick2=0, MaxDriftErr=0; int Count=0, Covered=0;
+  double HoldMax=0; int HoldCount=0, HoldCovered=0;
+  for(int Sec=0; Sec<SimTime; Sec++)
+  { double Ppm = Drift + Wander*sin(2*M_PI*Sec/1800.0);              // [ppm] the oscillator now
+    double Next = Local + 1e6*(1+Ppm*1e-6);                          // [us] local timer at the next edge
+    bool Out = Sec>=OutStart && Sec<OutEnd;
+    bool Miss = RandomFloat()*100<MissProb;
+    if(!Out && !Miss)
+    { double Capture = Local + PPS_Clock::Latency + Jitter*(RandomFloat()-0.5); // interrupt latency
+      if(RandomFloat()*100<LateProb) { Capture += 50+450*RandomFloat(); Late++; }
+      Clock.Update((int64_t)floor(Capture), StartTime+Sec); }
+    else Missed++;
+    if(LockTime<0 && Clock.Valid) LockTime=Sec;
+    double DriftErr = fabs(Clock.getDrift()/1000.0-Ppm);            // [ppm]
+    bool Settled = Sec>=Settle && !Out && (Sec<OutEnd || Sec>=OutEnd+Settle) && Clock.Points>=PPS_Clock::Window/2; // not while the fit settles
+    if(Settled && DriftErr>MaxDriftErr) MaxDriftErr=DriftErr;
+    for(int Query=0; Query<Queries; Query++)                         // moments between this edge and the next
+    { double Frac = RandomFloat();
+      double At = Local + Frac*(Next-Local);
+      uint32_t Time, usTime, usUncert;
+      if(!Clock.getTime((int64_t)floor(At), Time, usTime, usUncert)) continue;
+      double Err = ((double)(int32_t)(Time-StartTime-Sec) - Frac)*1e6 + usTime; // [us]
+      if(Sec<Settle) continue;
+      if(Out)
+      { HoldCount++; if(fabs(Err)>HoldMax) HoldMax=fabs(Err);
+        if(fabs(Err)<=3.0*usUncert) HoldCovered++;
+        continue; }
+      Count++; SumErr2+=Err*Err; if(fabs(Err)>MaxErr) MaxErr=fabs(Err);
+      if(fabs(Err)<=3.0*usUncert) Covered++;
+      double TickErr = floor((Frac*1e6-1000*RandomFloat())/1000)*1000 - Frac*1e6; // [us] 1ms ticks from an edge polled up to 1ms late
+      SumTick2+=TickErr*TickErr; }
+    Local=Next; }
+
+  double RMS=sqrt(SumErr2/(Count?Count:1)), TickRMS=sqrt(SumTick2/(Count?Count:1));
+  double Coverage = 100.0*Covered/(Count?Count:1), HoldCoverage = 100.0*HoldCovered/(HoldCount?HoldCount:1);
+  printf("%d sec, %4.1f+/-%3.1fppm, %3.1fus jitter: %d late, %d missing edges, %d rejected, locked after %d sec\n",
+         SimTime, Drift, Wander, Jitter, Late, Missed, Clock.Rejected, LockTime);
+  printf("Time error: %5.2fus RMS, %5.1fus max, %5.1f%% within 3x uncertainty (1ms tick reference: %5.1fus RMS)\n",
+         RMS, MaxErr, Coverage, TickRMS);
+  printf("Holdover %d sec: %5.1fus max, %5.1f%% within 3x uncertainty\n", Outage, HoldMax, HoldCoverage);
+  printf("Drift error: %5.3fppm max, now %+7.3fppm\n", MaxDriftErr, Clock.getDrift()/1000.0);
+
+  int Fail=0;
+  if(LockTime<0 || LockTime>5) { printf("No lock within 5 sec\n"); Fail++; }
+  if(RMS>Jitter+5)            { printf("RMS error above the jitter\n"); Fail++; }
+  if(MaxErr>10*Jitter+50)     { printf("Max. error too large\n"); Fail++; }
+  if(Coverage<95)             { printf("Uncertainty too optimistic\n"); Fail++; }
+  if(Outage && HoldCoverage<90) { printf("Holdover uncertainty too optimistic\n"); Fail++; }
+  if(MaxDriftErr>0.5+0.1*Jitter) { printf("Drift estimate off by more than the jitter allows\n"); Fail++; } // slope over a short window
+  Fail+=LateEdge(15);
+  Fail+=MidUpdate();
+  printf("%s\n", Fail ? "FAILED":"PASSED");
+  return Fail ? 1:0; }
@@ -0,0 +1,223 @@
+// Batch TLG converter: many log files, plain or compact, to APRS on a pool of worker threads.
+// Each file is memory-mapped and its records decoded in bulk, the output keeps the order of the input files:
+// one stream on stdout or one .aprs file per log. Gives the same lines as tlg2aprs, reports files/s and packets/s.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include "../main/logzip.h"                                           // the firmware headers, not the copies here
+
+static double getTime(void)                                           // read the system time at this very moment
+{ struct timespec now; clock_gettime(CLOCK_MONOTONIC, &now); return now.tv_sec + 1e-9*now.tv_nsec; }
+
+static int         Threads =   0;                                     // worker threads, zero: as many as hardware threads
+static int         Window  =   0;                                     // files converted ahead of the writer, zero: 4 per thread
+static const char *OutDir  =   0;                                     // one .aprs file per log in this directory
+static int         Quiet   =   0;                                     // convert but do not write: for timing
+static int         Verify  =   0;                                     // convert again sequentially, as tlg2aprs, and compare
+static int         Help    =   0;
+
+typedef OGN_LogPacket<OGN1_Packet> LogPacket;
+
+class Job                                                             // one log file
+{ public:
+   std::string Name;
+   uint32_t    FileTime;                                              // [sec] from the file name
+   std::string Out;                                                   // the APRS lines
+   uint32_t    Packets;                                               // converted
+   size_t      Size;                                                  // [byte] of the log file
+   int8_t      State;                                                 // 0=pending, 1=done, -1=cannot read
+} ;
+
+static std::vector<Job> Jobs;
+
+// ----------------------------------------------------------------------------------------------------------------
+
+static uint32_t ReadFileTime(const char *FileName)                    // start time from the file name, as tlg2aprs
+{ const char *ShortName=strrchr(FileName, '/'); ShortName = ShortName ? ShortName+1:FileName;
+  uint32_t FileTime=0;
+  if(Read_Hex(FileTime, ShortName)!=8) fprintf(stderr, "Not a TLG file: %s\n", ShortName);
+  return FileTime; }
+
+static int AddInput(const char *Name)                                 // a log file or all .TLG files in a directory
+{ struct stat Stat;
+  if(stat(Name, &Stat)<0) { fprintf(stderr, "Cannot access %s\n", Name); return 0; }
+  std::vector<std::string> Names;
+  if(S_ISDIR(Stat.st_mode))
+  { DIR *Dir=opendir(Name); if(Dir==0) return 0;
+    for( ; ; )
+    { struct dirent *Ent=readdir(Dir); if(Ent==0) break;
+      int Len=strlen(Ent->d_name);
+      if(Len<4 || strcasecmp(Ent->d_name+Len-4, ".TLG")!=0) continue;
+      std::string Path(Name); if(Path.back()!='/') Path+='/';
+      Names.push_back(Path+Ent->d_name); }
+    closedir(Dir);
+    std::sort(Names.begin(), Names.end()); }
+  else Names.push_back(Name);
+  for(size_t Idx=0; Idx<Names.size(); Idx++)
+  { Job New; New.Name=Names[Idx]; New.FileTime=ReadFileTime(New.Name.c_str());
+    New.Packets=0; New.Size=0; New.State=0;
+    Jobs.push_back(New); }
+  return Names.size(); }
+
+static uint32_t Convert(const LogPacket *Rec, int Records, uint32_t FileTime, std::string &Out) // records to APRS lines
+{ char Line[256]; uint32_t Packets=0;
+  for(int Idx=0; Idx<Records; Idx++)
+  { LogPacket Packet=Rec[Idx];                                       // WriteAPRS() is not const
+    if(!Packet.isCorrect()) continue;
+    uint32_t Time=Packet.getTime(FileTime);                          // [sec] exact time from the short time and the file start time
+    int Len=Packet.Packet.WriteAPRS(Line, Time);
+    if(Len==0) continue;
+    Line[Len++]='\n'; Out.append(Line, Len); Packets++; }
+  return Packets; }
+
+static void ConvertFile(Job &File, OGN_LogZip<OGN1_Packet> &Zip)      // map the file, decode it in bulk
+{ int Fd=open(File.Name.c_str(), O_RDONLY);
+  struct stat Stat;
+  if(Fd<0 || fstat(Fd, &Stat)<0) { if(Fd>=0) close(Fd); File.State=-1; return; }
+  File.Size=Stat.st_size;
+  if(File.Size==0) { close(Fd); File.State=1; return; }
+  const uint8_t *Data=(const uint8_t *)mmap(0, File.Size, PROT_READ, MAP_PRIVATE, Fd, 0);
+  close(Fd);
+  if(Data==MAP_FAILED) { File.State=-1; return; }
+  madvise((void *)Data, File.Size, MADV_SEQUENTIAL);
+  File.Out.reserve(File.Size*4);                                     // about 100 chars per 24-byte record, less when compact
+  const int MagicLen=OGN_LogZip<OGN1_Packet>::MagicLen;
+  if(File.Size<(size_t)MagicLen || memcmp(Data, Zip.Magic(), MagicLen)!=0) // plain: the records as they are in the map
+    File.Packets=Convert((const LogPacket *)Data, File.Size/LogPacket::Bytes, File.FileTime, File.Out);
+  else                                                               // compact: block by block
+  { LogPacket Rec[OGN_LogZip<OGN1_Packet>::MaxBlockRecords];
+    Zip.Clear();
+    for(size_t Ptr=MagicLen; Ptr<File.Size; )
+    { int Records=Zip.DecodeBlock(Data+Ptr, File.Size-Ptr, Rec);
+      if(Records<0) break;                                           // broken or truncated block: the end, as for OGN_LogReader
+      File.Packets+=Convert(Rec, Records, File.FileTime, File.Out);
+      Ptr+=4+(Data[Ptr] | (Data[Ptr+1]<<8)); }
+  }
+  munmap((void *)Data, File.Size);
+  File.State=1; }
+
+// ----------------------------------------------------------------------------------------------------------------
+
+static std::atomic<size_t> NextJob(0);                                // next file for a worker
+static size_t Written=0;                                              // files written out, in order
+static std::mutex Lock;
+static std::condition_variable JobDone, Room;
+
+static void Worker(void)
+{ OGN_LogZip<OGN1_Packet> *Zip = new OGN_LogZip<OGN1_Packet>;        // aircraft table per worker
+  for( ; ; )
+  { size_t Idx=NextJob++; if(Idx>=Jobs.size()) break;
+    { std::unique_lock<std::mutex> Guard(Lock);                      // do not run too far ahead of the writer: bounded memory
+      Room.wait(Guard, [Idx] { return Idx<Written+Window; }); }
+    Job File; File.Name=Jobs[Idx].Name; File.FileTime=Jobs[Idx].FileTime; File.Packets=0; File.Size=0;
+    ConvertFile(File, *Zip);
+    { std::lock_guard<std::mutex> Guard(Lock);
+      Jobs[Idx].Out.swap(File.Out); Jobs[Idx].Packets=File.Packets; Jobs[Idx].Size=File.Size; Jobs[Idx].State=File.State; }
+    JobDone.notify_all(); }
+  delete Zip; }
+
+static int WriteOut(Job &File)                                        // in the order of the input files
+{ if(Quiet) return 0;
+  if(OutDir==0) return fwrite(File.Out.data(), 1, File.Out.size(), stdout)==File.Out.size() ? 0:-1;
+  const char *ShortName=strrchr(File.Name.c_str(), '/'); ShortName = ShortName ? ShortName+1:File.Name.c_str();
+  std::string Name(OutDir); if(Name.back()!='/') Name+='/';
+  Name+=ShortName;
+  size_t Dot=Name.rfind('.'); if(Dot!=std::string::npos && Dot>Name.rfind('/')) Name.resize(Dot);
+  Name+=".aprs";
+  FILE *Out=fopen(Name.c_str(), "wb"); if(Out==0) { fprintf(stderr, "Cannot open %s for write\n", Name.c_str()); return -1; }
+  bool OK = fwrite(File.Out.data(), 1, File.Out.size(), Out)==File.Out.size();
+  fclose(Out); return OK ? 0:-1; }
+
+static std::string Sequential(const Job &File)                        // as tlg2aprs: through OGN_LogReader
+{ static OGN_LogReader<OGN1_Packet> Reader;
+  std::string Out; char Line[256];
+  if(Reader.Open(File.Name.c_str())<0) return Out;
+  LogPacket Packet;
+  while(Reader.Read(Packet))
+  { if(!Packet.isCorrect()) continue;
+    int Len=Packet.Packet.WriteAPRS(Line, Packet.getTime(File.FileTime));
+    if(Len==0) continue;
+    Line[Len++]='\n'; Out.append(Line, Len); }
+  Reader.Close(); return Out; }
+
+int main(int argc, char *argv[])
+{ for(int arg=1; arg<argc; arg++)
+  { const char *Val = argv[arg];
+    if(Val[0]!='-') { AddInput(Val); continue; }
+    switch(Val[1])
+    { case 'h': Help=1; break;
+      case 'j': Threads=atoi(Val+2); break;
+      case 'w': Window=atoi(Val+2); break;
+      case 'o': OutDir=Val+2; break;
+      case 'q': Quiet=1; break;
+      case 'v': Verify=1; break;
+      default: Help=1; break;
+    }
+  }
+  if(Threads==0) Threads=std::thread::hardware_concurrency();
+  if(Threads<=0) Threads=1;
+  if(Window==0) Window=4*Threads;
+  if(Window<Threads || (OutDir && OutDir[0]==0)) Help=1;
+
+  if(Help || Jobs.empty())
+  { fprintf(stderr, "Usage: %s [options] <log.TLG|directory> ...\n\
+Options: -h          this help\n\
+         -j<threads> worker threads [hardware threads]\n\
+         -w<files>   files converted ahead of the writer [4 per thread]\n\
+         -o<dir>     one .aprs file per log in this directory, else all on stdout in the input order\n\
+         -q          convert but do not write: for timing\n\
+         -v          convert again one by one, as tlg2aprs, compare and time\n\
+", argv[0]);
+    return Help; }
+
+  double Start=getTime();
+  std::vector<std::thread> Pool;
+  for(int Idx=0; Idx<Threads; Idx++) Pool.push_back(std::thread(Worker));
+  size_t Files=0, Failed=0, Bytes=0, OutBytes=0; uint64_t Packets=0;
+  int Mismatch=0; double SeqTime=0;                                   // for -v
+  for(size_t Idx=0; Idx<Jobs.size(); Idx++)
+  { { std::unique_lock<std::mutex> Guard(Lock);
+      JobDone.wait(Guard, [Idx] { return Jobs[Idx].State!=0; }); }
+    Job &File=Jobs[Idx];
+    if(File.State<0) { fprintf(stderr, "Cannot read %s\n", File.Name.c_str()); Failed++; }
+    else if(WriteOut(File)<0) Failed++;
+    Files++; Bytes+=File.Size; OutBytes+=File.Out.size(); Packets+=File.Packets;
+    if(Verify && File.State>0)                                       // check now, so no output is kept beyond the window
+    { double Start=getTime();
+      if(Sequential(File)!=File.Out)
+      { if(Mismatch<5) fprintf(stderr, "Different output for %s\n", File.Name.c_str());
+        Mismatch++; }
+      SeqTime+=getTime()-Start; }
+    std::string().swap(File.Out);                                    // free the output
+    { std::lock_guard<std::mutex> Guard(Lock); Written=Idx+1; }
+    Room.notify_all(); }
+  for(size_t Idx=0; Idx<Pool.size(); Idx++) Pool[Idx].join();
+  double Time=getTime()-Start-SeqTime;                               // with -v: the workers run on during the checks, thus a bit short
+  fflush(stdout);
+  fprintf(stderr, "%lu files (%lu failed), %4.1f MB in, %4.1f MB out, %llu packets in %5.3f sec on %d threads:"
+                  " %6.1f files/s %5.2f Mpackets/s\n",
+          (unsigned long)Files, (unsigned long)Failed, 1e-6*Bytes, 1e-6*OutBytes, (unsigned long long)Packets,
+          Time, Threads, Files/Time, 1e-6*Packets/Time);
+
+  if(Verify)
+  { fprintf(stderr, "One by one through OGN_LogReader: %5.3f sec, %6.1f files/s => x%4.2f, %d files differ\n",
+            SeqTime, Files/SeqTime, SeqTime/Time, Mismatch);
+    if(Mismatch) return 1; }
+  return Failed!=0; }
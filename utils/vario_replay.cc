@@ -0,0 +1,304 @@
+// Vario replay: the VerticalKalman and the LineDecimator of ProcBaro() against the former chain of a 4-point SlopePipe,
+// LowPass2 filters and the GPS-pressure averager, fed with the same baro readings, GPS altitudes and, optionally,
+// accelerometer data. The former chain takes two readings per half second, the Kalman filter all of them.
+// Without a file a flight is simulated: cruise and thermals with circling and gusts, baro noise per reading,
+// GPS altitude with slow wander and noise, weather drift of the pressure. With a file the $POGNB pressures
+// and the GGA altitudes of a tracker log are replayed and a non-causal fit over the baro altitude is the reference.
+// Reports the lag of the climb rate (best time shift against the truth or the reference), its noise at that shift,
+// its error as the pilot hears it (no shift), the altitude error, and the error and reported noise of the pressure.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <vector>
+
+#include "../main/vertical.h"                                         // the firmware headers, not the copies here
+#include "../main/decimate.h"
+#include "../main/atmosphere.h"
+#include "../main/slope.h"
+#include "../main/lowpass2.h"
+
+static uint32_t RandState = 0x12345678;                               // simple xorshift generator: reproducible between runs and platforms
+
+static uint32_t Random(void)
+{ uint32_t X=RandState; X^=X<<13; X^=X>>17; X^=X<<5; return RandState=X; }
+
+static double RandomFloat(void) { return (Random()&0xFFFFFF)/16777216.0; } // 0..1
+
+static double RandomGauss(void)                                       // normal distribution, unit sigma
+{ double R=sqrt(-2*log(RandomFloat()+1e-9)); return R*cos(2*M_PI*RandomFloat()); }
+
+static int    SimTime   = 1800;                                       // [sec] simulated flight
+static double BaroRate  =   25;                                       // [Hz] baro readings, 0: two back-to-back per half second as ProcBaro() took them
+static double BaroNoise =  1.5;                                       // [Pa] noise of one reading
+static int    WithAcc   =    0;                                       // simulate the BMX055 accelerometer
+static double ManQ      =    0;                                       // [m^2/s^3] Kalman climb rate change, 0: the firmware default
+static int    Verbose   =    0;
+static int    Help      =    0;
+
+// ----------------------------------------------------------------------------------------------------------------
+
+struct BaroReading { double Time; int32_t Press; int16_t Temp; bool Slot; } ; // [sec], [0.25 Pa], [0.1 degC], last of the half-second slot
+struct GPSReading  { double Time; double Alt; } ;                     // [sec], [m] above MSL
+struct AccReading  { double Time; double Acc; } ;                     // [sec], [m/s^2] vertical, gravity removed
+
+static std::vector<BaroReading> Baro;
+static std::vector<GPSReading>  GPS;
+static std::vector<AccReading>  Acc;
+
+static std::vector<double> TrueTime, TrueClimb, TrueAlt, TruePress;    // [sec], [m/s] pressure altitude change, [m] above MSL, [Pa]
+static bool hasTruth=0;
+
+static double Interpolate(const std::vector<double> &Val, double Time)  // on the truth grid
+{ double Pos=(Time-TrueTime[0])/(TrueTime[1]-TrueTime[0]);
+  if(Pos<=0) return Val[0];
+  size_t Idx=(size_t)Pos; if(Idx+1>=Val.size()) return Val.back();
+  double Frac=Pos-Idx; return Val[Idx]*(1-Frac)+Val[Idx+1]*Frac; }
+
+static void Simulate(void)
+{ const double Step=0.01;                                             // [sec] truth resolution
+  double Alt=1000, Climb=0, Target=-1.2, Gust=0, GPSWander=0;         // [m] pressure altitude, [m/s]
+  double Switch=60, Thermal=0, Phase=0;
+  double AccBias=0.3;                                                 // [m/s^2] accelerometer offset: gravity not quite removed
+  double NextBaro=0, NextGPS=1, NextAcc=0; int Slot=0, InSlot=0;
+  for(double Time=0; Time<SimTime; Time+=Step)
+  { if(Time>=Switch)                                                  // cruise <-> thermal
+    { Thermal=!Thermal; Target = Thermal ? 1.5+2*RandomFloat() : -0.8-0.8*RandomFloat();
+      Switch += Thermal ? 60+120*RandomFloat() : 30+60*RandomFloat(); }
+    Gust += (-Gust*Step/1.0) + 0.5*sqrt(2*Step/1.0)*RandomGauss();   // [m/s] turbulence, 1 sec correlation
+    if(RandomFloat()<Step/40) Gust += (RandomFloat()<0.5 ? -1.5:1.5); // a sharp edge now and then
+    Phase += 2*M_PI*Step/22;                                          // circling: through the core and out
+    double Want = Target + (Thermal ? 1.2*sin(Phase):0) + Gust;
+    double Prev = Climb;
+    Climb += (Want-Climb)*Step/0.5;                                   // the glider responds with some inertia
+    double Accel = (Climb-Prev)/Step;
+    Alt += Climb*Step;
+    double Weather = 120 + 8*Time/10800;                             // [m] MSL minus pressure altitude, 1hPa in 3 hours
+    double Press = Atmosphere::StdPressure16((int32_t)floor(10*Alt+0.5))/16.0; // [Pa]
+    TrueTime.push_back(Time); TrueClimb.push_back(Climb); TrueAlt.push_back(Alt+Weather); TruePress.push_back(Press);
+    if(Time>=NextBaro)
+    { Press += BaroNoise*RandomGauss();
+      int16_t Temp = Atmosphere::StdTemperature((int32_t)floor(10*Alt));
+      BaroReading Read = { Time, (int32_t)floor(4*Press+0.5), Temp, 0 };
+      Baro.push_back(Read); InSlot++;
+      if(BaroRate>0)
+      { NextBaro += 1/BaroRate;
+        if(NextBaro>=0.5*(Slot+1)) { Baro.back().Slot=1; Slot++; InSlot=0; } }
+      else if(InSlot<2) NextBaro += 0.045;                            // BMP280 in high resolution: about 45ms per acquisition
+      else { Baro.back().Slot=1; Slot++; InSlot=0; NextBaro=0.5*Slot; } }
+    if(Time>=NextGPS)
+    { GPSWander += (-GPSWander/30) + 3.0*sqrt(2.0/30)*RandomGauss();  // [m] 30 sec correlation
+      GPSReading Read = { Time, Alt+Weather+GPSWander+1.5*RandomGauss() };
+      GPS.push_back(Read); NextGPS+=1; }
+    if(WithAcc && Time>=NextAcc)
+    { AccReading Read = { Time, Accel+AccBias+0.3*RandomGauss() };   // 25Hz after the BMX055 low pass
+      Acc.push_back(Read); NextAcc+=0.04; }
+  }
+  hasTruth=1; }
+
+static int ReadLog(const char *FileName)                              // $POGNB and GGA from a tracker log or console capture
+{ FILE *File=fopen(FileName, "rt"); if(File==0) { printf("Cannot open %s\n", FileName); return -1; }
+  char Line[256]; double Base=0, Last=-1; int Count=0;
+  while(fgets(Line, sizeof(Line), File))
+  { const char *Msg=strchr(Line, '$'); if(Msg==0) continue;
+    const char *Field[16]; int Fields=0;
+    for(const char *Ptr=Msg; *Ptr && Fields<16; Ptr++) if(*Ptr==',') Field[Fields++]=Ptr+1;
+    if(memcmp(Msg, "$POGNB,", 7)==0 && Fields>=4)
+    { double Sec=atof(Field[0]);                                      // [sec] within the minute
+      if(Last>=0 && Base+Sec<Last-30) Base+=60;
+      double Time=Base+Sec; Last=Time;
+      BaroReading Read = { Time, (int32_t)floor(4*atof(Field[2])+0.5), (int16_t)floor(10*atof(Field[1])+0.5), 1 };
+      if(Read.Press<=0) continue;
+      Baro.push_back(Read); Count++; continue; }
+    if(memcmp(Msg+3, "GGA,", 4)==0 && Fields>=10 && Last>=0 && Field[8][0]!=',')
+    { double Sec=fmod(atof(Field[0]), 100);                           // hhmmss.ss: take the seconds
+      double Time=Base+Sec;
+      while(Time<Last-30) Time+=60;
+      while(Time>Last+30) Time-=60;
+      GPSReading Read = { Time, atof(Field[8]) };
+      GPS.push_back(Read); Count++; }
+  }
+  fclose(File); return Count; }
+
+// ----------------------------------------------------------------------------------------------------------------
+
+struct Output { double Time; double Climb; double Alt; double Press; double Noise; } ; // [sec], [m/s], [m] above MSL, [Pa], [Pa] reported noise
+
+static void OldChain(std::vector<Output> &Out)                        // ProcBaro() as it was: one step per half-second slot
+{ SlopePipe<int32_t> BaroPipe; LowPass2<int32_t,6,4,8> BaroNoise; LowPass2<int64_t,10,9,12> PressAver, AltAver;
+  BaroPipe.Clear(4*90000); BaroNoise.Set(12*16); AltAver.Set(0); PressAver.Set(4*101300);
+  uint8_t PipeCount=0; int32_t Sum=0; int Count=0; size_t GPSIdx=0; double PairTime=0;
+  for(size_t Idx=0; Idx<Baro.size(); Idx++)
+  { const BaroReading &Read=Baro[Idx];
+    if(Count<2) { Sum+=Read.Press; Count++; PairTime=Read.Time; }    // the two readings of the slot: the output comes right after them
+    if(!Read.Slot) continue;
+    int32_t AverPress=Sum/Count; Sum=0; Count=0;
+    BaroPipe.Input(AverPress);
+    if(PipeCount<255) PipeCount++;
+    if(PipeCount<4) continue;
+    BaroPipe.FitSlope();
+    int32_t PLR = Atmosphere::PressureLapseRate(((AverPress+2)>>2), Read.Temp);
+    int32_t ClimbRate = (BaroPipe.Slope*PLR)/800;                     // [0.01m/sec]
+    BaroPipe.CalcNoise();
+    int32_t Noise=BaroNoise.Process(BaroPipe.Noise);
+    Noise=(int32_t)floor((sqrt(25.0*Noise)+64)/128);                  // [0.1 Pa]
+    int32_t Pressure = (BaroPipe.Aver+2)>>2;                          // [0.25 Pa]
+    while(GPSIdx<GPS.size() && GPS[GPSIdx].Time<=Read.Time) GPSIdx++;
+    bool FullSec = fmod(Read.Time, 1.0)<0.5;                          // the slot at the full second
+    if(FullSec && GPSIdx)
+    { PressAver.Process(Pressure);
+      AltAver.Process((int32_t)floor(10*GPS[GPSIdx-1].Alt+0.5)); }
+    int32_t PressDiff=Pressure-((PressAver.Out+2048)>>12);
+    int32_t AltDiff = (PressDiff*(PLR>>4))/250;
+    int32_t Altitude=((AltAver.Out+2048)>>12)+AltDiff;               // [0.1 m]
+    Output Res = { PairTime, 0.01*ClimbRate, 0.1*Altitude, 0.25*Pressure, 0.1*Noise };
+    Out.push_back(Res); }
+}
+
+static void Kalman(std::vector<Output> &Out)                          // ProcBaro() now: every reading an update
+{ VerticalKalman Vario; if(ManQ>0) Vario.ManQ=ManQ;
+  LineDecimator<int32_t, 32> Ring;
+  Ring.Clear();
+  if(!hasTruth) Vario.BaroVar*=0.5f;                                  // a logged pressure is the mean of two readings
+  double LastTime=0; size_t GPSIdx=0, AccIdx=0;
+  for(size_t Idx=0; Idx<Baro.size(); Idx++)
+  { const BaroReading &Read=Baro[Idx];
+    Ring.Input(Read.Press, (uint32_t)floor(1000*Read.Time));
+    float Alt = 0.001f*Atmosphere::StdAltitude_mm(4*Read.Press);
+    double dt=Read.Time-LastTime; LastTime=Read.Time;
+    if(!Vario.Valid || dt>5) Vario.Clear(Alt);
+    else
+    { double AccSum=0; int AccCount=0;
+      while(AccIdx<Acc.size() && Acc[AccIdx].Time<=Read.Time) { AccSum+=Acc[AccIdx].Acc; AccCount++; AccIdx++; }
+      if(AccCount) Vario.Predict(dt, AccSum/AccCount);
+              else Vario.Predict(dt);
+      Vario.BaroUpdate(Alt); }
+    if(!Read.Slot) continue;
+    while(GPSIdx<GPS.size() && GPS[GPSIdx].Time<=Read.Time) GPSIdx++;
+    bool FullSec = fmod(Read.Time, 1.0)<0.5;
+    if(FullSec && GPSIdx) Vario.GPSUpdate(GPS[GPSIdx-1].Alt);
+    Ring.Fit(1000);                                                   // the decimated pressure at the newest reading
+    Output Res = { Read.Time, 0.01*Vario.getClimbRate(), 0.1*Vario.getAltitude(), 0.25*Ring.Out, 0.25*Ring.OutNoise };
+    Out.push_back(Res); }
+}
+
+static void Reference(void)                                           // no truth: centered line fit over the baro altitude, +/-2 sec
+{ std::vector<double> Time, Alt;
+  for(size_t Idx=0; Idx<Baro.size(); Idx++)
+  { Time.push_back(Baro[Idx].Time); Alt.push_back(0.001*Atmosphere::StdAltitude_mm(4*Baro[Idx].Press)); }
+  double Start=Time.front(), End=Time.back();
+  size_t Low=0, High=0;
+  for(double At=Start; At<=End; At+=0.1)
+  { while(Low<Time.size() && Time[Low]<At-2) Low++;
+    while(High<Time.size() && Time[High]<=At+2) High++;
+    double N=0, Sx=0, Sy=0, Sxx=0, Sxy=0;
+    for(size_t Idx=Low; Idx<High; Idx++)
+    { double X=Time[Idx]-At; N++; Sx+=X; Sy+=Alt[Idx]; Sxx+=X*X; Sxy+=X*Alt[Idx]; }
+    double Den=N*Sxx-Sx*Sx;
+    double Slope = Den>0 ? (N*Sxy-Sx*Sy)/Den:0;
+    TrueTime.push_back(At); TrueClimb.push_back(Slope);
+    TrueAlt.push_back(N>0 ? (Sy-Slope*Sx)/N:0); }                     // pressure altitude: no altitude error without the truth
+}
+
+struct Score { double Lag, Noise, Now, AltErr, PressErr, PressNoise; } ; // [sec], [m/s] RMS at the best shift, [m/s] RMS unshifted, [m] RMS, [Pa] RMS, [Pa] average reported
+
+static Score Evaluate(const std::vector<Output> &Out, double Skip)
+{ Score Res = { 0, 1e9, 0, 0, 0, 0 };
+  for(double Lag=0; Lag<=4.0; Lag+=0.02)
+  { double Sum2=0; int Count=0;
+    for(size_t Idx=0; Idx<Out.size(); Idx++)
+    { if(Out[Idx].Time<Skip) continue;
+      double Err=Out[Idx].Climb-Interpolate(TrueClimb, Out[Idx].Time-Lag); Sum2+=Err*Err; Count++; }
+    double RMS=sqrt(Sum2/(Count?Count:1));
+    if(Lag==0) Res.Now=RMS;
+    if(RMS<Res.Noise) { Res.Noise=RMS; Res.Lag=Lag; } }
+  double Sum2=0; int Count=0; double Half=Out.empty() ? 0:0.5*Out.back().Time;
+  for(size_t Idx=0; Idx<Out.size(); Idx++)
+  { if(Out[Idx].Time<Half) continue;                                  // the former averager settles for ten minutes
+    double Err=Out[Idx].Alt-Interpolate(TrueAlt, Out[Idx].Time); Sum2+=Err*Err; Count++; }
+  Res.AltErr=sqrt(Sum2/(Count?Count:1));
+  Sum2=0; Count=0; double SumNoise=0;
+  for(size_t Idx=0; Idx<Out.size(); Idx++)
+  { if(Out[Idx].Time<Skip) continue;
+    if(hasTruth) { double Err=Out[Idx].Press-Interpolate(TruePress, Out[Idx].Time); Sum2+=Err*Err; }
+    SumNoise+=Out[Idx].Noise; Count++; }
+  Res.PressErr=sqrt(Sum2/(Count?Count:1)); Res.PressNoise=SumNoise/(Count?Count:1);
+  return Res; }
+
+int main(int argc, char *argv[])
+{ const char *FileName=0;
+  for(int arg=1; arg<argc; arg++)
+  { const char *Val = argv[arg];
+    if(Val[0]!='-') { FileName=Val; continue; }
+    switch(Val[1])
+    { case 'h': Help=1; break;
+      case 't': SimTime=atoi(Val+2); break;
+      case 'r': BaroRate=atof(Val+2); break;
+      case 'n': BaroNoise=atof(Val+2); break;
+      case 'a': WithAcc=1; break;
+      case 'q': ManQ=atof(Val+2); break;
+      case 'v': Verbose=1; break;
+      default: Help=1; break;
+    }
+  }
+  if(SimTime<300 || (BaroRate>0 && BaroRate<4) || BaroNoise<0 || ManQ<0) Help=1;
+
+  if(Help)
+  { printf("Usage: %s [options] [log]\n\
+Options: -h          this help\n\
+         -t<sec>     simulated flight, at least 300 [%d]\n\
+         -r<Hz>      baro readings evenly spread, at least 4, 0: two per half second as formerly [%3.1f]\n\
+         -n<Pa>      noise of one baro reading [%3.1f]\n\
+         -a          simulate the accelerometer: vertical acceleration at 25Hz with offset and noise\n\
+         -q<m2/s3>   climb rate change of the Kalman filter without accelerometer, 0: the firmware default\n\
+         -v          print the climb rates: time, truth or reference, former chain, Kalman\n\
+Input:   a log with $POGNB and GGA sentences instead of the simulation\n\
+", argv[0], SimTime, BaroRate, BaroNoise);
+    return 0; }
+
+  if(FileName)
+  { int Count=ReadLog(FileName); if(Count<0) return 1;
+    printf("%s: %d baro readings, %d GPS altitudes\n", FileName, (int)Baro.size(), (int)GPS.size());
+    if(Baro.size()<40) { printf("Too few baro readings\n"); return 1; }
+    Reference(); }
+  else
+  { Simulate();
+    printf("%d sec simulated: %d baro readings (%3.1fPa noise), %d GPS altitudes, %d accelerometer readings\n",
+           SimTime, (int)Baro.size(), BaroNoise, (int)GPS.size(), (int)Acc.size()); }
+
+  std::vector<Output> Old, New;
+  OldChain(Old); Kalman(New);
+  if(Verbose)
+  { size_t NewIdx=0;
+    for(size_t Idx=0; Idx<Old.size(); Idx++)
+    { while(NewIdx<New.size() && New[NewIdx].Time<Old[Idx].Time) NewIdx++;
+      if(NewIdx>=New.size()) break;
+      printf("%8.2f %+6.2f %+6.2f %+6.2f\n", Old[Idx].Time, Interpolate(TrueClimb, Old[Idx].Time), Old[Idx].Climb, New[NewIdx].Climb); } }
+
+  double Skip = Baro.front().Time+30;
+  Score OldScore=Evaluate(Old, Skip), NewScore=Evaluate(New, Skip);
+  const char *Against = hasTruth ? "truth":"reference";
+  printf("Climb rate against the %s:  lag   noise  error   altitude error\n", Against);
+  printf("  SlopePipe+LowPass2:            %4.2fs %5.3f %5.3fm/s", OldScore.Lag, OldScore.Noise, OldScore.Now);
+  if(hasTruth) printf(" %6.2fm", OldScore.AltErr);
+  printf("\n  VerticalKalman:                %4.2fs %5.3f %5.3fm/s", NewScore.Lag, NewScore.Noise, NewScore.Now);
+  if(hasTruth) printf(" %6.2fm", NewScore.AltErr);
+  printf("\n");
+  printf("Pressure:                        error   reported noise\n");
+  if(hasTruth) printf("  two readings, 4-point average:  %5.2fPa", OldScore.PressErr);
+          else printf("  two readings, 4-point average:         ");
+  printf(" %5.2fPa\n", OldScore.PressNoise);
+  if(hasTruth) printf("  all readings, line over 1 sec:  %5.2fPa", NewScore.PressErr);
+          else printf("  all readings, line over 1 sec:         ");
+  printf(" %5.2fPa\n", NewScore.PressNoise);
+
+  int Fail=0;
+  if(NewScore.Lag>OldScore.Lag)   { printf("Kalman lags more\n"); Fail++; }
+  if(hasTruth && NewScore.Now>OldScore.Now) { printf("Kalman climb rate error larger\n"); Fail++; } // the reference is smoothed: noise only
+  if(hasTruth && NewScore.AltErr>OldScore.AltErr) { printf("Kalman altitude error larger\n"); Fail++; }
+  if(hasTruth && NewScore.PressErr>OldScore.PressErr) { printf("Decimated pressure error larger\n"); Fail++; }
+  printf("%s\n", Fail ? "FAILED":"PASSED");
+  return Fail ? 1:0; }